@@ -8,8 +8,16 @@
 
 #include <vital/types/timestamp.h>
 
+#include <QCollator>
+#include <QCollatorSortKey>
 #include <QUuid>
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 namespace kv = kwiver::vital;
 
 namespace sealtk
@@ -27,8 +35,152 @@ bool localeAwareLessThan(QString const& left, QString const& right)
   return QString::localeAwareCompare(left, right) < 0;
 }
 
+// ----------------------------------------------------------------------------
+bool isNumeric(QVariant const& data)
+{
+  switch (data.type())
+  {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+      return true;
+    default:
+      return false;
+  }
+}
+
 } // namespace <anonymous>
 
+// ============================================================================
+class AbstractProxyModelPrivate
+{
+public:
+  // Cached comparison key of an item; numeric names are compared by value,
+  // and everything else by its collation sort key
+  struct SortKey
+  {
+    enum Kind : quint8
+    {
+      Unknown,
+      Collated,
+      Numeric,
+      Uncached,
+    };
+
+    Kind kind = Unknown;
+    qint64 number = 0;
+    std::unique_ptr<QCollatorSortKey> collated;
+  };
+
+  using SortKeys = std::vector<SortKey>;
+
+  static bool isCollated(int role);
+
+  SortKey const* sortKey(
+    QAbstractItemModel* model, QModelIndex const& index, int role) const;
+
+  void insertRows(int first, int last);
+  void removeRows(int first, int last);
+  void invalidateRows(int first, int last, QVector<int> const& roles);
+
+  QList<QMetaObject::Connection> sourceConnections;
+
+  QCollator collator;
+
+  // Sort keys of the source model's top-level items, by role; entries are
+  // created on demand and reset when the source data changes
+  mutable std::unordered_map<int, SortKeys> sortKeys;
+};
+
+// ----------------------------------------------------------------------------
+QTE_IMPLEMENT_D_FUNC(AbstractProxyModel)
+
+// ----------------------------------------------------------------------------
+AbstractProxyModel::AbstractProxyModel(QObject* parent)
+  : QSortFilterProxyModel{parent}, d_ptr{new AbstractProxyModelPrivate}
+{
+}
+
+// ----------------------------------------------------------------------------
+AbstractProxyModel::~AbstractProxyModel()
+{
+}
+
+// ----------------------------------------------------------------------------
+void AbstractProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
+{
+  QTE_D();
+
+  for (auto const& c : d->sourceConnections)
+  {
+    disconnect(c);
+  }
+  d->sourceConnections.clear();
+  d->sortKeys.clear();
+
+  // Connect to the source model before the base class does, so that stale
+  // sort keys are discarded before the base class re-sorts in response to
+  // changes in the source model; since the data of a top-level item may
+  // depend on its children (e.g. a track's classification is that of its
+  // last state), changes to the children of an item invalidate its keys
+  if (sourceModel)
+  {
+    using Model = QAbstractItemModel;
+
+    auto add = [d](QMetaObject::Connection&& c){
+      d->sourceConnections.append(std::move(c));
+    };
+
+    add(connect(
+      sourceModel, &Model::rowsInserted, this,
+      [d](QModelIndex const& parent, int first, int last){
+        if (!parent.isValid())
+        {
+          d->insertRows(first, last);
+        }
+        else if (!parent.parent().isValid())
+        {
+          d->invalidateRows(parent.row(), parent.row(), {});
+        }
+      }));
+    add(connect(
+      sourceModel, &Model::rowsRemoved, this,
+      [d](QModelIndex const& parent, int first, int last){
+        if (!parent.isValid())
+        {
+          d->removeRows(first, last);
+        }
+        else if (!parent.parent().isValid())
+        {
+          d->invalidateRows(parent.row(), parent.row(), {});
+        }
+      }));
+    add(connect(
+      sourceModel, &Model::dataChanged, this,
+      [d](QModelIndex const& topLeft, QModelIndex const& bottomRight,
+          QVector<int> const& roles){
+        auto const& parent = topLeft.parent();
+        if (!parent.isValid())
+        {
+          d->invalidateRows(topLeft.row(), bottomRight.row(), roles);
+        }
+        else if (!parent.parent().isValid())
+        {
+          d->invalidateRows(parent.row(), parent.row(), roles);
+        }
+      }));
+    add(connect(sourceModel, &Model::rowsMoved, this,
+                [d]{ d->sortKeys.clear(); }));
+    add(connect(sourceModel, &Model::layoutChanged, this,
+                [d]{ d->sortKeys.clear(); }));
+    add(connect(sourceModel, &Model::modelReset, this,
+                [d]{ d->sortKeys.clear(); }));
+  }
+
+  this->QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 // ----------------------------------------------------------------------------
 bool AbstractProxyModel::isValidData(QVariant const& data, int role)
 {
@@ -132,6 +284,38 @@ bool AbstractProxyModel::lessThan(
   }
 }
 
+// ----------------------------------------------------------------------------
+bool AbstractProxyModel::sourceLessThan(
+  QModelIndex const& left, QModelIndex const& right, int role) const
+{
+  QTE_D();
+
+  auto* const sm = this->sourceModel();
+  if (!sm)
+  {
+    return false;
+  }
+
+  if (d->isCollated(role) &&
+      !left.parent().isValid() && !right.parent().isValid())
+  {
+    using SortKey = AbstractProxyModelPrivate::SortKey;
+
+    auto const* const lk = d->sortKey(sm, left, role);
+    auto const* const rk = d->sortKey(sm, right, role);
+    if (lk && rk && lk->kind == rk->kind)
+    {
+      if (lk->kind == SortKey::Numeric)
+      {
+        return lk->number < rk->number;
+      }
+      return lk->collated->compare(*rk->collated) < 0;
+    }
+  }
+
+  return this->lessThan(sm->data(left, role), sm->data(right, role), role);
+}
+
 // ----------------------------------------------------------------------------
 void AbstractProxyModel::invalidateVisibility()
 {
@@ -144,6 +328,142 @@ void AbstractProxyModel::invalidateVisibility()
   }
 }
 
+// ----------------------------------------------------------------------------
+void AbstractProxyModel::invalidateVisibility(QVector<int> const& sourceRows)
+{
+  auto* const sm = this->sourceModel();
+  if (!sm || sourceRows.isEmpty())
+  {
+    return;
+  }
+
+  // Map the source rows to our rows, which may be in a different order
+  auto rows = QVector<int>{};
+  rows.reserve(sourceRows.count());
+  for (auto const sourceRow : sourceRows)
+  {
+    auto const& index = this->mapFromSource(sm->index(sourceRow, 0));
+    if (index.isValid())
+    {
+      rows.append(index.row());
+    }
+  }
+
+  std::sort(rows.begin(), rows.end());
+
+  // Emit notifications for runs of adjacent rows
+  auto const notify = [this](int first, int last){
+    emit this->dataChanged(this->index(first, 0), this->index(last, 0),
+                           {VisibilityRole});
+  };
+
+  auto const count = rows.count();
+  for (auto i = 0, first = 0; i < count; ++i)
+  {
+    if (i + 1 == count || rows[i + 1] != rows[i] + 1)
+    {
+      notify(rows[first], rows[i]);
+      first = i + 1;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+bool AbstractProxyModelPrivate::isCollated(int role)
+{
+  return role == NameRole || role == ClassificationTypeRole;
+}
+
+// ----------------------------------------------------------------------------
+auto AbstractProxyModelPrivate::sortKey(
+  QAbstractItemModel* model, QModelIndex const& index, int role) const
+  -> SortKey const*
+{
+  auto& keys = this->sortKeys[role];
+  if (keys.empty())
+  {
+    keys.resize(static_cast<size_t>(model->rowCount()));
+  }
+
+  auto const row = static_cast<size_t>(index.row());
+  if (row >= keys.size())
+  {
+    return nullptr;
+  }
+
+  auto& key = keys[row];
+  if (key.kind == SortKey::Unknown)
+  {
+    auto const& data = model->data(index, role);
+    if (role == NameRole && isNumeric(data))
+    {
+      // Numeric names are compared numerically; unsigned values which do not
+      // fit in a signed integer are rare enough to not be worth caching
+      auto const isHuge =
+        data.type() == QVariant::ULongLong &&
+        data.toULongLong() > static_cast<quint64>(
+          std::numeric_limits<qint64>::max());
+
+      key.kind = (isHuge ? SortKey::Uncached : SortKey::Numeric);
+      key.number = data.toLongLong();
+    }
+    else
+    {
+      key.kind = SortKey::Collated;
+      key.collated.reset(
+        new QCollatorSortKey{this->collator.sortKey(data.toString())});
+    }
+  }
+
+  return (key.kind == SortKey::Uncached ? nullptr : &key);
+}
+
+// ----------------------------------------------------------------------------
+void AbstractProxyModelPrivate::insertRows(int first, int last)
+{
+  for (auto& k : this->sortKeys)
+  {
+    auto& keys = k.second;
+    if (!keys.empty())
+    {
+      auto const count = last - first + 1;
+      keys.resize(keys.size() + static_cast<size_t>(count));
+      std::rotate(keys.begin() + first, keys.end() - count, keys.end());
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void AbstractProxyModelPrivate::removeRows(int first, int last)
+{
+  for (auto& k : this->sortKeys)
+  {
+    auto& keys = k.second;
+    if (!keys.empty())
+    {
+      keys.erase(keys.begin() + first, keys.begin() + last + 1);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void AbstractProxyModelPrivate::invalidateRows(
+  int first, int last, QVector<int> const& roles)
+{
+  for (auto& k : this->sortKeys)
+  {
+    auto& keys = k.second;
+    if (isRoleAffected(roles, k.first))
+    {
+      auto const end = std::min(static_cast<size_t>(last) + 1, keys.size());
+      for (auto i = static_cast<size_t>(first); i < end; ++i)
+      {
+        keys[i] = {};
+      }
+    }
+  }
+}
+
 } // namespace core
 
 } // namespace sealtk
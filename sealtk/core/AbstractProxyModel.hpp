@@ -10,6 +10,7 @@
 #include <qtGlobal.h>
 
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 namespace sealtk
 {
@@ -17,6 +18,8 @@ namespace sealtk
 namespace core
 {
 
+class AbstractProxyModelPrivate;
+
 /// Base class for proxy models.
 ///
 /// This class provides a base class for implementing sort/filter proxy models.
@@ -27,9 +30,14 @@ class SEALTK_CORE_EXPORT AbstractProxyModel : public QSortFilterProxyModel
   Q_OBJECT
 
 public:
-  using QSortFilterProxyModel::QSortFilterProxyModel;
+  explicit AbstractProxyModel(QObject* parent = nullptr);
+  ~AbstractProxyModel() override;
+
+  void setSourceModel(QAbstractItemModel* sourceModel) override;
 
 protected:
+  QTE_DECLARE_PRIVATE_RPTR(AbstractProxyModel)
+
   /// Test if data is valid.
   ///
   /// This method tests if a data value is valid (i.e. is convertible to the
@@ -48,12 +56,39 @@ protected:
 
   using QSortFilterProxyModel::lessThan;
 
+  /// Compare source data.
+  ///
+  /// This method compares the \p role data of two indices of the source
+  /// model, as if by #lessThan(QVariant const&, QVariant const&, int) const.
+  /// For roles which are compared by locale-aware string collation, the
+  /// collation sort keys (or, for numeric names, the numeric values) of
+  /// top-level source items are computed once and cached until the source
+  /// data (including the item's children) changes, which makes repeated
+  /// comparisons (e.g. when sorting) much cheaper.
+  bool sourceLessThan(
+    QModelIndex const& left, QModelIndex const& right, int role) const;
+
   /// Emit dataChanged for all top-level items.
   ///
   /// This method emits QAbstractItemModel::dataChanged for all top-level
   /// items, with #VisibilityRole as the list of changed roles. This is useful
   /// for model data filters when their filtering criteria changes.
   void invalidateVisibility();
+
+  /// Emit dataChanged for specific top-level items.
+  ///
+  /// This method emits QAbstractItemModel::dataChanged, with #VisibilityRole
+  /// as the list of changed roles, for the top-level items which correspond
+  /// to the top-level rows \p sourceRows of the source model. Items which are
+  /// adjacent in this model are coalesced into a single notification. If
+  /// \p sourceRows is empty, nothing is emitted.
+  ///
+  /// This is useful for model data filters which are able to determine which
+  /// items' visibility was changed by a change in their filtering criteria.
+  void invalidateVisibility(QVector<int> const& sourceRows);
+
+private:
+  QTE_DECLARE_PRIVATE(AbstractProxyModel)
 };
 
 } // namespace core
@@ -10,6 +10,7 @@
 #include <qtGlobal.h>
 
 #include <QMetaType>
+#include <QVector>
 
 namespace sealtk
 {
@@ -127,6 +128,35 @@ QTE_ENUM_NS(ItemDataRole)
 
 QTE_END_META_NAMESPACE()
 
+/// Test if a change of an item's data may have changed the data of a role.
+///
+/// This returns \c true if \p changedRoles, as given by
+/// QAbstractItemModel::dataChanged, is empty (meaning that any data may have
+/// changed), or contains either \p role or a role from which the data of \p
+/// role is derived. In particular, the best classification type and score
+/// are derived from the complete classification, and the effective
+/// visibility is derived from the user visibility.
+inline bool isRoleAffected(QVector<int> const& changedRoles, int role)
+{
+  if (changedRoles.isEmpty() || changedRoles.contains(role))
+  {
+    return true;
+  }
+
+  switch (role)
+  {
+    case ClassificationTypeRole:
+    case ClassificationScoreRole:
+      return changedRoles.contains(ClassificationRole);
+
+    case VisibilityRole:
+      return changedRoles.contains(UserVisibilityRole);
+
+    default:
+      return false;
+  }
+}
+
 } // namespace core
 
 } // namespace sealtk
@@ -27,6 +27,32 @@ namespace sealtk
 namespace core
 {
 
+namespace // anonymous
+{
+
+// ----------------------------------------------------------------------------
+void reportProblem(QMessageBox::Icon icon, QString const& title,
+                   QString const& text, QString const& details)
+{
+  if (!qobject_cast<QApplication*>(QCoreApplication::instance()))
+  {
+    // Without a GUI (e.g. when running in batch mode), just log the problem
+    qWarning().noquote() << title << ":" << text << '\n' << details;
+    return;
+  }
+
+  QMessageBox mb{qApp->activeWindow()};
+
+  mb.setIcon(icon);
+  mb.setWindowTitle(title);
+  mb.setText(text);
+  mb.setDetailedText(details);
+
+  mb.exec();
+}
+
+} // namespace <anonymous>
+
 // ============================================================================
 class KwiverFileVideoSourceFactoryPrivate
 {
@@ -123,15 +149,10 @@ QUrl KwiverFileVideoSourceFactory::applyFilters(
       details += QStringLiteral("  ") + f;
     }
 
-    QMessageBox mb{qApp->activeWindow()};
-
-    mb.setIcon(QMessageBox::Information);
-    mb.setWindowTitle(QStringLiteral("No images found"));
-    mb.setText(
-      QStringLiteral("No images matching the specified filters were found."));
-    mb.setDetailedText(details);
-
-    mb.exec();
+    reportProblem(
+      QMessageBox::Information, QStringLiteral("No images found"),
+      QStringLiteral("No images matching the specified filters were found."),
+      details);
     return {};
   }
 
@@ -139,14 +160,10 @@ QUrl KwiverFileVideoSourceFactory::applyFilters(
   auto t = make_unique<QTemporaryFile>(this);
   if (!t->open())
   {
-    QMessageBox mb{qApp->activeWindow()};
-
-    mb.setIcon(QMessageBox::Warning);
-    mb.setWindowTitle(QStringLiteral("Could not create image list"));
-    mb.setText(QStringLiteral("Failed to create temporary image list file."));
-    mb.setDetailedText(t->errorString());
-
-    mb.exec();
+    reportProblem(
+      QMessageBox::Warning, QStringLiteral("Could not create image list"),
+      QStringLiteral("Failed to create temporary image list file."),
+      t->errorString());
     return {};
   }
 
@@ -14,11 +14,20 @@
 
 #include <vital/range/iota.h>
 
+#include <qtStlUtil.h>
+
 #include <QApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QEventLoop>
 #include <QMessageBox>
+#include <QMutex>
 #include <QPointer>
+#include <QQueue>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 namespace ka = kwiver::adapter;
 namespace kv = kwiver::vital;
@@ -88,12 +97,16 @@ class PipelineVideoRequestor
     public std::enable_shared_from_this<PipelineVideoRequestor>
 {
 public:
-  PipelineVideoRequestor(PortSet* ports, QEventLoop* eventLoop);
+  PipelineVideoRequestor(int index, PortSet* ports, QEventLoop* eventLoop);
 
   void requestFrame(VideoSource* source, ts_time_t time);
   void waitForFrame() const;
   void dispatchFrame(ka::adapter_data_set_t& dataSet);
 
+  qint64 frameLatency() const { return this->latency; }
+
+  int const index;
+
 protected:
   void update(VideoRequestInfo const& requestInfo,
               VideoFrame&& response) override;
@@ -101,12 +114,15 @@ protected:
   PortSet* const ports;
   QPointer<QEventLoop> const eventLoop;
   std::unique_ptr<VideoFrame> receivedFrame;
+
+  QElapsedTimer requestTimer;
+  qint64 latency = 0;
 };
 
 // ----------------------------------------------------------------------------
 PipelineVideoRequestor::PipelineVideoRequestor(
-  PortSet* ports, QEventLoop* eventLoop)
-  : ports{ports}, eventLoop{eventLoop}
+  int index, PortSet* ports, QEventLoop* eventLoop)
+  : index{index}, ports{ports}, eventLoop{eventLoop}
 {
 }
 
@@ -119,6 +135,7 @@ void PipelineVideoRequestor::requestFrame(VideoSource* source, ts_time_t time)
   request.time = time;
   request.mode = SeekExact;
 
+  this->requestTimer.start();
   source->requestFrame(std::move(request));
 }
 
@@ -145,6 +162,7 @@ void PipelineVideoRequestor::update(
   Q_UNUSED(requestInfo);
 
   this->receivedFrame = make_unique<VideoFrame>(std::move(response));
+  this->latency = this->requestTimer.nsecsElapsed();
 
   if (this->eventLoop)
   {
@@ -160,10 +178,65 @@ class KwiverPipelineWorkerPrivate
 public:
   QVector<VideoSource*> sources;
   QList<TimeMap<kv::timestamp::frame_t>> frames;
+  QList<TimeMap<VideoMetaData>> metaData;
+
+  bool inRange(ts_time_t time) const
+  {
+    return time >= this->firstTime && time <= this->lastTime;
+  }
+
+  void resetMetrics();
+  void logMetrics(KwiverPipelineWorker const* q, bool force = false);
+
+  int lookAhead = 4;
+  ts_time_t firstTime = std::numeric_limits<ts_time_t>::min();
+  ts_time_t lastTime = std::numeric_limits<ts_time_t>::max();
+
+  // Metrics are updated from both the input and output threads
+  mutable QMutex metricsMutex;
+  PipelineMetrics metrics;
+  QElapsedTimer clock;
+  QHash<ts_time_t, qint64> sendTimes;
+
+  int metricsInterval = 0;
+  QElapsedTimer summaryTimer;
 };
 
 QTE_IMPLEMENT_D_FUNC(KwiverPipelineWorker)
 
+// ----------------------------------------------------------------------------
+void KwiverPipelineWorkerPrivate::resetMetrics()
+{
+  QMutexLocker locker{&this->metricsMutex};
+
+  this->metrics = PipelineMetrics{};
+  this->metrics.frameLatency.resize(this->sources.count());
+  this->sendTimes.clear();
+
+  this->clock.start();
+  this->summaryTimer.start();
+}
+
+// ----------------------------------------------------------------------------
+void KwiverPipelineWorkerPrivate::logMetrics(
+  KwiverPipelineWorker const* q, bool force)
+{
+  if (this->metricsInterval <= 0)
+  {
+    return;
+  }
+
+  if (force || this->summaryTimer.elapsed() >= this->metricsInterval)
+  {
+    // Get the metrics through the public interface, which may combine them
+    // with those of other workers
+    auto const& summary = q->metrics().summary();
+
+    qInfo().noquote() << "Pipeline metrics:" << summary;
+    this->summaryTimer.restart();
+  }
+}
+
 // ----------------------------------------------------------------------------
 KwiverPipelineWorker::KwiverPipelineWorker(QWidget* parent)
   : KwiverPipelineWorker{RequiresInput, parent}
@@ -207,6 +280,7 @@ void KwiverPipelineWorker::addVideoSource(sealtk::core::VideoSource* source)
       // Get source's frames and append to frame set
       d->sources.append(source);
       d->frames.append(source->frames());
+      d->metaData.append(source->metaData());
     }
     else
     {
@@ -218,7 +292,97 @@ void KwiverPipelineWorker::addVideoSource(sealtk::core::VideoSource* source)
   {
     d->sources.append(nullptr);
     d->frames.append(TimeMap<kv::timestamp::frame_t>{});
+    d->metaData.append(TimeMap<VideoMetaData>{});
+  }
+}
+
+// ----------------------------------------------------------------------------
+int KwiverPipelineWorker::lookAhead() const
+{
+  QTE_D();
+  return d->lookAhead;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverPipelineWorker::setLookAhead(int timeSteps)
+{
+  QTE_D();
+  d->lookAhead = std::max(1, timeSteps);
+}
+
+// ----------------------------------------------------------------------------
+void KwiverPipelineWorker::setTimeRange(ts_time_t first, ts_time_t last)
+{
+  QTE_D();
+  d->firstTime = first;
+  d->lastTime = last;
+}
+
+// ----------------------------------------------------------------------------
+auto KwiverPipelineWorker::splitTimeline(int count) const
+  -> QVector<TimeRange>
+{
+  QTE_D();
+
+  // Merge the time steps of all sources
+  auto times = std::vector<ts_time_t>{};
+  for (auto const& f : d->frames)
+  {
+    for (auto const t : f.keys())
+    {
+      if (d->inRange(t))
+      {
+        times.push_back(t);
+      }
+    }
+  }
+
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+
+  // Divide time steps as evenly as possible among the ranges
+  auto const steps = static_cast<int>(times.size());
+  auto const ranges = std::min(std::max(1, count), steps);
+
+  auto result = QVector<TimeRange>{};
+  for (auto const i : kvr::iota(ranges))
+  {
+    auto const first = static_cast<size_t>(i * steps / ranges);
+    auto const last = static_cast<size_t>((i + 1) * steps / ranges) - 1;
+    result.append({times[first], times[last]});
   }
+
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+PipelineMetrics KwiverPipelineWorker::metrics() const
+{
+  QTE_D();
+
+  QMutexLocker locker{&d->metricsMutex};
+  return d->metrics;
+}
+
+// ----------------------------------------------------------------------------
+int KwiverPipelineWorker::metricsInterval() const
+{
+  QTE_D();
+  return d->metricsInterval;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverPipelineWorker::setMetricsInterval(int msec)
+{
+  QTE_D();
+  d->metricsInterval = msec;
+}
+
+// ----------------------------------------------------------------------------
+QVector<VideoSource*> KwiverPipelineWorker::videoSources() const
+{
+  QTE_D();
+  return d->sources;
 }
 
 // ----------------------------------------------------------------------------
@@ -231,7 +395,11 @@ void KwiverPipelineWorker::initializeInput(kwiver::embedded_pipeline& pipeline)
   int totalFrames = 0;
   for (auto const& f : d->frames)
   {
-    totalFrames += f.count();
+    auto const end = f.upperBound(d->lastTime);
+    for (auto i = f.lowerBound(d->firstTime); i != end; ++i)
+    {
+      ++totalFrames;
+    }
   }
 
   emit this->progressRangeChanged(0, totalFrames);
@@ -242,17 +410,34 @@ void KwiverPipelineWorker::sendInput(kwiver::embedded_pipeline& pipeline)
 {
   QTE_D();
 
+  // A time step for which frames have been requested
+  struct Step
+  {
+    ts_time_t time;
+    QVector<PipelineVideoRequestor*> requestors;
+  };
+
   auto const sourcesCount = d->sources.count();
+  auto const lookAhead = d->lookAhead;
 
   QEventLoop eventLoop;
   auto ports = QList<PortSet>{};
   auto requestors =
-    QHash<VideoSource*, std::shared_ptr<PipelineVideoRequestor>>{};
+    QHash<VideoSource*, QVector<std::shared_ptr<PipelineVideoRequestor>>>{};
 
+  auto pendingSteps = QQueue<Step>{};
   auto sourcesToUse = QVector<VideoSource*>{};
-  auto requestorsInUse = QVector<PipelineVideoRequestor*>{};
   auto lastTime = std::numeric_limits<ts_time_t>::min();
+  if (d->firstTime > lastTime)
+  {
+    // Start searching immediately before the first time in range
+    lastTime = d->firstTime - 1;
+  }
+  auto stepsRequested = int{0};
   auto framesProcessed = int{0};
+  auto inputExhausted = false;
+
+  d->resetMetrics();
 
   // For each source...
   for (auto const i : kvr::iota(sourcesCount))
@@ -260,17 +445,22 @@ void KwiverPipelineWorker::sendInput(kwiver::embedded_pipeline& pipeline)
     // ...get ports...
     ports.append({pipeline, i});
 
-    // ...and create a requestor to receive frames from that source
+    // ...and create requestors to receive frames from that source; since a
+    // source only replies to the most recent request of each requestor, we
+    // need one requestor for each time step that may be in flight at once
     if (auto* const source = d->sources[i])
     {
-      requestors[source] =
-        std::make_shared<PipelineVideoRequestor>(&ports[i], &eventLoop);
+      auto& sourceRequestors = requestors[source];
+      for (auto n = 0; n < lookAhead; ++n)
+      {
+        sourceRequestors.append(
+          std::make_shared<PipelineVideoRequestor>(i, &ports[i], &eventLoop));
+      }
     }
   }
 
-  // Dispatch frames in a loop
-  for (;;)
-  {
+  // Request frames for the next time step (if any)
+  auto requestNextStep = [&]{
     auto nextTime = std::numeric_limits<ts_time_t>::max();
 
     // Determine which sources will supply the next frame(s)
@@ -279,7 +469,8 @@ void KwiverPipelineWorker::sendInput(kwiver::embedded_pipeline& pipeline)
     {
       auto const& frames = d->frames[i];
       auto const ti = frames.find(lastTime, SeekNext);
-      if (ti != frames.end() && ti.key() <= nextTime)
+      if (ti != frames.end() && ti.key() <= nextTime &&
+          ti.key() <= d->lastTime)
       {
         Q_ASSERT(ti.key() > lastTime);
 
@@ -293,38 +484,110 @@ void KwiverPipelineWorker::sendInput(kwiver::embedded_pipeline& pipeline)
         sourcesToUse.append(d->sources[i]);
       }
     }
-    lastTime = nextTime;
 
-    auto const expectedFrames = sourcesToUse.count();
-    if (!expectedFrames)
+    if (sourcesToUse.isEmpty())
     {
       // No sources are providing frames; this should only happen when the last
-      // time is greater than or equal to the maximum time for all sources,
-      // which means we are done sending frames and can exit
-      pipeline.send_end_of_input();
+      // time is greater than or equal to the maximum time for all sources (or
+      // the end of the time range), which means there is nothing more to
+      // request
+      inputExhausted = true;
+      return;
+    }
+
+    lastTime = nextTime;
+
+    // Skip the time step if its output is already known, without requesting
+    // (and so decoding) its frames; the step is identified by the names of
+    // its frames, which are known from the sources' metadata
+    auto frameNames = QVector<QString>(sourcesCount);
+    for (auto const i : kvr::iota(sourcesCount))
+    {
+      if (sourcesToUse.contains(d->sources[i]))
+      {
+        auto const& md = d->metaData[i].value(nextTime);
+        frameNames[i] = qtString(md.imageName());
+      }
+    }
+
+    if (this->reuseOutput(nextTime, frameNames))
+    {
+      framesProcessed += sourcesToUse.count();
+
+      {
+        QMutexLocker locker{&d->metricsMutex};
+        ++d->metrics.stepsReused;
+      }
+
+      this->reportProgress(framesProcessed);
       return;
     }
 
-    // Request frames from sources that will participate this iteration
-    requestorsInUse.clear();
+    // Request frames from sources that will participate in this time step,
+    // using the requestors which belong to the step's slot in the window
+    auto const slot = stepsRequested++ % lookAhead;
+    auto step = Step{nextTime, {}};
     for (auto* const vs : sourcesToUse)
     {
-      auto* const requestor = requestors[vs].get();
+      auto* const requestor = requestors[vs][slot].get();
       Q_ASSERT(requestor);
 
       requestor->requestFrame(vs, nextTime);
-      requestorsInUse.append(requestor);
+      step.requestors.append(requestor);
     }
 
-    // Wait until all frames are ready
-    for (auto* const requestor : requestorsInUse)
+    pendingSteps.enqueue(std::move(step));
+  };
+
+  // Dispatch frames in a loop
+  for (;;)
+  {
+    // Keep up to the look-ahead window's worth of time steps in flight, so
+    // that sources can decode upcoming frames while the pipeline is busy
+    while (!inputExhausted && pendingSteps.count() < lookAhead)
+    {
+      requestNextStep();
+    }
+
+    if (pendingSteps.isEmpty())
+    {
+      // We are done sending frames and can exit
+      pipeline.send_end_of_input();
+      d->logMetrics(this, true);
+      return;
+    }
+
+    d->logMetrics(this);
+
+    auto const& step = pendingSteps.dequeue();
+
+    // Wait until all frames for the oldest time step are ready
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+
+    for (auto* const requestor : step.requestors)
     {
       requestor->waitForFrame();
     }
 
+    framesProcessed += step.requestors.count();
+
+    {
+      QMutexLocker locker{&d->metricsMutex};
+
+      auto& metrics = d->metrics;
+      metrics.inputWait.add(waitTimer.nsecsElapsed());
+      metrics.framesReceived += step.requestors.count();
+      for (auto* const requestor : step.requestors)
+      {
+        metrics.frameLatency[requestor->index].add(requestor->frameLatency());
+      }
+      metrics.elapsed = d->clock.nsecsElapsed();
+    }
+
     // Set up pipeline input...
     auto inputDataSet = ka::adapter_data_set::create();
-    for (auto* const requestor : requestorsInUse)
+    for (auto* const requestor : step.requestors)
     {
       requestor->dispatchFrame(inputDataSet);
     }
@@ -337,10 +600,27 @@ void KwiverPipelineWorker::sendInput(kwiver::embedded_pipeline& pipeline)
         p.ensureInputs(inputDataSet);
       }
 
+      // Note when the input was sent, so that we can match it to the output;
+      // steps are matched by time, since steps whose output is reused, and
+      // steps for which the pipeline produces no output, are not paired
+      {
+        QMutexLocker locker{&d->metricsMutex};
+        d->sendTimes.insert(step.time, d->clock.nsecsElapsed());
+      }
+
+      QElapsedTimer sendTimer;
+      sendTimer.start();
+
       pipeline.send(inputDataSet);
 
-      framesProcessed += sourcesToUse.count();
-      emit this->progressValueChanged(framesProcessed);
+      {
+        QMutexLocker locker{&d->metricsMutex};
+        ++d->metrics.stepsSent;
+        d->metrics.sendTime.add(sendTimer.nsecsElapsed());
+        d->metrics.elapsed = d->clock.nsecsElapsed();
+      }
+
+      this->reportProgress(framesProcessed);
     }
   }
 }
@@ -349,11 +629,58 @@ void KwiverPipelineWorker::sendInput(kwiver::embedded_pipeline& pipeline)
 void KwiverPipelineWorker::reportError(
   QString const& message, QString const& subject)
 {
+  if (!qobject_cast<QApplication*>(QCoreApplication::instance()))
+  {
+    // Without a GUI (e.g. when running in batch mode), just log the error
+    qCritical().noquote() << subject << ":" << message;
+    return;
+  }
+
   auto* const p = qobject_cast<QWidget*>(this->parent());
   auto* const w = (p ? p : qApp->activeWindow());
   QMessageBox::warning(w, subject, message);
 }
 
+// ----------------------------------------------------------------------------
+void KwiverPipelineWorker::recordOutput(
+  ts_time_t time, qint64 processingTime)
+{
+  QTE_D();
+
+  QMutexLocker locker{&d->metricsMutex};
+
+  auto const now = d->clock.nsecsElapsed();
+  auto& metrics = d->metrics;
+
+  ++metrics.outputsReceived;
+  metrics.outputTime.add(processingTime);
+  metrics.elapsed = now;
+
+  auto const i = d->sendTimes.find(time);
+  if (i != d->sendTimes.end())
+  {
+    auto const receiptTime = now - processingTime;
+    metrics.outputLatency.add(receiptTime - *i);
+    d->sendTimes.erase(i);
+  }
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverPipelineWorker::reuseOutput(
+  ts_time_t time, QVector<QString> const& frameNames)
+{
+  Q_UNUSED(time)
+  Q_UNUSED(frameNames)
+
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverPipelineWorker::reportProgress(int framesProcessed)
+{
+  emit this->progressValueChanged(framesProcessed);
+}
+
 } // namespace core
 
 } // namespace sealtk
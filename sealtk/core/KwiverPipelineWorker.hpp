@@ -7,10 +7,17 @@
 
 #include <sealtk/core/Export.h>
 
+#include <sealtk/core/PipelineMetrics.hpp>
+
 #include <arrows/qt/EmbeddedPipelineWorker.h>
 
+#include <vital/types/timestamp.h>
+
 #include <qtGlobal.h>
 
+#include <QPair>
+#include <QVector>
+
 namespace sealtk
 {
 
@@ -33,8 +40,65 @@ public:
 
   ~KwiverPipelineWorker() override;
 
+  using TimeRange = QPair<kwiver::vital::timestamp::time_t,
+                          kwiver::vital::timestamp::time_t>;
+
   void addVideoSource(VideoSource* source);
 
+  /// Get the number of time steps for which frames are requested in advance.
+  /// \sa setLookAhead()
+  int lookAhead() const;
+
+  /// Set the number of time steps for which frames are requested in advance.
+  ///
+  /// While the pipeline processes the input for one time step, frames for up
+  /// to \p timeSteps upcoming time steps are requested from the video sources,
+  /// so that decoding video overlaps with pipeline processing. A value of 1
+  /// requests frames for only one time step at a time. The default is 4.
+  ///
+  /// This must be called before the pipeline is executed.
+  void setLookAhead(int timeSteps);
+
+  /// Restrict the input to a range of times.
+  ///
+  /// Only frames whose times lie within \p first and \p last, inclusive, are
+  /// sent to the pipeline and counted toward the worker's progress. By
+  /// default, all frames are sent.
+  ///
+  /// This must be called before the pipeline is initialized.
+  void setTimeRange(kwiver::vital::timestamp::time_t first,
+                    kwiver::vital::timestamp::time_t last);
+
+  /// Split the merged timeline of the worker's video sources.
+  ///
+  /// This returns up to \p count contiguous, non-overlapping time ranges,
+  /// in order, which together cover every time step of the worker's video
+  /// sources (within the worker's time range), and which each contain
+  /// roughly the same number of time steps. Fewer than \p count ranges are
+  /// returned if there are fewer than \p count time steps.
+  ///
+  /// \sa setTimeRange()
+  QVector<TimeRange> splitTimeline(int count) const;
+
+  /// Get the throughput and latency of the current or last execution.
+  ///
+  /// Metrics are reset when the worker starts sending input to the pipeline,
+  /// and are updated as frames are received and sent and as output is
+  /// received. This may be called from any thread, including while the
+  /// worker is executing.
+  virtual PipelineMetrics metrics() const;
+
+  /// Get the interval at which a summary of the metrics is logged.
+  /// \sa setMetricsInterval()
+  int metricsInterval() const;
+
+  /// Set the interval at which a summary of the metrics is logged.
+  ///
+  /// While the worker executes, a summary of its metrics is logged (as an
+  /// informational message) every \p msec milliseconds, and once more when
+  /// all input has been sent. A value of zero (the default) disables logging.
+  void setMetricsInterval(int msec);
+
 signals:
   void progressRangeChanged(int minimum, int maximum);
   void progressValueChanged(int value);
@@ -48,6 +112,38 @@ protected:
 
   void reportError(QString const& message, QString const& subject) override;
 
+  /// Reuse existing pipeline output for a time step.
+  ///
+  /// This is called for each time step, in time order, before its frames are
+  /// requested, with the time of the step and the image names of its frames
+  /// (indexed by video source, as given by the sources' metadata; names are
+  /// empty for sources having no frame at the time step). If the
+  /// implementation returns \c true, the frames are neither requested nor
+  /// sent to the pipeline, and the implementation is responsible for
+  /// producing the output for the time step by other means, e.g. from a
+  /// cache. The default implementation returns \c false.
+  virtual bool reuseOutput(kwiver::vital::timestamp::time_t time,
+                           QVector<QString> const& frameNames);
+
+  /// Report the number of frames which have been sent to the pipeline.
+  ///
+  /// The default implementation emits #progressValueChanged.
+  virtual void reportProgress(int framesProcessed);
+
+  /// Record the receipt of pipeline output.
+  ///
+  /// Implementations of #processOutput should call this for each (non-null)
+  /// output, once they have finished processing it, with the time stamp of
+  /// the time step to which the output belongs, and the time, in
+  /// nanoseconds, which they spent processing it. This is used to measure
+  /// the latency of the pipeline and the cost of processing its output; the
+  /// latency is only measured if \p time matches that of a time step which
+  /// was sent to the pipeline.
+  void recordOutput(kwiver::vital::timestamp::time_t time,
+                    qint64 processingTime);
+
+  QVector<VideoSource*> videoSources() const;
+
 private:
   QTE_DECLARE_PRIVATE(KwiverPipelineWorker);
 };
@@ -5,22 +5,24 @@
 #include <sealtk/core/KwiverTrackModel.hpp>
 
 #include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/StringTable.hpp>
 #include <sealtk/core/TrackUtils.hpp>
-#include <sealtk/core/UnsharedPointer.hpp>
 
 #include <vital/types/object_track_set.h>
 #include <vital/types/track.h>
 
-#include <vital/range/indirect.h>
-#include <vital/range/transform.h>
+#include <vital/range/iota.h>
 #include <vital/range/valid.h>
 
 #include <qtGet.h>
 #include <qtScopedValueChange.h>
 #include <qtStlUtil.h>
 
+#include <QMutex>
 #include <QRectF>
 #include <QSet>
+#include <QSharedData>
+#include <QVector>
 
 namespace kv = kwiver::vital;
 namespace kvr = kwiver::vital::range;
@@ -40,87 +42,174 @@ struct KwiverTrack
   KwiverTrack() = default;
   KwiverTrack(KwiverTrack&&) = default;
   KwiverTrack(KwiverTrack const& other) = default;
-  KwiverTrack(kv::track_sptr&& object);
+  KwiverTrack(kv::track const& track);
 
   KwiverTrack& operator=(KwiverTrack&&) = default;
   KwiverTrack& operator=(KwiverTrack const&) = default;
 
-  core::UnsharedPointer<kv::track> track;
+  size_t size() const { return this->frames.size(); }
+  bool empty() const { return this->frames.empty(); }
+
+  size_t lowerBoundFrame(kv::frame_id_t frame) const;
+  size_t lowerBoundTime(kv::time_usec_t time) const;
+
+  void clear();
+
+  void append(KwiverTrack const& other, size_t i);
+  void insert(size_t i, KwiverTrack const& other);
+  void insert(size_t i, kv::object_track_state const& state);
+  void replace(size_t i, kv::time_usec_t time,
+               kv::detected_object_sptr const& detection);
+
+  void setClassification(size_t i, int classId, double score);
+
+  kv::detected_object_sptr const& detachedDetection(size_t i);
+
+  kv::track_sptr toTrack() const;
+
+  kv::track_id_t id = -1;
   bool visible = true;
+
+  // State data is stored column-wise, ordered by frame number; the "hot"
+  // columns hold the data needed to answer most queries, while the detection
+  // column holds the complete detection, which is only needed for
+  // infrequently used data (i.e. the full classification and notes) and for
+  // conversion back to a KWIVER track
+  std::vector<kv::frame_id_t> frames;
+  std::vector<kv::time_usec_t> times;
+  std::vector<double> boxes; // min x, min y, max x, max y of each state
+  std::vector<int> classIds; // -1 if the state is not classified
+  std::vector<double> scores;
+
+  // Detections may be shared with copies of the track; use detachedDetection
+  // to obtain a detection that may be modified
+  std::vector<kv::detected_object_sptr> detections;
 };
 
 // ============================================================================
-struct Classifier
+struct SharedTrack : QSharedData
 {
-  QVariant type;  // nominally QString
-  QVariant score; // nominally double
+  SharedTrack(KwiverTrack&& track) : track{std::move(track)} {}
+
+  KwiverTrack track;
 };
 
-// ----------------------------------------------------------------------------
-kv::track_sptr cleanTrack(kv::track_sptr const& in)
+// ============================================================================
+class TrackStore
 {
-  // Check that we have a track at all
-  if (!in)
-  {
-    return nullptr;
-  }
+public:
+  using TrackPointer = QSharedDataPointer<SharedTrack>;
 
-  // Check if the track has only object track states
-  auto clean = true;
-  for (auto const& s : *in | kv::as_object_track)
-  {
-    if (!s)
-    {
-      clean = false;
-      break;
-    }
-  }
+  size_t size() const { return this->count; }
+
+  KwiverTrack const& operator[](size_t i) const
+  { return this->chunks[chunkIndex(i)]->tracks[i % ChunkSize]->track; }
+
+  KwiverTrack& modify(size_t i)
+  { return this->chunks[chunkIndex(i)]->tracks[i % ChunkSize]->track; }
 
-  if (clean)
+  void append(KwiverTrack&& track);
+  void truncate(size_t newSize);
+
+  std::vector<TrackPointer> take();
+  void assign(std::vector<TrackPointer>&& tracks);
+
+private:
+  static constexpr size_t ChunkSize = 256;
+
+  struct Chunk : QSharedData
   {
-    return in;
-  }
+    std::vector<TrackPointer> tracks;
+  };
+
+  static int chunkIndex(size_t i) { return static_cast<int>(i / ChunkSize); }
 
-  // Create a cleaned track using only the object track states
-  auto out = kv::track::create();
-  out->set_id(in->id());
+  void append(TrackPointer&& track);
 
-  for (auto const& s : *in | kv::as_object_track | kvr::valid)
+  // Each track is implicitly shared between copies of the store, and the
+  // pointers to the tracks are held in fixed-size chunks which are also
+  // implicitly shared; copying the store only copies the list of chunks, and
+  // modifying a track copies only that track and the pointers in its chunk
+  QVector<QSharedDataPointer<Chunk>> chunks;
+  size_t count = 0;
+};
+
+// ============================================================================
+class TrackLifetimeIndex
+{
+public:
+  using time_t = kv::timestamp::time_t;
+
+  void build(TrackStore const& tracks);
+  void query(time_t time, QVector<int>& result) const;
+
+  void invalidate(size_t row);
+  void remove(QVector<int> const& rows);
+
+  size_t rows() const { return this->indexedRows; }
+  std::vector<int> const& staleRows() const { return this->stale; }
+  size_t outdatedEntries() const
   {
-    out->append(s->clone(kv::clone_type::SHALLOW));
+    return this->stale.size() + this->removedEntries;
   }
 
-  return out;
-}
+private:
+  struct Entry
+  {
+    time_t start;
+    time_t end;
+    int row;
+  };
+
+  time_t buildNode(size_t first, size_t last);
+  void queryNode(size_t first, size_t last, time_t time,
+                 QVector<int>& result) const;
+
+  // Entries are sorted by start time; the entries and the maximum end time
+  // arrays together form an implicit, balanced interval tree, where the node
+  // for the range [first, last) is the entry at the midpoint of the range
+  std::vector<Entry> entries;
+  std::vector<time_t> maxEnd;
+  size_t indexedRows = 0;
+
+  // Entries of rows whose lifetimes have changed since the index was built
+  // are kept, but ignored by queries; such rows must instead be searched
+  // exhaustively, like rows appended after the index was built. Entries of
+  // removed rows are likewise kept (with a row of -1), since the maximum end
+  // times remain valid (if conservative) bounds without them
+  std::vector<bool> isStale;
+  std::vector<int> stale;
+  size_t removedEntries = 0;
+};
 
 // ----------------------------------------------------------------------------
-Classifier bestClassifier(std::shared_ptr<kv::object_track_state> const& state)
+void bestClassifier(kv::detected_object_type_sptr const& type,
+                    int& classId, double& score)
 {
-  if (auto const& detection = state->detection())
+  classId = -1;
+  score = 0.0;
+
+  if (type)
   {
-    if (auto const& c = detection->type())
+    try
     {
-      try
-      {
-        std::string type;
-        double confidence;
+      std::string name;
+      double confidence;
 
-        c->get_most_likely(type, confidence);
-        return {qtString(type), confidence};
-      }
-      catch (...)
-      {
-      }
+      type->get_most_likely(name, confidence);
+      classId = internString(name);
+      score = confidence;
+    }
+    catch (...)
+    {
     }
   }
-
-  return {};
 }
 
 // ----------------------------------------------------------------------------
-QVariant fullClassifier(std::shared_ptr<kv::object_track_state> const& state)
+QVariant fullClassifier(kv::detected_object_sptr const& detection)
 {
-  if (auto const& detection = state->detection())
+  if (detection)
   {
     if (auto const& c = detection->type())
     {
@@ -137,9 +226,9 @@ QVariant fullClassifier(std::shared_ptr<kv::object_track_state> const& state)
 }
 
 // ----------------------------------------------------------------------------
-QVariant notes(std::shared_ptr<kv::object_track_state> const& state)
+QVariant notes(kv::detected_object_sptr const& detection)
 {
-  if (auto const& detection = state->detection())
+  if (detection)
   {
     auto const& in = detection->notes();
     auto out = QStringList{};
@@ -156,29 +245,570 @@ QVariant notes(std::shared_ptr<kv::object_track_state> const& state)
   return {};
 }
 
-} // namespace <anonymous>
+// ----------------------------------------------------------------------------
+bool trackLifetime(KwiverTrack const& track, kv::timestamp::time_t& start,
+                   kv::timestamp::time_t& end)
+{
+  if (track.empty())
+  {
+    return false;
+  }
+
+  start = track.times.front();
+  end = track.times.back();
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+KwiverTrack::KwiverTrack(kv::track const& track)
+  : id{track.id()}
+{
+  for (auto const& s : track | kv::as_object_track | kvr::valid)
+  {
+    this->insert(this->size(), *s);
+  }
+}
+
+// ----------------------------------------------------------------------------
+size_t KwiverTrack::lowerBoundFrame(kv::frame_id_t frame) const
+{
+  auto const i =
+    std::lower_bound(this->frames.begin(), this->frames.end(), frame);
+  return static_cast<size_t>(i - this->frames.begin());
+}
+
+// ----------------------------------------------------------------------------
+size_t KwiverTrack::lowerBoundTime(kv::time_usec_t time) const
+{
+  auto const i =
+    std::lower_bound(this->times.begin(), this->times.end(), time);
+  return static_cast<size_t>(i - this->times.begin());
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrack::clear()
+{
+  this->frames.clear();
+  this->times.clear();
+  this->boxes.clear();
+  this->classIds.clear();
+  this->scores.clear();
+  this->detections.clear();
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrack::append(KwiverTrack const& other, size_t i)
+{
+  auto const box = other.boxes.begin() + static_cast<ptrdiff_t>(4 * i);
+
+  this->frames.push_back(other.frames[i]);
+  this->times.push_back(other.times[i]);
+  this->boxes.insert(this->boxes.end(), box, box + 4);
+  this->classIds.push_back(other.classIds[i]);
+  this->scores.push_back(other.scores[i]);
+  this->detections.push_back(other.detections[i]);
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrack::insert(size_t i, KwiverTrack const& other)
+{
+  auto const offset = static_cast<ptrdiff_t>(i);
+
+  auto splice = [offset](auto& to, auto const& from, ptrdiff_t stride){
+    to.insert(to.begin() + (stride * offset), from.begin(), from.end());
+  };
+
+  splice(this->frames, other.frames, 1);
+  splice(this->times, other.times, 1);
+  splice(this->boxes, other.boxes, 4);
+  splice(this->classIds, other.classIds, 1);
+  splice(this->scores, other.scores, 1);
+  splice(this->detections, other.detections, 1);
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrack::insert(size_t i, kv::object_track_state const& state)
+{
+  auto const offset = static_cast<ptrdiff_t>(i);
+
+  this->frames.insert(this->frames.begin() + offset, state.frame());
+  this->times.insert(this->times.begin() + offset, state.time());
+  this->boxes.insert(this->boxes.begin() + (4 * offset), 4, 0.0);
+  this->classIds.insert(this->classIds.begin() + offset, -1);
+  this->scores.insert(this->scores.begin() + offset, 0.0);
+  this->detections.insert(this->detections.begin() + offset, nullptr);
+
+  this->replace(i, state.time(), state.detection());
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrack::replace(
+  size_t i, kv::time_usec_t time, kv::detected_object_sptr const& detection)
+{
+  this->times[i] = time;
+  this->detections[i] = detection;
+
+  if (detection)
+  {
+    auto const& bb = detection->bounding_box();
+    auto* const box = this->boxes.data() + (4 * i);
+    box[0] = bb.min_x();
+    box[1] = bb.min_y();
+    box[2] = bb.max_x();
+    box[3] = bb.max_y();
+  }
+
+  auto classId = int{-1};
+  auto score = double{0.0};
+  if (detection)
+  {
+    bestClassifier(detection->type(), classId, score);
+  }
+  this->setClassification(i, classId, score);
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrack::setClassification(size_t i, int classId, double score)
+{
+  this->classIds[i] = classId;
+  this->scores[i] = score;
+}
+
+// ----------------------------------------------------------------------------
+kv::detected_object_sptr const& KwiverTrack::detachedDetection(size_t i)
+{
+  auto& detection = this->detections[i];
+  if (detection && detection.use_count() > 1)
+  {
+    detection = detection->clone();
+  }
+  return detection;
+}
+
+// ----------------------------------------------------------------------------
+kv::track_sptr KwiverTrack::toTrack() const
+{
+  auto track = kv::track::create();
+  track->set_id(this->id);
+
+  for (auto const i : kvr::iota(this->size()))
+  {
+    auto detection = this->detections[i];
+    track->append(
+      createTrackState(this->frames[i], this->times[i], std::move(detection)));
+  }
+
+  return track;
+}
+
+// ----------------------------------------------------------------------------
+void TrackStore::append(KwiverTrack&& track)
+{
+  this->append(TrackPointer{new SharedTrack{std::move(track)}});
+}
+
+// ----------------------------------------------------------------------------
+void TrackStore::append(TrackPointer&& track)
+{
+  if (this->count % ChunkSize == 0)
+  {
+    this->chunks.append(QSharedDataPointer<Chunk>{new Chunk});
+    this->chunks.last()->tracks.reserve(ChunkSize);
+  }
+
+  this->chunks.last()->tracks.push_back(std::move(track));
+  ++this->count;
+}
+
+// ----------------------------------------------------------------------------
+void TrackStore::truncate(size_t newSize)
+{
+  if (newSize < this->count)
+  {
+    this->chunks.resize(chunkIndex(newSize + ChunkSize - 1));
+    if (auto const tail = newSize % ChunkSize)
+    {
+      this->chunks.last()->tracks.resize(tail);
+    }
+    this->count = newSize;
+  }
+}
+
+// ----------------------------------------------------------------------------
+std::vector<TrackStore::TrackPointer> TrackStore::take()
+{
+  std::vector<TrackPointer> result;
+  result.reserve(this->count);
+
+  // Only the pointers are copied; the tracks remain shared with any other
+  // store which shares them
+  for (auto const& chunk : this->chunks)
+  {
+    auto const& tracks = chunk.constData()->tracks;
+    result.insert(result.end(), tracks.begin(), tracks.end());
+  }
+
+  this->chunks.clear();
+  this->count = 0;
+
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+void TrackStore::assign(std::vector<TrackPointer>&& tracks)
+{
+  this->chunks.clear();
+  this->count = 0;
+
+  for (auto& track : tracks)
+  {
+    this->append(std::move(track));
+  }
+}
+
+// ----------------------------------------------------------------------------
+void TrackLifetimeIndex::build(TrackStore const& tracks)
+{
+  this->entries.clear();
+  this->entries.reserve(tracks.size());
+
+  for (auto const row : kvr::iota(tracks.size()))
+  {
+    auto entry = Entry{0, 0, static_cast<int>(row)};
+    if (trackLifetime(tracks[row], entry.start, entry.end))
+    {
+      this->entries.push_back(entry);
+    }
+  }
+
+  std::sort(this->entries.begin(), this->entries.end(),
+            [](Entry const& a, Entry const& b){ return a.start < b.start; });
+
+  this->maxEnd.resize(this->entries.size());
+  if (!this->entries.empty())
+  {
+    this->buildNode(0, this->entries.size());
+  }
+  this->indexedRows = tracks.size();
+
+  this->isStale.assign(this->indexedRows, false);
+  this->stale.clear();
+  this->removedEntries = 0;
+}
+
+// ----------------------------------------------------------------------------
+kv::timestamp::time_t TrackLifetimeIndex::buildNode(size_t first, size_t last)
+{
+  auto const mid = first + ((last - first) / 2);
+  auto result = this->entries[mid].end;
+
+  if (first < mid)
+  {
+    result = std::max(result, this->buildNode(first, mid));
+  }
+  if (mid + 1 < last)
+  {
+    result = std::max(result, this->buildNode(mid + 1, last));
+  }
+
+  this->maxEnd[mid] = result;
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+void TrackLifetimeIndex::query(time_t time, QVector<int>& result) const
+{
+  this->queryNode(0, this->entries.size(), time, result);
+}
+
+// ----------------------------------------------------------------------------
+void TrackLifetimeIndex::queryNode(
+  size_t first, size_t last, time_t time, QVector<int>& result) const
+{
+  if (first >= last)
+  {
+    return;
+  }
+
+  // If no interval in this subtree ends at or after the query time, there is
+  // nothing to find here
+  auto const mid = first + ((last - first) / 2);
+  if (this->maxEnd[mid] < time)
+  {
+    return;
+  }
+
+  this->queryNode(first, mid, time, result);
+
+  // Intervals to the right start no earlier than this one; if this one starts
+  // after the query time, so do all of them
+  auto const& entry = this->entries[mid];
+  if (entry.start > time)
+  {
+    return;
+  }
+
+  if (entry.end >= time && entry.row >= 0 &&
+      !this->isStale[static_cast<size_t>(entry.row)])
+  {
+    result.append(entry.row);
+  }
+
+  this->queryNode(mid + 1, last, time, result);
+}
+
+// ----------------------------------------------------------------------------
+void TrackLifetimeIndex::invalidate(size_t row)
+{
+  // Rows that were appended after the index was built are already searched
+  // exhaustively
+  if (row < this->indexedRows && !this->isStale[row])
+  {
+    this->isStale[row] = true;
+    this->stale.push_back(static_cast<int>(row));
+  }
+}
+
+// ----------------------------------------------------------------------------
+void TrackLifetimeIndex::remove(QVector<int> const& rows)
+{
+  // Rows to be removed must be sorted; remaining rows are shifted down by the
+  // number of removed rows which precede them
+  auto const newRow = [&rows](int row){
+    auto const i = std::lower_bound(rows.begin(), rows.end(), row);
+    if (i != rows.end() && *i == row)
+    {
+      return -1;
+    }
+    return row - static_cast<int>(i - rows.begin());
+  };
+
+  for (auto& entry : this->entries)
+  {
+    if (entry.row >= 0)
+    {
+      entry.row = newRow(entry.row);
+      if (entry.row < 0)
+      {
+        ++this->removedEntries;
+      }
+    }
+  }
+
+  auto isStale = std::vector<bool>{};
+  auto stale = std::vector<int>{};
+  for (auto const row : kvr::iota(this->indexedRows))
+  {
+    auto const r = static_cast<int>(row);
+    if (newRow(r) >= 0)
+    {
+      isStale.push_back(this->isStale[row]);
+      if (this->isStale[row])
+      {
+        stale.push_back(static_cast<int>(isStale.size()) - 1);
+      }
+    }
+  }
+
+  this->isStale = std::move(isStale);
+  this->stale = std::move(stale);
+  this->indexedRows = this->isStale.size();
+}
+
+// ----------------------------------------------------------------------------
+QVariant stateData(KwiverTrack const& track, size_t i, int role)
+{
+  switch (role)
+  {
+    case ClassificationTypeRole:
+      if (track.classIds[i] >= 0)
+      {
+        return internedString(track.classIds[i]);
+      }
+      return {};
+
+    case ClassificationScoreRole:
+      if (track.classIds[i] >= 0)
+      {
+        return track.scores[i];
+      }
+      return {};
+
+    case ClassificationRole:
+      return fullClassifier(track.detections[i]);
+
+    case NotesRole:
+      return notes(track.detections[i]);
+
+    default:
+      return {};
+  }
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class KwiverTrackModelData : public QSharedData
+{
+public:
+  KwiverTrackModelData() = default;
+
+  // The lifetime index is not copied; it is cheaper to rebuild it if it is
+  // needed than to copy it on every detach
+  KwiverTrackModelData(KwiverTrackModelData const& other)
+    : QSharedData{other}, trackMap{other.trackMap}, tracks{other.tracks}
+  {
+  }
+
+  void updateLifetimeIndex(size_t row);
+  void removeFromLifetimeIndex(QVector<int> const& rows);
+
+  QHash<kv::track_id_t, size_t> trackMap;
+  TrackStore tracks;
+
+  // Tracks appended or modified after the index was built are not in the
+  // index (or rather, their entries are ignored); these are searched
+  // exhaustively until there are enough of them to warrant rebuilding the
+  // index
+  //
+  // The index is built lazily by a const method, while the data may be
+  // shared (with undo snapshots, or with other models); the mutex serializes
+  // building and querying the index
+  mutable QMutex lifetimeIndexMutex;
+  mutable TrackLifetimeIndex lifetimeIndex;
+  mutable bool lifetimeIndexValid = false;
+};
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModelData::updateLifetimeIndex(size_t row)
+{
+  if (this->lifetimeIndexValid)
+  {
+    this->lifetimeIndex.invalidate(row);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModelData::removeFromLifetimeIndex(QVector<int> const& rows)
+{
+  if (this->lifetimeIndexValid)
+  {
+    this->lifetimeIndex.remove(rows);
+  }
+}
+
+// ============================================================================
+class KwiverTrackModelHistory
+{
+public:
+  static constexpr int MaximumDepth = 100;
+
+  // Each entry is a snapshot of the model's data; since the data is
+  // implicitly shared, and the track store shares unmodified tracks between
+  // copies, a snapshot only costs as much as the edits made after it
+  QList<QSharedDataPointer<KwiverTrackModelData>> undoStack;
+  QList<QSharedDataPointer<KwiverTrackModelData>> redoStack;
+
+  // Identifier of the track whose states were changed by the most recent
+  // edit, if that edit was made by updateTrack; further updates of the same
+  // track are folded into that edit
+  kv::track_id_t updatedTrack = -1;
+};
+
+// ----------------------------------------------------------------------------
+KwiverTrackSnapshot::KwiverTrackSnapshot()
+{
+}
+
+// ----------------------------------------------------------------------------
+KwiverTrackSnapshot::KwiverTrackSnapshot(
+  QSharedDataPointer<KwiverTrackModelData> const& d)
+  : d{d}
+{
+}
+
+// ----------------------------------------------------------------------------
+KwiverTrackSnapshot::KwiverTrackSnapshot(KwiverTrackSnapshot const& other)
+  : d{other.d}
+{
+}
+
+// ----------------------------------------------------------------------------
+KwiverTrackSnapshot::~KwiverTrackSnapshot()
+{
+}
+
+// ----------------------------------------------------------------------------
+KwiverTrackSnapshot& KwiverTrackSnapshot::operator=(
+  KwiverTrackSnapshot const& other)
+{
+  this->d = other.d;
+  return *this;
+}
+
+// ----------------------------------------------------------------------------
+int KwiverTrackSnapshot::trackCount() const
+{
+  return (this->d ? static_cast<int>(this->d->tracks.size()) : 0);
+}
+
+// ----------------------------------------------------------------------------
+int KwiverTrackSnapshot::stateCount(int track) const
+{
+  auto const& t = this->d->tracks[static_cast<size_t>(track)];
+  return static_cast<int>(t.size());
+}
+
+// ----------------------------------------------------------------------------
+kv::track_id_t KwiverTrackSnapshot::trackId(int track) const
+{
+  return this->d->tracks[static_cast<size_t>(track)].id;
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTrackSnapshot::isTrackVisible(int track) const
+{
+  return this->d->tracks[static_cast<size_t>(track)].visible;
+}
+
+// ----------------------------------------------------------------------------
+kv::timestamp::time_t KwiverTrackSnapshot::stateTime(
+  int track, int state) const
+{
+  auto const& t = this->d->tracks[static_cast<size_t>(track)];
+  return t.times[static_cast<size_t>(state)];
+}
+
+// ----------------------------------------------------------------------------
+QVariant KwiverTrackSnapshot::stateData(int track, int state, int role) const
+{
+  auto const& t = this->d->tracks[static_cast<size_t>(track)];
+  return core::stateData(t, static_cast<size_t>(state), role);
+}
 
-// ============================================================================
-class KwiverTrackModelData : public QSharedData
+// ----------------------------------------------------------------------------
+kv::detected_object_sptr KwiverTrackSnapshot::stateDetection(
+  int track, int state) const
 {
-public:
-  QHash<kv::track_id_t, size_t> trackMap;
-  std::vector<KwiverTrack> tracks;
-};
+  auto const& t = this->d->tracks[static_cast<size_t>(track)];
+  return t.detections[static_cast<size_t>(state)];
+}
 
 // ----------------------------------------------------------------------------
 QTE_IMPLEMENT_D_FUNC_SHARED(KwiverTrackModel)
 
 // ----------------------------------------------------------------------------
 KwiverTrackModel::KwiverTrackModel(QObject* parent)
-  : AbstractItemModel{parent}, d_ptr{new KwiverTrackModelData}
+  : AbstractItemModel{parent}, d_ptr{new KwiverTrackModelData},
+    history{new KwiverTrackModelHistory}
 {
 }
 
 // ----------------------------------------------------------------------------
 KwiverTrackModel::KwiverTrackModel(
   QSharedDataPointer<KwiverTrackModelData> const& d, QObject* parent)
-  : AbstractItemModel{parent}, d_ptr{d}
+  : AbstractItemModel{parent}, d_ptr{d},
+    history{new KwiverTrackModelHistory}
 {
 }
 
@@ -203,7 +833,7 @@ int KwiverTrackModel::rowCount(QModelIndex const& parent) const
     }
 
     auto const pru = static_cast<uint>(pr);
-    return static_cast<int>(d->tracks[pru].track->size());
+    return static_cast<int>(d->tracks[pru].size());
   }
 
   return static_cast<int>(d->tracks.size());
@@ -242,38 +872,31 @@ QVariant KwiverTrackModel::data(QModelIndex const& index, int role) const
     if (auto const pr = static_cast<int>(index.internalId()))
     {
       auto const& track = d->tracks[static_cast<uint>(pr - 1)];
-      auto const& state =
-        objectTrackState(*(track.track->begin() + index.row()));
+      auto const i = static_cast<size_t>(index.row());
 
       switch (role)
       {
         case core::NameRole:
         case core::LogicalIdentityRole:
-          return static_cast<qint64>(track.track->id());
+          return static_cast<qint64>(track.id);
 
         case core::StartTimeRole:
         case core::EndTimeRole:
-          return QVariant::fromValue(state->time());
+          return QVariant::fromValue(track.times[i]);
 
         case AreaLocationRole:
-          if (auto const& detection = state->detection())
+          if (track.detections[i])
           {
-            auto const& bb = detection->bounding_box();
-            return QRectF{bb.min_x(), bb.min_y(), bb.width(), bb.height()};
+            auto const* const box = track.boxes.data() + (4 * i);
+            return QRectF{QPointF{box[0], box[1]}, QPointF{box[2], box[3]}};
           }
           return {};
 
         case ClassificationTypeRole:
-          return bestClassifier(state).type;
-
         case ClassificationScoreRole:
-          return bestClassifier(state).score;
-
         case ClassificationRole:
-          return fullClassifier(state);
-
         case NotesRole:
-          return notes(state);
+          return stateData(track, i, role);
 
         case core::UserVisibilityRole:
           return track.visible;
@@ -290,21 +913,19 @@ QVariant KwiverTrackModel::data(QModelIndex const& index, int role) const
       {
         case core::NameRole:
         case core::LogicalIdentityRole:
-          return static_cast<qint64>(track.track->id());
+          return static_cast<qint64>(track.id);
 
         case core::StartTimeRole:
-          if (!track.track->empty())
+          if (!track.empty())
           {
-            auto const& s = objectTrackState(track.track->front());
-            return QVariant::fromValue(s->time());
+            return QVariant::fromValue(track.times.front());
           }
           return {};
 
         case core::EndTimeRole:
-          if (!track.track->empty())
+          if (!track.empty())
           {
-            auto const& s = objectTrackState(track.track->back());
-            return QVariant::fromValue(s->time());
+            return QVariant::fromValue(track.times.back());
           }
           return {};
 
@@ -312,17 +933,9 @@ QVariant KwiverTrackModel::data(QModelIndex const& index, int role) const
         case ClassificationScoreRole:
         case ClassificationRole:
         case NotesRole:
-          if (!track.track->empty())
+          if (!track.empty())
           {
-            auto const& s = objectTrackState(track.track->back());
-            switch (role)
-            {
-              case ClassificationTypeRole:  return bestClassifier(s).type;
-              case ClassificationScoreRole: return bestClassifier(s).score;
-              case ClassificationRole:      return fullClassifier(s);
-              case NotesRole:               return notes(s);
-              default: Q_UNREACHABLE();
-            }
+            return stateData(track, track.size() - 1, role);
           }
           return {};
 
@@ -344,36 +957,53 @@ bool KwiverTrackModel::setData(
 {
   if (this->checkIndex(index, IndexIsValid | ParentIsInvalid))
   {
-    QTE_D_DETACH();
-
-    auto& track = d->tracks[static_cast<uint>(index.row())];
+    auto const row = static_cast<size_t>(index.row());
     switch (role)
     {
       case core::ClassificationRole:
         if (value.canConvert<QVariantHash>())
         {
+          this->pushUndo();
+
+          QTE_D_DETACH();
+          auto& track = d->tracks.modify(row);
+
           auto const dot = classificationToDetectedObjectType(value.toHash());
-          for (auto const& s : *track.track | kv::as_object_track)
+
+          // All states receive the same classification, so the best class
+          // only needs to be determined once
+          auto classId = int{-1};
+          auto score = double{0.0};
+          bestClassifier(dot, classId, score);
+
+          for (auto const i : kvr::iota(track.size()))
           {
-            if (auto const& detection = s->detection())
+            if (auto const& detection = track.detachedDetection(i))
             {
               detection->set_type(dot);
+              track.setClassification(i, classId, score);
             }
           }
 
           auto const& canonicalIndex = this->createIndex(index.row(), 0);
           emit this->dataChanged(canonicalIndex, canonicalIndex, {role});
+          return true;
         }
         break;
 
       case core::NotesRole:
         if (value.canConvert<QStringList>())
         {
+          this->pushUndo();
+
+          QTE_D_DETACH();
+          auto& track = d->tracks.modify(row);
+
           auto notes = value.toStringList();
 
-          for (auto const& s : *track.track | kv::as_object_track)
+          for (auto const i : kvr::iota(track.size()))
           {
-            if (auto const& detection = s->detection())
+            if (auto const& detection = track.detachedDetection(i))
             {
               detection->clear_notes();
 
@@ -383,17 +1013,23 @@ bool KwiverTrackModel::setData(
               }
             }
           }
+
+          auto const& canonicalIndex = this->createIndex(index.row(), 0);
+          emit this->dataChanged(canonicalIndex, canonicalIndex, {role});
+          return true;
         }
         break;
 
       case core::UserVisibilityRole:
         if (value.canConvert<bool>())
         {
-          track.visible = value.toBool();
+          QTE_D_DETACH();
+          d->tracks.modify(row).visible = value.toBool();
 
           auto const& canonicalIndex = this->createIndex(index.row(), 0);
           emit this->dataChanged(canonicalIndex, canonicalIndex,
                                  {role, core::VisibilityRole});
+          return true;
         }
         break;
 
@@ -405,6 +1041,73 @@ bool KwiverTrackModel::setData(
   return this->AbstractItemModel::setData(index, value, role);
 }
 
+// ----------------------------------------------------------------------------
+QVector<int> KwiverTrackModel::activeTracks(kv::timestamp::time_t time) const
+{
+  QTE_D_SHARED();
+
+  QMutexLocker locker{&d->lifetimeIndexMutex};
+
+  auto const totalRows = d->tracks.size();
+  auto const pendingRows = totalRows - d->lifetimeIndex.rows() +
+                           d->lifetimeIndex.outdatedEntries();
+
+  if (!d->lifetimeIndexValid ||
+      pendingRows > std::max<size_t>(64, totalRows / 8))
+  {
+    d->lifetimeIndex.build(d->tracks);
+    d->lifetimeIndexValid = true;
+  }
+
+  QVector<int> result;
+  d->lifetimeIndex.query(time, result);
+
+  auto const check = [&](size_t row){
+    auto start = kv::timestamp::time_t{0};
+    auto end = kv::timestamp::time_t{0};
+    if (trackLifetime(d->tracks[row], start, end) &&
+        start <= time && end >= time)
+    {
+      result.append(static_cast<int>(row));
+    }
+  };
+
+  // Check tracks that were added or modified since the index was built
+  for (auto const row : d->lifetimeIndex.staleRows())
+  {
+    check(static_cast<size_t>(row));
+  }
+  for (auto row = d->lifetimeIndex.rows(); row < totalRows; ++row)
+  {
+    check(row);
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+KwiverTrackSnapshot KwiverTrackModel::snapshot() const
+{
+  return {this->d_ptr};
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr KwiverTrackModel::trackSet() const
+{
+  QTE_D_SHARED();
+
+  std::vector<kv::track_sptr> tracks;
+  tracks.reserve(d->tracks.size());
+
+  for (auto const i : kvr::iota(d->tracks.size()))
+  {
+    tracks.push_back(d->tracks[i].toTrack());
+  }
+
+  return std::make_shared<kv::object_track_set>(std::move(tracks));
+}
+
 // ----------------------------------------------------------------------------
 void KwiverTrackModel::addTracks(
   kv::object_track_set_sptr const& trackSet)
@@ -414,19 +1117,31 @@ void KwiverTrackModel::addTracks(
   if (trackSet)
   {
     auto const& tracks = trackSet->tracks();
-    for (auto&& track : tracks | kvr::transform(cleanTrack) | kvr::valid)
+    for (auto const& track : tracks | kvr::valid)
     {
-      newTracks.append(std::move(track));
+      newTracks.append(track);
     }
   }
 
+  this->clearHistory();
   this->addTracks(std::move(newTracks));
 }
 
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::createTrack(kv::track_sptr const& track)
+{
+  if (track)
+  {
+    this->pushUndo();
+    this->addTracks(QVector<kv::track_sptr>{track});
+  }
+}
+
 // ----------------------------------------------------------------------------
 void KwiverTrackModel::setTracks(
   kv::object_track_set_sptr const& trackSet)
 {
+  this->clearHistory();
   this->beginResetModel();
 
   with_expr(qtScopedBlockSignals{this})
@@ -448,12 +1163,12 @@ KwiverTrackModel::MergeTracksResult KwiverTrackModel::mergeTracks(
     auto sortedIds = ids.values();
     std::sort(sortedIds.begin(), sortedIds.end());
 
-    QList<size_t const*> rows;
+    QVector<int> rows;
     for (auto const id : sortedIds)
     {
       if (auto const* row = qtGet(d->trackMap, id))
       {
-        rows.append(row);
+        rows.append(static_cast<int>(*row));
       }
     }
     return rows;
@@ -464,80 +1179,207 @@ KwiverTrackModel::MergeTracksResult KwiverTrackModel::mergeTracks(
     return MergeTracksResult::NothingToDo;
   }
 
-  QTE_D_DETACH();
-
   // Get target track
-  auto* const targetRow = rows.takeFirst();
-  auto& targetTrack = *(d->tracks[*targetRow].track);
+  auto const targetRow = rows.takeFirst();
+  auto mergedTrack = KwiverTrack{};
 
-  // Copy all target track states to temporary history
-  QMap<kv::frame_id_t, kv::track_state_sptr> tempHistory;
-  for (auto const& s : targetTrack | kv::as_object_track)
   {
-    tempHistory.insert(s->frame(), s);
-  }
+    QTE_D_CONST();
 
-  // Merge other track states into temporary history
-  for (auto *const row : rows)
-  {
-    auto const& track = *(d->tracks[*row].track);
-    for (auto const& s : track | kv::as_object_track)
+    auto const& targetTrack = d->tracks[static_cast<size_t>(targetRow)];
+
+    // Record locations of all target track states in temporary history
+    QMap<kv::frame_id_t, QPair<KwiverTrack const*, size_t>> tempHistory;
+    for (auto const i : kvr::iota(targetTrack.size()))
     {
-      if (tempHistory.contains(s->frame()))
-      {
-        return MergeTracksResult::OverlappingStates;
-      }
-      tempHistory.insert(s->frame(), s);
+      tempHistory.insert(targetTrack.frames[i], {&targetTrack, i});
     }
-  }
 
-  // Remove tracks to be merged
-  for (auto* const row : rows)
-  {
-    auto const r = static_cast<int>(*row);
-    auto const trackIter = d->tracks.begin() + r;
-    auto const trackId = (*trackIter).track->id();
-    this->beginRemoveRows({}, r, r);
-    // Remove track from tracks vector
-    d->tracks.erase(trackIter);
-    // Remove track from map
-    d->trackMap.remove(trackId);
-    // Shift map indexes
-    for (auto& j : d->trackMap)
+    // Merge other track states into temporary history
+    for (auto const row : rows)
     {
-      if (j >= *row)
+      auto const& track = d->tracks[static_cast<size_t>(row)];
+      for (auto const i : kvr::iota(track.size()))
       {
-        --j;
+        auto const frame = track.frames[i];
+        if (tempHistory.contains(frame))
+        {
+          return MergeTracksResult::OverlappingStates;
+        }
+        tempHistory.insert(frame, {&track, i});
       }
     }
-    this->endRemoveRows();
+
+    // Build merged history
+    mergedTrack.id = targetTrack.id;
+    mergedTrack.visible = targetTrack.visible;
+    for (auto const& s : tempHistory)
+    {
+      mergedTrack.append(*s.first, s.second);
+    }
   }
 
+  this->pushUndo();
+
+  QTE_D_DETACH();
+  d->updateLifetimeIndex(static_cast<size_t>(targetRow));
+
   // Clear the target track's history
-  auto const r = static_cast<int>(*targetRow);
-  auto const targetIndex = this->index(r, 0);
+  auto const targetIndex = this->index(targetRow, 0);
+  auto& track = d->tracks.modify(static_cast<size_t>(targetRow));
 
   this->beginRemoveRows(
-    targetIndex, r, r + static_cast<int>(targetTrack.size()) - 1);
-  targetTrack.clear();
+    targetIndex, 0, static_cast<int>(track.size()) - 1);
+  track.clear();
   this->endRemoveRows();
 
   // Add merged history to target track
   this->beginInsertRows(
-    targetIndex, r, r + static_cast<int>(tempHistory.size() - 1));
-  for (auto&& s : tempHistory)
-  {
-    targetTrack.append(std::move(s));
-  }
+    targetIndex, 0, static_cast<int>(mergedTrack.size()) - 1);
+  track = std::move(mergedTrack);
   this->endInsertRows();
 
+  // Remove tracks that were merged
+  this->removeTrackRows(std::move(rows));
+
   return MergeTracksResult::Success;
 }
 
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::removeTracks(QSet<qint64> const& ids)
+{
+  QVector<int> rows;
+
+  {
+    QTE_D_CONST();
+    for (auto const id : ids)
+    {
+      if (auto const* row = qtGet(d->trackMap, id))
+      {
+        rows.append(static_cast<int>(*row));
+      }
+    }
+  }
+
+  if (!rows.isEmpty())
+  {
+    this->pushUndo();
+    this->removeTrackRows(std::move(rows));
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::removeTrackRows(QVector<int>&& rows)
+{
+  if (rows.isEmpty())
+  {
+    return;
+  }
+
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+  QTE_D_DETACH();
+  d->removeFromLifetimeIndex(rows);
+
+  auto const oldCount = static_cast<int>(d->tracks.size());
+  auto const newCount = oldCount - rows.count();
+
+  auto removeTail = [&](int first, int last){
+    this->beginRemoveRows({}, first, last);
+
+    if (last + 1 == oldCount)
+    {
+      d->tracks.truncate(static_cast<size_t>(first));
+    }
+    else
+    {
+      auto tracks = d->tracks.take();
+      tracks.erase(tracks.begin() + first, tracks.begin() + last + 1);
+      d->tracks.assign(std::move(tracks));
+    }
+
+    d->trackMap.clear();
+    d->trackMap.reserve(static_cast<int>(d->tracks.size()));
+    for (auto const i : kvr::iota(d->tracks.size()))
+    {
+      d->trackMap.insert(d->tracks[i].id, i);
+    }
+
+    this->endRemoveRows();
+  };
+
+  if (rows.last() - rows.first() + 1 == rows.count())
+  {
+    // Rows to be removed are contiguous; just remove them
+    removeTail(rows.first(), rows.last());
+    return;
+  }
+
+  // Rows to be removed are not contiguous; rather than removing them one at a
+  // time (which is quadratic in the number of rows being removed), first move
+  // them to the end as a layout change, and then remove them all at once
+  emit this->layoutAboutToBeChanged({}, VerticalSortHint);
+
+  QVector<int> newRows(oldCount);
+  auto nextKept = 0;
+  auto nextRemoved = newCount;
+  auto r = rows.cbegin();
+  for (auto const oldRow : kvr::iota(oldCount))
+  {
+    if (r != rows.cend() && *r == oldRow)
+    {
+      newRows[oldRow] = nextRemoved++;
+      ++r;
+    }
+    else
+    {
+      newRows[oldRow] = nextKept++;
+    }
+  }
+
+  // Reorder tracks
+  auto tracks = d->tracks.take();
+  std::vector<TrackStore::TrackPointer> reorderedTracks(tracks.size());
+  for (auto const oldRow : kvr::iota(oldCount))
+  {
+    auto& track = tracks[static_cast<size_t>(oldRow)];
+    auto const newRow = static_cast<size_t>(newRows[oldRow]);
+    reorderedTracks[newRow] = std::move(track);
+  }
+  d->tracks.assign(std::move(reorderedTracks));
+
+  // Update persistent indices
+  auto const& oldIndices = this->persistentIndexList();
+  auto newIndices = QModelIndexList{};
+  newIndices.reserve(oldIndices.size());
+  for (auto const& index : oldIndices)
+  {
+    if (auto const pr = static_cast<int>(index.internalId()))
+    {
+      auto const parentRow = static_cast<uint>(newRows[pr - 1] + 1);
+      newIndices.append(
+        this->createIndex(index.row(), index.column(), parentRow));
+    }
+    else
+    {
+      newIndices.append(
+        this->createIndex(newRows[index.row()], index.column()));
+    }
+  }
+  this->changePersistentIndexList(oldIndices, newIndices);
+
+  emit this->layoutChanged({}, VerticalSortHint);
+
+  removeTail(newCount, oldCount - 1);
+}
+
 // ----------------------------------------------------------------------------
 void KwiverTrackModel::mergeTracks(
   kv::object_track_set_sptr const& trackSet)
 {
+  this->clearHistory();
+
   QTE_D_SHARED();
 
   QVector<kv::track_sptr> newTracks;
@@ -545,7 +1387,7 @@ void KwiverTrackModel::mergeTracks(
   if (trackSet)
   {
     auto const& tracks = trackSet->tracks();
-    for (auto&& track : tracks | kvr::transform(cleanTrack) | kvr::valid)
+    for (auto const& track : tracks | kvr::valid)
     {
       auto const id = track->id();
 
@@ -556,7 +1398,7 @@ void KwiverTrackModel::mergeTracks(
       }
       else
       {
-        newTracks.append(std::move(track));
+        newTracks.append(track);
       }
     }
   }
@@ -576,10 +1418,10 @@ void KwiverTrackModel::addTracks(QVector<kv::track_sptr>&& tracks)
 
     this->beginInsertRows({}, oldRows, oldRows + newRows - 1);
 
-    for (auto&& track : tracks)
+    for (auto const& track : tracks)
     {
       d->trackMap.insert(track->id(), d->tracks.size());
-      d->tracks.emplace_back(std::move(track));
+      d->tracks.append(KwiverTrack{*track});
     }
 
     this->endInsertRows();
@@ -592,47 +1434,85 @@ void KwiverTrackModel::updateTrack(
 {
   if (this->checkIndex(parent, IndexIsValid | ParentIsInvalid))
   {
+    // Consecutive updates of the same track are recorded as a single edit;
+    // besides keeping the history useful, this means that only the first
+    // update copies the track, and later updates modify it in place
+    auto const id = [&]{
+      QTE_D_CONST();
+      return d->tracks[static_cast<size_t>(parent.row())].id;
+    }();
+
+    if (this->history->updatedTrack != id)
+    {
+      this->pushUndo();
+      this->history->updatedTrack = id;
+    }
+
     QTE_D_DETACH();
+    d->updateLifetimeIndex(static_cast<size_t>(parent.row()));
 
-    auto& track = d->tracks[static_cast<uint>(parent.row())];
-    auto const frame = state->frame();
-    auto row = 0;
+    auto& track = d->tracks.modify(static_cast<size_t>(parent.row()));
+    auto const& ns = objectTrackState(state);
+    auto const frame = ns->frame();
+    auto const row = track.lowerBoundFrame(frame);
+    auto const r = static_cast<int>(row);
 
-    for (auto const& s : *track.track)
+    if (row < track.size() && track.frames[row] == frame)
     {
-      auto const f = s->frame();
-      if (f == frame)
-      {
-        auto stateIndex = this->index(row, 0, parent);
+      auto stateIndex = this->index(r, 0, parent);
 
-        // Replace existing state data
-        auto const& os = objectTrackState(s);
-        auto const& ns = objectTrackState(state);
-        os->set_time(ns->time());
-        os->set_detection(ns->detection());
+      // Replace existing state data
+      track.replace(row, ns->time(), ns->detection());
 
-        emit this->dataChanged(stateIndex, stateIndex);
+      emit this->dataChanged(stateIndex, stateIndex);
+    }
+    else
+    {
+      // Insert new state at the first row with a greater frame number (which
+      // may be the end)
+      this->beginInsertRows(parent, r, r);
+      track.insert(row, *ns);
+      this->endInsertRows();
+    }
+  }
+}
 
-        return;
-      }
-      else if (f > frame)
-      {
-        // Insert new state at current row
-        this->beginInsertRows(parent, row, row);
-        track.track->insert(std::move(state));
-        this->endInsertRows();
+// ----------------------------------------------------------------------------
+QModelIndex KwiverTrackModel::stateIndex(
+  QModelIndex const& parent, kv::frame_id_t frame) const
+{
+  if (this->checkIndex(parent, IndexIsValid | ParentIsInvalid))
+  {
+    QTE_D_SHARED();
 
-        return;
-      }
-      ++row;
+    auto const& track = d->tracks[static_cast<uint>(parent.row())];
+    auto const row = track.lowerBoundFrame(frame);
+    if (row < track.size() && track.frames[row] == frame)
+    {
+      return this->index(static_cast<int>(row), 0, parent);
     }
+  }
 
-    // Insert new state at end
-    Q_ASSERT(row == static_cast<int>(track.track->size()));
-    this->beginInsertRows(parent, row, row);
-    track.track->append(std::move(state));
-    this->endInsertRows();
+  return {};
+}
+
+// ----------------------------------------------------------------------------
+QModelIndex KwiverTrackModel::stateIndexAtTime(
+  QModelIndex const& parent, kv::timestamp::time_t time) const
+{
+  if (this->checkIndex(parent, IndexIsValid | ParentIsInvalid))
+  {
+    QTE_D_SHARED();
+
+    auto const& track = d->tracks[static_cast<uint>(parent.row())];
+    auto const row = track.lowerBoundTime(time);
+    if (row < track.size() && track.times[row] == time)
+    {
+      return this->index(static_cast<int>(row), 0, parent);
+    }
   }
+
+  return {};
 }
 
 // ----------------------------------------------------------------------------
@@ -642,31 +1522,76 @@ void KwiverTrackModel::mergeTracks(
   QTE_D_DETACH();
 
   auto const& parent = this->index(static_cast<int>(existingTrackIndex), 0);
-  auto& existingTrack = *(d->tracks[existingTrackIndex].track);
+  auto& existingTrack = d->tracks.modify(existingTrackIndex);
 
-  // TODO properly merge; right now this just appends states
-  auto iter = track.begin();
-  auto end = track.end();
+  QList<int> changedRows;
+  auto pendingRow = size_t{0};
+  auto pendingStates = KwiverTrack{};
+  auto changed = false;
 
-  auto const lastFrame = existingTrack.back()->frame();
-  while (iter != end && (*iter)->frame() <= lastFrame)
-  {
-    ++iter;
-  }
+  // Insert any states that have been accumulated; these are always inserted
+  // as a contiguous block
+  auto insertPendingStates = [&]{
+    if (!pendingStates.empty())
+    {
+      auto const first = static_cast<int>(pendingRow);
+      auto const last = first + static_cast<int>(pendingStates.size()) - 1;
+
+      this->beginInsertRows(parent, first, last);
+      existingTrack.insert(pendingRow, pendingStates);
+      this->endInsertRows();
 
-  if (iter != end)
+      pendingStates.clear();
+      changed = true;
+    }
+  };
+
+  // Merge incoming states (which are ordered by frame number, and so never
+  // need to be inserted before a previously merged state)
+  for (auto const& s : track | kv::as_object_track | kvr::valid)
   {
-    auto const k = static_cast<int>(existingTrack.size());
-    this->beginInsertRows(parent, k, k + static_cast<int>(end - iter) - 1);
+    auto const frame = s->frame();
+    auto row = existingTrack.lowerBoundFrame(frame);
+    auto const exists =
+      row < existingTrack.size() && existingTrack.frames[row] == frame;
 
-    while (iter != end)
+    if (!pendingStates.empty() && (exists || row != pendingRow))
     {
-      existingTrack.append((*iter)->clone(kv::clone_type::SHALLOW));
-      ++iter;
+      insertPendingStates();
+      row = existingTrack.lowerBoundFrame(frame);
     }
 
-    this->endInsertRows();
+    if (exists)
+    {
+      // Replace existing state, but only if it has actually changed
+      if (existingTrack.times[row] != s->time() ||
+          existingTrack.detections[row] != s->detection())
+      {
+        existingTrack.replace(row, s->time(), s->detection());
+        changedRows.append(static_cast<int>(row));
+        changed = true;
+      }
+    }
+    else
+    {
+      if (pendingStates.empty())
+      {
+        pendingRow = row;
+      }
+      pendingStates.insert(pendingStates.size(), *s);
+    }
+  }
+
+  insertPendingStates();
+
+  if (changed)
+  {
+    d->updateLifetimeIndex(existingTrackIndex);
 
+    if (!changedRows.isEmpty())
+    {
+      this->emitDataChanged(parent, std::move(changedRows));
+    }
     emit this->dataChanged(parent, parent);
   }
 }
@@ -674,6 +1599,8 @@ void KwiverTrackModel::mergeTracks(
 // ----------------------------------------------------------------------------
 void KwiverTrackModel::clear()
 {
+  this->clearHistory();
+
   if (this->rowCount({}))
   {
     this->beginResetModel();
@@ -683,9 +1610,98 @@ void KwiverTrackModel::clear()
 }
 
 // ----------------------------------------------------------------------------
-KwiverTrack::KwiverTrack(kv::track_sptr&& track)
-  : track{std::move(track)}
+bool KwiverTrackModel::canUndo() const
+{
+  return !this->history->undoStack.isEmpty();
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTrackModel::canRedo() const
+{
+  return !this->history->redoStack.isEmpty();
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::undo()
+{
+  auto& h = *this->history;
+  if (!h.undoStack.isEmpty())
+  {
+    auto const couldRedo = this->canRedo();
+
+    this->beginResetModel();
+    h.redoStack.append(this->d_ptr);
+    this->d_ptr = h.undoStack.takeLast();
+    h.updatedTrack = -1;
+    this->endResetModel();
+
+    this->emitHistoryChanged(true, couldRedo);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::redo()
+{
+  auto& h = *this->history;
+  if (!h.redoStack.isEmpty())
+  {
+    auto const couldUndo = this->canUndo();
+
+    this->beginResetModel();
+    h.undoStack.append(this->d_ptr);
+    this->d_ptr = h.redoStack.takeLast();
+    h.updatedTrack = -1;
+    this->endResetModel();
+
+    this->emitHistoryChanged(couldUndo, true);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::pushUndo()
+{
+  auto& h = *this->history;
+  auto const couldUndo = this->canUndo();
+  auto const couldRedo = this->canRedo();
+
+  // Taking a snapshot is cheap; the data will be detached (lazily) by the
+  // edit that follows
+  h.undoStack.append(this->d_ptr);
+  h.updatedTrack = -1;
+  while (h.undoStack.count() > KwiverTrackModelHistory::MaximumDepth)
+  {
+    h.undoStack.removeFirst();
+  }
+  h.redoStack.clear();
+
+  this->emitHistoryChanged(couldUndo, couldRedo);
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::clearHistory()
+{
+  auto& h = *this->history;
+  auto const couldUndo = this->canUndo();
+  auto const couldRedo = this->canRedo();
+
+  h.undoStack.clear();
+  h.redoStack.clear();
+  h.updatedTrack = -1;
+
+  this->emitHistoryChanged(couldUndo, couldRedo);
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackModel::emitHistoryChanged(bool couldUndo, bool couldRedo)
 {
+  if (this->canUndo() != couldUndo)
+  {
+    emit this->canUndoChanged(!couldUndo);
+  }
+  if (this->canRedo() != couldRedo)
+  {
+    emit this->canRedoChanged(!couldRedo);
+  }
 }
 
 } // namespace core
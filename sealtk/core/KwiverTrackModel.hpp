@@ -13,6 +13,8 @@
 
 #include <QSharedDataPointer>
 
+#include <memory>
+
 namespace sealtk
 {
 
@@ -20,7 +22,55 @@ namespace core
 {
 
 class KwiverTrackModelData;
+class KwiverTrackModelHistory;
+
+// ============================================================================
+/// Read-only view of the tracks of a KwiverTrackModel at a point in time.
+///
+/// A snapshot shares the data of the model from which it was taken, so taking
+/// one costs only a reference count, and later changes to the model copy only
+/// the tracks which they modify. Unlike the model, a snapshot may be read
+/// from any thread. Tracks and their states are identified by their rows in
+/// the model at the time the snapshot was taken.
+class SEALTK_CORE_EXPORT KwiverTrackSnapshot
+{
+public:
+  KwiverTrackSnapshot();
+  KwiverTrackSnapshot(KwiverTrackSnapshot const& other);
+  ~KwiverTrackSnapshot();
+
+  KwiverTrackSnapshot& operator=(KwiverTrackSnapshot const& other);
+
+  int trackCount() const;
+  int stateCount(int track) const;
+
+  kwiver::vital::track_id_t trackId(int track) const;
+  bool isTrackVisible(int track) const;
+
+  kwiver::vital::timestamp::time_t stateTime(int track, int state) const;
+
+  /// Get the classification or notes of a track state.
+  ///
+  /// This returns the same data as the model would for the state's
+  /// ClassificationTypeRole, ClassificationScoreRole, ClassificationRole or
+  /// NotesRole. The data of any other role is invalid.
+  QVariant stateData(int track, int state, int role) const;
+
+  /// Get the detection of a track state.
+  ///
+  /// The detection is shared with the model and must not be modified.
+  kwiver::vital::detected_object_sptr stateDetection(
+    int track, int state) const;
+
+private:
+  friend class KwiverTrackModel;
+
+  KwiverTrackSnapshot(QSharedDataPointer<KwiverTrackModelData> const& d);
 
+  QSharedDataPointer<KwiverTrackModelData> d;
+};
+
+// ============================================================================
 class SEALTK_CORE_EXPORT KwiverTrackModel : public AbstractItemModel
 {
   Q_OBJECT
@@ -39,6 +89,56 @@ public:
   bool setData(
     QModelIndex const& index, QVariant const& value, int role) override;
 
+  /// Get the tracks which are active at a given time.
+  ///
+  /// This method returns the (sorted) rows of all tracks whose lifetime, i.e.
+  /// the closed interval between the times of the track's first and last
+  /// states, contains \p time. This is equivalent to testing each track's
+  /// #StartTimeRole and #EndTimeRole data, but uses an interval index over
+  /// track lifetimes, such that the cost of the query is proportional to the
+  /// number of active tracks, rather than the total number of tracks.
+  ///
+  /// \note The index is built lazily, the first time this method is called.
+  ///       Tracks which are added or modified afterwards are tested
+  ///       individually, until there are enough of them that the index is
+  ///       rebuilt. Building the index is serialized, so this method may be
+  ///       called concurrently.
+  QVector<int> activeTracks(kwiver::vital::timestamp::time_t time) const;
+
+  /// Get the model's tracks as a KWIVER track set.
+  ///
+  /// This method converts the model's internal representation of its tracks
+  /// to a KWIVER track set, e.g. for writing the tracks with a KWIVER
+  /// algorithm. The returned tracks are independent of the model; however,
+  /// their detections are shared with the model and must not be modified.
+  kwiver::vital::object_track_set_sptr trackSet() const;
+
+  /// Get a snapshot of the model's tracks.
+  ///
+  /// This provides direct, read-only access to the model's tracks as they are
+  /// at the time of the call, without copying them. This is much cheaper than
+  /// either #trackSet or querying the data of each track state, and is meant
+  /// for consumers, such as track writers, which need to read every state of
+  /// every track, possibly on another thread.
+  KwiverTrackSnapshot snapshot() const;
+
+  /// Get the index of the state of a track with a given frame number.
+  ///
+  /// This method returns the index of the child of \p parent (which must be
+  /// a track) whose frame number is \p frame, or an invalid index if the
+  /// track has no such state. The lookup takes logarithmic time.
+  QModelIndex stateIndex(QModelIndex const& parent,
+                         kwiver::vital::frame_id_t frame) const;
+
+  /// Get the index of the state of a track with a given time.
+  ///
+  /// This method returns the index of the first child of \p parent (which
+  /// must be a track) whose time is \p time, or an invalid index if the track
+  /// has no such state. The lookup takes logarithmic time, and assumes that
+  /// the times of the track's states increase with frame number.
+  QModelIndex stateIndexAtTime(QModelIndex const& parent,
+                               kwiver::vital::timestamp::time_t time) const;
+
   enum class MergeTracksResult
   {
     /// The operation completed successfully.
@@ -51,12 +151,58 @@ public:
   };
   MergeTracksResult mergeTracks(QSet<qint64> const& ids);
 
+  /// Remove tracks from the model.
+  ///
+  /// This method removes all tracks whose identifiers are in \p ids. Any
+  /// number of tracks may be removed at once in time linear in the size of
+  /// the model. If the tracks to be removed do not occupy contiguous rows,
+  /// they are first moved to the end of the model (which is reported as a
+  /// layout change), so that only one row removal needs to be reported.
+  void removeTracks(QSet<qint64> const& ids);
+
   void updateTrack(QModelIndex const& parent,
                    kwiver::vital::track_state_sptr&& state);
 
+  /// Add a new track to the model as an edit which can be undone.
+  ///
+  /// This method adds \p track to the model. Unlike #addTracks, which is
+  /// intended for adding tracks that were produced by an algorithm, the
+  /// addition is recorded in the model's edit history.
+  void createTrack(kwiver::vital::track_sptr const& track);
+
+  /// Test if there is an edit which can be undone.
+  ///
+  /// Changes to a track's classification or notes, merging, removing or
+  /// creating tracks, and adding or replacing track states (#updateTrack) are
+  /// recorded in the model's edit history, up to a limit of 100 edits.
+  /// Undoing an edit restores the model to the state it was in immediately
+  /// before the edit; this is reported as a model reset. Consecutive calls to
+  /// #updateTrack for the same track are recorded as a single edit.
+  ///
+  /// Snapshots of the model's data share all unmodified tracks, such that
+  /// recording an edit costs only as much as the tracks which the edit
+  /// actually changes. However, since undoing an edit would also discard any
+  /// tracks which have since been added or merged by an algorithm, the
+  /// history is cleared by #addTracks, #setTracks, #mergeTracks (given a
+  /// track set) and #clear.
+  bool canUndo() const;
+
+  /// Test if there is an undone edit which can be redone.
+  bool canRedo() const;
+
+signals:
+  /// Emitted when the result of #canUndo changes.
+  void canUndoChanged(bool canUndo);
+
+  /// Emitted when the result of #canRedo changes.
+  void canRedoChanged(bool canRedo);
+
 public slots:
   void clear();
 
+  void undo();
+  void redo();
+
   void addTracks(kwiver::vital::object_track_set_sptr const& trackSet);
   void setTracks(kwiver::vital::object_track_set_sptr const& trackSet);
 
@@ -80,8 +226,15 @@ private:
   QTE_DECLARE_SHARED(KwiverTrackModel);
 
   void addTracks(QVector<kwiver::vital::track_sptr>&& tracks);
+  void removeTrackRows(QVector<int>&& rows);
   void mergeTracks(size_t existingTrackIndex,
                    kwiver::vital::track const& track);
+
+  void pushUndo();
+  void clearHistory();
+  void emitHistoryChanged(bool couldUndo, bool couldRedo);
+
+  std::unique_ptr<KwiverTrackModelHistory> const history;
 };
 
 } // namespace core
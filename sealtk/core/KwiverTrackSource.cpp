@@ -5,17 +5,34 @@
 #include <sealtk/core/KwiverTrackSource.hpp>
 
 #include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/TrackCache.hpp>
 
 #include <vital/algo/read_object_track_set.h>
 
+#include <vital/range/valid.h>
+
 #include <qtStlUtil.h>
 
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QQueue>
+#include <QSet>
+#include <QStringList>
 #include <QThread>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <functional>
 
 namespace kv = kwiver::vital;
 namespace kva = kwiver::vital::algo;
+namespace kvr = kwiver::vital::range;
 
 namespace sealtk
 {
@@ -23,6 +40,194 @@ namespace sealtk
 namespace core
 {
 
+namespace // anonymous
+{
+
+// Maximum number of track states which may have been read, but not yet added
+// to the model, before the reader waits for the model to catch up
+constexpr qint64 maximumQueuedStates = 200000;
+
+// Maximum number of tracks which are merged into the model at once
+constexpr size_t sliceSize = 256;
+
+// Time, in milliseconds, which may be spent adding tracks to the model before
+// returning to the event loop
+constexpr qint64 frameBudget = 12;
+
+using IdCollisionPolicy = KwiverTrackSource::IdCollisionPolicy;
+
+// ============================================================================
+struct ReadJob
+{
+  QUrl uri;
+  kv::object_track_set_sptr tracks;
+  QString error;
+
+  // Metadata of the file, taken before it was read, and whether a cache
+  // should be written for it
+  QFileInfo sourceInfo;
+  bool cacheNeeded;
+};
+
+// ----------------------------------------------------------------------------
+QString readerConfig(QUrl const& uri)
+{
+  // Items are ordered by key, so that equivalent configurations have the same
+  // representation; the order of items with the same key is significant, as
+  // the last value given for a key is the one that is used
+  auto items = QUrlQuery{uri}.queryItems(QUrl::FullyDecoded);
+  std::stable_sort(items.begin(), items.end(),
+                   [](QPair<QString, QString> const& a,
+                      QPair<QString, QString> const& b){
+                     return a.first < b.first;
+                   });
+
+  auto result = QStringList{};
+  for (auto const& item : items)
+  {
+    result.append(item.first + QLatin1Char{'='} + item.second);
+  }
+
+  return result.join(QLatin1Char{'\n'});
+}
+
+// ----------------------------------------------------------------------------
+QString cachePath(QUrl const& uri)
+{
+  return trackCachePath(uri.toLocalFile(), readerConfig(uri));
+}
+
+// ----------------------------------------------------------------------------
+QString readSource(
+  QUrl const& uri, QAtomicInt const& cancelled,
+  std::function<void()> const& opened,
+  std::function<void(kv::object_track_set_sptr const&)> const& consume)
+{
+  try
+  {
+    // Set config options for reading tracks
+    auto config = kwiver::vital::config_block::empty_config();
+    auto params = QUrlQuery{uri};
+    for (auto const& p : params.queryItems())
+    {
+      config->set_value(stdString(p.first), stdString(p.second));
+    }
+
+    // Create algorithm to read tracks
+    kva::read_object_track_set_sptr input;
+    kva::read_object_track_set::set_nested_algo_configuration(
+      "input", config, input);
+
+    if (!input)
+    {
+      return QStringLiteral("Failed to initialize reader");
+    }
+
+    input->open(stdString(uri.toLocalFile()));
+    opened();
+
+    // Read tracks
+    kv::object_track_set_sptr tracks;
+    while (!cancelled.load() && input->read_set(tracks))
+    {
+      if (tracks)
+      {
+        consume(tracks);
+      }
+    }
+  }
+  catch (std::exception const& e)
+  {
+    return QString::fromLocal8Bit(e.what());
+  }
+
+  return {};
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr combineTracks(
+  QVector<ReadJob> const& jobs, IdCollisionPolicy policy)
+{
+  // Determine the first identifier not used by any file, which is where
+  // renumbering starts
+  auto nextId = kv::track_id_t{0};
+  for (auto const& job : jobs)
+  {
+    if (job.tracks)
+    {
+      for (auto const& track : job.tracks->tracks() | kvr::valid)
+      {
+        nextId = std::max(nextId, track->id() + 1);
+      }
+    }
+  }
+
+  kv::object_track_set_sptr result;
+  QSet<kv::track_id_t> usedIds;
+  QSet<kv::track_id_t> clonedIds;
+
+  for (auto const& job : jobs)
+  {
+    if (!job.tracks)
+    {
+      continue;
+    }
+
+    // The tracks which were read are not modified, as they may yet be written
+    // to a cache; tracks which need to be changed are cloned first
+    auto trackList = job.tracks->tracks();
+    if (policy == IdCollisionPolicy::Renumber)
+    {
+      // Give new identifiers to tracks whose identifiers were used by
+      // previous files
+      for (auto& track : trackList)
+      {
+        if (track && usedIds.contains(track->id()))
+        {
+          track = track->clone();
+          track->set_id(nextId++);
+        }
+      }
+    }
+    else if (result)
+    {
+      // Tracks which share an identifier with a track from a previous file
+      // are merged into that track, which must therefore be a clone
+      for (auto const& track : trackList | kvr::valid)
+      {
+        auto const id = track->id();
+        if (usedIds.contains(id) && !clonedIds.contains(id))
+        {
+          auto const& existing = result->get_track(id);
+          result->remove(existing);
+          result->insert(existing->clone());
+          clonedIds.insert(id);
+        }
+      }
+    }
+
+    for (auto const& track : trackList | kvr::valid)
+    {
+      usedIds.insert(track->id());
+    }
+
+    auto tracks =
+      std::make_shared<kv::object_track_set>(std::move(trackList));
+    if (result)
+    {
+      result->merge_in_other_track_set(tracks);
+    }
+    else
+    {
+      result = std::move(tracks);
+    }
+  }
+
+  return result;
+}
+
+} // namespace <anonymous>
+
 // ============================================================================
 class KwiverTrackSourcePrivate : public QThread
 {
@@ -31,7 +236,38 @@ public:
 
   void run() override;
 
-  QUrl tracksUri;
+  void emitModel();
+  void readTracks();
+  void readFiles();
+  void readFile(ReadJob& job) const;
+  kv::object_track_set_sptr readCache(
+    QUrl const& uri, QFileInfo const& sourceInfo) const;
+  void writeCaches(QVector<ReadJob> const& jobs) const;
+
+  void enqueue(kv::object_track_set_sptr const& tracks);
+  void finishReading();
+  void scheduleFeed();
+  void feedModel();
+
+  QList<QUrl> tracksUris;
+  bool progressive = false;
+  bool caching = false;
+  IdCollisionPolicy idCollisionPolicy = IdCollisionPolicy::Renumber;
+
+  QAtomicInt cancelled;
+
+  // Members used only by the thread which owns the source
+  std::shared_ptr<KwiverTrackModel> model;
+  qint64 statesLoaded = 0;
+  bool loading = false;
+
+  // Members shared between the reader and the thread which owns the source
+  QMutex mutex;
+  QWaitCondition queueDrained;
+  QQueue<kv::track_sptr> queue;
+  qint64 queuedStates = 0;
+  bool feedPending = false;
+  bool readingDone = false;
 
 private:
   QTE_DECLARE_PUBLIC(KwiverTrackSource)
@@ -51,6 +287,8 @@ KwiverTrackSource::KwiverTrackSource(QObject* parent)
 KwiverTrackSource::~KwiverTrackSource()
 {
   QTE_D();
+
+  this->cancel();
   d->wait();
 }
 
@@ -58,83 +296,462 @@ KwiverTrackSource::~KwiverTrackSource()
 bool KwiverTrackSource::active() const
 {
   QTE_D();
-  return d->isRunning();
+  return d->isRunning() || d->loading;
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTrackSource::progressiveLoading() const
+{
+  QTE_D();
+  return d->progressive;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSource::setProgressiveLoading(bool enabled)
+{
+  QTE_D();
+  d->progressive = enabled;
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTrackSource::cachingEnabled() const
+{
+  QTE_D();
+  return d->caching;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSource::setCachingEnabled(bool enabled)
+{
+  QTE_D();
+  d->caching = enabled;
 }
 
 // ----------------------------------------------------------------------------
 bool KwiverTrackSource::readData(QUrl const& uri)
+{
+  return this->readData(QList<QUrl>{uri});
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTrackSource::readData(QList<QUrl> const& uris)
 {
   QTE_D();
 
-  if (d->isRunning())
+  if (uris.isEmpty() || this->active())
   {
     return false;
   }
 
-  d->tracksUri = uri;
+  d->tracksUris = uris;
+  d->cancelled.store(0);
+
+  if (d->progressive)
+  {
+    d->model = std::make_shared<KwiverTrackModel>();
+    d->statesLoaded = 0;
+    d->loading = true;
+
+    d->queue.clear();
+    d->queuedStates = 0;
+    d->feedPending = false;
+    d->readingDone = false;
+  }
+
   d->start();
 
   return true;
 }
 
 // ----------------------------------------------------------------------------
-void KwiverTrackSourcePrivate::run()
+auto KwiverTrackSource::idCollisionPolicy() const -> IdCollisionPolicy
 {
-  QTE_Q();
+  QTE_D();
+  return d->idCollisionPolicy;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSource::setIdCollisionPolicy(IdCollisionPolicy policy)
+{
+  QTE_D();
+  d->idCollisionPolicy = policy;
+}
 
-  kv::object_track_set_sptr intermediateTracks;
-  kv::object_track_set_sptr finalTracks;
+// ----------------------------------------------------------------------------
+void KwiverTrackSource::cancel()
+{
+  QTE_D();
 
-  try
+  d->cancelled.store(1);
+
+  // Wake the reader if it is waiting for the model to catch up
+  QMutexLocker locker{&d->mutex};
+  d->queueDrained.wakeAll();
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::run()
+{
+  if (this->progressive && this->tracksUris.count() == 1)
   {
-    // Set config options for reading tracks
-    auto config = kwiver::vital::config_block::empty_config();
-    auto params = QUrlQuery{this->tracksUri};
-    for (auto const& p : params.queryItems())
+    this->readTracks();
+  }
+  else
+  {
+    this->readFiles();
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::writeCaches(QVector<ReadJob> const& jobs) const
+{
+  for (auto const& job : jobs)
+  {
+    if (job.cacheNeeded && !this->cancelled.load())
     {
-      config->set_value(stdString(p.first), stdString(p.second));
+      writeTrackCache(cachePath(job.uri), job.tracks, job.sourceInfo);
     }
+  }
+}
 
-    // Create algorithm to read tracks
-    kva::read_object_track_set_sptr input;
-    kva::read_object_track_set::set_nested_algo_configuration(
-      "input", config, input);
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::emitModel()
+{
+  QTE_Q();
 
-    if (!input)
-    {
-      emit q->failed(QStringLiteral("Failed to initialize reader"));
-      return;
-    }
+  // Hand out the (possibly still empty) model on the source's thread
+  QMetaObject::invokeMethod(
+    q, [this, q]{ emit q->modelReady(this->model); },
+    Qt::QueuedConnection);
+}
 
-    input->open(stdString(this->tracksUri.toLocalFile()));
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::readTracks()
+{
+  QTE_Q();
 
-    // Read tracks
-    while (input->read_set(intermediateTracks))
-    {
-      if (intermediateTracks)
+  auto const& uri = this->tracksUris.first();
+  auto const& path = uri.toLocalFile();
+
+  // Get the source's metadata before reading it (see readFile)
+  auto sourceInfo = QFileInfo{path};
+  sourceInfo.exists();
+
+  if (auto const& cachedTracks = readCache(uri, sourceInfo))
+  {
+    this->emitModel();
+    this->enqueue(cachedTracks);
+    this->finishReading();
+    return;
+  }
+
+  // The tracks are handed to the model as they are read, so the tracks to be
+  // written to the cache are copies, taken before the model sees them
+  kv::object_track_set_sptr cacheTracks;
+
+  auto const& error = readSource(
+    uri, this->cancelled, [this]{ this->emitModel(); },
+    [this, &cacheTracks](kv::object_track_set_sptr const& tracks){
+      if (this->caching)
       {
-        if (finalTracks)
+        auto copies = std::vector<kv::track_sptr>{};
+        for (auto const& track : tracks->tracks() | kvr::valid)
+        {
+          copies.push_back(track->clone());
+        }
+
+        auto copy = std::make_shared<kv::object_track_set>(std::move(copies));
+        if (cacheTracks)
         {
-          finalTracks->merge_in_other_track_set(intermediateTracks);
+          cacheTracks->merge_in_other_track_set(copy);
         }
         else
         {
-          finalTracks = intermediateTracks;
+          cacheTracks = std::move(copy);
         }
       }
+
+      this->enqueue(tracks);
+    });
+
+  if (!error.isEmpty())
+  {
+    emit q->failed(error);
+    this->finishReading();
+    return;
+  }
+
+  this->finishReading();
+
+  // Write the cache now that the tracks have been handed out; the cache holds
+  // the tracks as they were read, regardless of any changes made to the model
+  // in the meantime
+  if (cacheTracks && !this->cancelled.load())
+  {
+    writeTrackCache(cachePath(uri), cacheTracks, sourceInfo);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::readFiles()
+{
+  QTE_Q();
+
+  if (this->progressive)
+  {
+    this->emitModel();
+  }
+
+  // Read all files concurrently
+  QVector<ReadJob> jobs;
+  for (auto const& uri : this->tracksUris)
+  {
+    jobs.append({uri, nullptr, {}, {}, false});
+  }
+
+  QtConcurrent::blockingMap(jobs, [this](ReadJob& job){
+    this->readFile(job);
+  });
+
+  // Check for errors
+  QString error;
+  for (auto const& job : jobs)
+  {
+    if (!job.error.isEmpty())
+    {
+      error = job.error;
+      if (jobs.count() > 1)
+      {
+        error = QStringLiteral("Failed to read %1: %2")
+                  .arg(job.uri.toLocalFile(), job.error);
+      }
+      break;
     }
   }
-  catch (std::exception const& e)
+
+  if (!error.isEmpty())
+  {
+    emit q->failed(error);
+  }
+  else if (this->cancelled.load() && !this->progressive)
   {
-    emit q->failed(QString::fromLocal8Bit(e.what()));
+    emit q->failed(QStringLiteral("Reading tracks was canceled"));
+  }
+
+  if (!error.isEmpty() || this->cancelled.load())
+  {
+    if (this->progressive)
+    {
+      // The model has already been handed out; leave it empty
+      this->finishReading();
+    }
     return;
   }
 
-  // Create the data model
-  auto model = std::make_shared<KwiverTrackModel>();
-  model->addTracks(finalTracks);
+  // Combine the results
+  auto const& tracks = combineTracks(jobs, this->idCollisionPolicy);
+
+  if (this->progressive)
+  {
+    if (tracks)
+    {
+      this->enqueue(tracks);
+    }
+    this->finishReading();
+  }
+  else
+  {
+    // Create the data model
+    auto model = std::make_shared<KwiverTrackModel>();
+    model->addTracks(tracks);
+
+    emit q->modelReady(model);
+    emit q->loadFinished();
+  }
+
+  // Write caches for files which were parsed, now that the tracks have been
+  // handed out
+  this->writeCaches(jobs);
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::readFile(ReadJob& job) const
+{
+  // Get the source's metadata before reading it, so that a cache written from
+  // what was read will be out of date if the source changes while it is being
+  // read (QFileInfo caches the metadata the first time it is queried)
+  job.sourceInfo = QFileInfo{job.uri.toLocalFile()};
+  job.sourceInfo.exists();
 
-  emit q->modelReady(model);
+  if ((job.tracks = this->readCache(job.uri, job.sourceInfo)))
+  {
+    return;
+  }
+
+  job.error = readSource(
+    job.uri, this->cancelled, []{},
+    [&job](kv::object_track_set_sptr const& tracks){
+      if (job.tracks)
+      {
+        job.tracks->merge_in_other_track_set(tracks);
+      }
+      else
+      {
+        job.tracks = tracks;
+      }
+    });
+
+  // The cache is written once loading has finished (see writeCaches), so that
+  // writing it does not delay the model
+  job.cacheNeeded = job.error.isEmpty() && job.tracks && this->caching &&
+                    !this->cancelled.load();
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr KwiverTrackSourcePrivate::readCache(
+  QUrl const& uri, QFileInfo const& sourceInfo) const
+{
+  // The URI may name a cache file, or there may be an up to date cache (for
+  // the same reader configuration) next to the source
+  if (auto const& tracks = readTrackCache(uri.toLocalFile()))
+  {
+    return tracks;
+  }
+
+  if (this->caching)
+  {
+    return readTrackCache(cachePath(uri), sourceInfo);
+  }
+
+  return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::enqueue(
+  kv::object_track_set_sptr const& tracks)
+{
+  QMutexLocker locker{&this->mutex};
+
+  // Wait for the model to catch up if too much data is already queued
+  while (this->queuedStates >= maximumQueuedStates && !this->cancelled.load())
+  {
+    this->queueDrained.wait(&this->mutex);
+  }
+
+  for (auto const& track : tracks->tracks() | kvr::valid)
+  {
+    this->queue.enqueue(track);
+    this->queuedStates += static_cast<qint64>(track->size());
+  }
+
+  this->scheduleFeed();
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::finishReading()
+{
+  QMutexLocker locker{&this->mutex};
+
+  this->readingDone = true;
+  this->scheduleFeed();
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::scheduleFeed()
+{
+  // NOTE: Caller must hold the mutex
+  if (!this->feedPending)
+  {
+    QTE_Q();
+
+    this->feedPending = true;
+    QMetaObject::invokeMethod(
+      q, [this]{ this->feedModel(); }, Qt::QueuedConnection);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTrackSourcePrivate::feedModel()
+{
+  QTE_Q();
+
+  QElapsedTimer timer;
+  timer.start();
+
+  auto const initialStatesLoaded = this->statesLoaded;
+  auto finished = false;
+
+  for (;;)
+  {
+    std::vector<kv::track_sptr> slice;
+    auto sliceStates = qint64{0};
+
+    {
+      QMutexLocker locker{&this->mutex};
+
+      if (this->cancelled.load())
+      {
+        this->queue.clear();
+        this->queuedStates = 0;
+      }
+
+      // The same track may be split across several batches; since the model
+      // only merges incoming tracks with tracks it already contains, a slice
+      // must not contain more than one part of any track
+      QSet<kv::track_id_t> ids;
+      while (!this->queue.isEmpty() && slice.size() < sliceSize)
+      {
+        auto const id = this->queue.head()->id();
+        if (ids.contains(id))
+        {
+          break;
+        }
+
+        ids.insert(id);
+        slice.push_back(this->queue.dequeue());
+        sliceStates += static_cast<qint64>(slice.back()->size());
+      }
+
+      this->queuedStates -= sliceStates;
+
+      if (slice.empty())
+      {
+        this->feedPending = false;
+        finished = this->readingDone;
+      }
+    }
+
+    this->queueDrained.wakeAll();
+
+    if (slice.empty())
+    {
+      break;
+    }
+
+    this->model->mergeTracks(
+      std::make_shared<kv::object_track_set>(std::move(slice)));
+    this->statesLoaded += sliceStates;
+
+    if (timer.elapsed() >= frameBudget)
+    {
+      // Return to the event loop, so that the user interface can update; the
+      // feed remains pending, so it is not also scheduled by the reader
+      QMetaObject::invokeMethod(
+        q, [this]{ this->feedModel(); }, Qt::QueuedConnection);
+      break;
+    }
+  }
+
+  if (this->statesLoaded != initialStatesLoaded)
+  {
+    emit q->loadProgress(this->statesLoaded);
+  }
+
+  if (finished)
+  {
+    this->loading = false;
+    emit q->loadFinished();
+  }
 }
 
 } // namespace core
@@ -11,6 +11,8 @@
 
 #include <qtGlobal.h>
 
+#include <QList>
+
 namespace sealtk
 {
 
@@ -25,12 +27,108 @@ class SEALTK_CORE_EXPORT KwiverTrackSource : public AbstractDataSource
   Q_OBJECT
 
 public:
+  /// Policy for handling tracks in different files with the same identifier.
+  enum class IdCollisionPolicy
+  {
+    /// Tracks with the same identifier are assumed to be the same track, and
+    /// are merged.
+    Merge,
+    /// Tracks whose identifiers were already used by a previous file (in the
+    /// order given to #readData) are given new, unused identifiers.
+    Renumber,
+  };
+
   explicit KwiverTrackSource(QObject* parent = nullptr);
   ~KwiverTrackSource() override;
 
   bool active() const override;
   bool readData(QUrl const& uri) override;
 
+  /// Read data from several URIs into a single model.
+  ///
+  /// This reads tracks from each of the specified URIs, as if by
+  /// #readData(QUrl const&). The files are read concurrently, using the
+  /// global thread pool. Once all files have been read, identifier
+  /// collisions between files are resolved according to the
+  /// #idCollisionPolicy, and the tracks are combined into a single model.
+  ///
+  /// If any file cannot be read, #failed is emitted (with a message that
+  /// identifies the file), and no tracks are added to the model.
+  bool readData(QList<QUrl> const& uris);
+
+  /// Get the policy for handling identifier collisions between files.
+  IdCollisionPolicy idCollisionPolicy() const;
+
+  /// Set the policy for handling identifier collisions between files.
+  ///
+  /// The default policy is IdCollisionPolicy::Renumber.
+  ///
+  /// This must be set before calling #readData.
+  void setIdCollisionPolicy(IdCollisionPolicy policy);
+
+  /// Test if progressive loading is enabled.
+  bool progressiveLoading() const;
+
+  /// Set whether tracks are loaded progressively.
+  ///
+  /// By default, the source reads all tracks before creating the model and
+  /// emitting #modelReady. When progressive loading is enabled, #modelReady
+  /// is instead emitted as soon as the input has been opened, and tracks are
+  /// added to the (initially empty) model in bounded batches as they are
+  /// read. Batches are merged by the thread which owns the source, in slices
+  /// that are limited to a fraction of a UI frame, so that the user interface
+  /// remains responsive. The reader is throttled if the model falls behind,
+  /// so that only a bounded number of tracks are held in flight.
+  ///
+  /// If an error occurs after the model has been emitted, #failed is still
+  /// emitted, and the model retains the tracks which were loaded before the
+  /// error.
+  ///
+  /// This must be set before calling #readData.
+  void setProgressiveLoading(bool enabled);
+
+  /// Test if track caching is enabled.
+  bool cachingEnabled() const;
+
+  /// Set whether a binary track cache is used.
+  ///
+  /// When caching is enabled, the source first looks for a binary track cache
+  /// (see #writeTrackCache) next to the file being read, which was written
+  /// using the same reader configuration (i.e. the query of the URI). If a
+  /// cache exists and is up to date, tracks are loaded from the cache instead
+  /// of being parsed. Otherwise, after the tracks have been read
+  /// successfully, a cache is written for use the next time the file is read.
+  /// The cache is written after the model has been handed out, by the
+  /// source's reader thread; the source remains #active until it has been
+  /// written. Failure to write the cache is not an error.
+  ///
+  /// Caching is disabled by default, because the cache only preserves the
+  /// bounding box, confidence, classification and notes of each detection;
+  /// tracks loaded from a cache lack any other data (e.g. masks or keypoints)
+  /// which the reader may have provided.
+  ///
+  /// Regardless of this setting, a URI which names a track cache file is
+  /// always read as such.
+  ///
+  /// This must be set before calling #readData.
+  void setCachingEnabled(bool enabled);
+
+public slots:
+  /// Stop loading tracks.
+  ///
+  /// This method stops the reading of tracks. If the model has not yet been
+  /// emitted, #failed is emitted. Otherwise, tracks which have not yet been
+  /// added to the model are discarded, and #loadFinished is emitted.
+  void cancel();
+
+signals:
+  /// Emitted when tracks have been added to the model during progressive
+  /// loading. The value is the total number of track states loaded so far.
+  void loadProgress(qint64 statesLoaded);
+
+  /// Emitted when the source has finished adding tracks to the model.
+  void loadFinished();
+
 protected:
   QTE_DECLARE_PRIVATE_RPTR(KwiverTrackSource)
 
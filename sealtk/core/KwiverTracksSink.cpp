@@ -6,6 +6,8 @@
 
 #include <sealtk/core/DataModelTypes.hpp>
 #include <sealtk/core/IdentityTransform.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/ScalarFilterModel.hpp>
 #include <sealtk/core/TrackUtils.hpp>
 #include <sealtk/core/TimeMap.hpp>
 #include <sealtk/core/VideoMetaData.hpp>
@@ -20,10 +22,20 @@
 #include <qtStlUtil.h>
 
 #include <QAbstractItemModel>
+#include <QAtomicInt>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QPolygonF>
+#include <QSet>
+#include <QTimer>
 #include <QUrl>
 #include <QUrlQuery>
 
+#include <QtConcurrentRun>
+
+#include <limits>
+
 namespace kv = kwiver::vital;
 namespace kva = kwiver::vital::algo;
 namespace kvr = kwiver::vital::range;
@@ -38,21 +50,73 @@ namespace core
 class KwiverTracksSinkPrivate
 {
 public:
-  QPointF transformPoint(
-    QPointF const& in, kv::transform_2d_sptr const& transform) const;
-  kv::detected_object_sptr makeDetection(
-    QAbstractItemModel* model, QModelIndex const& index,
-    kv::transform_2d_sptr const& transform) const;
+  // Model data of a track state, as taken from the model; conversion to
+  // KWIVER types is deferred until the data is written
+  struct State
+  {
+    qint64 id;
+    int source;
+    QRectF box;
+    QVariantHash classification;
+    QStringList notes;
+  };
+
+  // Track state of a snapshot of a KwiverTrackModel, by position
+  struct SnapshotState
+  {
+    int source;
+    int track;
+    int state;
+  };
 
   struct Frame
   {
     kv::path_t name;
     kv::frame_id_t frameNumber;
-    std::unordered_map<qint64, kv::track_state_sptr> trackStates;
+    std::vector<State> states;
+  };
+
+  struct Source
+  {
+    // The first transform maps the model's coordinate space into the common
+    // coordinate space, and the second maps the common coordinate space into
+    // that of the primary data
+    kv::transform_2d_sptr toCommon;
+    kv::transform_2d_sptr toPrimary;
+
+    // Data of a KwiverTrackModel is not copied state by state, but read from
+    // a snapshot of the model when the data is written; the bounds on the
+    // classification score of a ScalarFilterModel over the model are
+    // likewise applied when the data is written
+    KwiverTrackSnapshot snapshot;
+    bool includeHidden;
+    double lowerScore;
+    double upperScore;
   };
 
-  QMap<kv::timestamp::time_t, Frame> frames;
+  static bool takeSnapshot(Source& source, QAbstractItemModel* model);
+
+  static bool includes(Source const& source, int track);
+  static bool includes(Source const& source, int track, int state);
+  static bool includes(Source const& source, QVariant const& score);
+  bool hasStates(Source const& source) const;
+
+  QPointF transformPoint(QPointF const& in, Source const& source) const;
+  QRectF transformBox(QRectF const& in, Source const& source) const;
+  kv::detected_object_sptr makeDetection(State const& state) const;
+  kv::detected_object_sptr makeDetection(SnapshotState const& state) const;
+
+  QString write(QUrl const& uri) const;
+
+  // The frames and sources are released as they are written
+  mutable QMap<kv::timestamp::time_t, Frame> frames;
+  mutable std::vector<Source> sources;
   kv::transform_2d_sptr transform;
+  KwiverTracksSink::ExportMode exportMode =
+    KwiverTracksSink::ExportMode::Cumulative;
+
+  mutable QAtomicInt framesWritten;
+  mutable QAtomicInt cancelled;
 };
 
 // ----------------------------------------------------------------------------
@@ -69,6 +133,33 @@ KwiverTracksSink::~KwiverTracksSink()
 {
 }
 
+// ----------------------------------------------------------------------------
+KwiverTracksSink::ExportMode KwiverTracksSink::exportMode() const
+{
+  QTE_D();
+  return d->exportMode;
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTracksSink::setExportMode(ExportMode mode)
+{
+  QTE_D();
+  d->exportMode = mode;
+}
+
+// ----------------------------------------------------------------------------
+KwiverTracksSink::ExportMode KwiverTracksSink::exportModeForWriter(
+  QString const& writerType)
+{
+  if (writerType == QStringLiteral("kw18") ||
+      writerType == QStringLiteral("viame_csv"))
+  {
+    return ExportMode::Incremental;
+  }
+
+  return ExportMode::Cumulative;
+}
+
 // ----------------------------------------------------------------------------
 bool KwiverTracksSink::setData(
   VideoSource* video, QAbstractItemModel* model, bool includeHidden)
@@ -78,6 +169,7 @@ bool KwiverTracksSink::setData(
   Q_ASSERT(video);
 
   d->frames.clear();
+  d->sources.clear();
   d->transform = std::make_shared<IdentityTransform>();
 
   // Extract frame names from video
@@ -120,6 +212,19 @@ bool KwiverTracksSink::addData(
 
   if (model && transform && d->transform)
   {
+    constexpr auto inf = std::numeric_limits<double>::infinity();
+
+    auto const source = static_cast<int>(d->sources.size());
+    d->sources.push_back(
+      {transform, d->transform, {}, includeHidden, -inf, +inf});
+
+    // Only take a snapshot of the model's data if possible, which costs a
+    // reference count; its states are matched to frames when the data is
+    // written
+    if (d->takeSnapshot(d->sources.back(), model))
+    {
+      return d->hasStates(d->sources.back());
+    }
 
     // Iterate over all items in data model
     for (auto const i : kvr::iota(model->rowCount()))
@@ -157,13 +262,13 @@ bool KwiverTracksSink::addData(
         // Look up entry in frame map
         if (auto* const frame = qtGet(d->frames, t))
         {
-          // Create track state
-          auto const f = frame->frameNumber;
-          auto detection = d->makeDetection(model, jIndex, transform);
-          auto state = createTrackState(f, t, std::move(detection));
-
-          // Add state to map
-          frame->trackStates.emplace(id, std::move(state));
+          // Add state to frame
+          frame->states.push_back({
+            id, source,
+            model->data(jIndex, AreaLocationRole).toRectF(),
+            model->data(jIndex, ClassificationRole).toHash(),
+            model->data(jIndex, NotesRole).toStringList(),
+          });
           haveData = true;
         }
       }
@@ -178,6 +283,56 @@ void KwiverTracksSink::writeData(QUrl const& uri) const
 {
   QTE_D();
 
+  d->framesWritten.store(0);
+  d->cancelled.store(0);
+
+  auto const framesTotal = d->frames.count();
+  auto const& reportProgress = [this, d, framesTotal]{
+    emit this->writeProgress(d->framesWritten.load(), framesTotal);
+  };
+
+  // Write the data on a pool thread, while running an event loop in this
+  // thread so that the user interface remains responsive
+  auto error = QString{};
+
+  QEventLoop eventLoop;
+  QFutureWatcher<void> watcher;
+  QTimer progressTimer;
+
+  connect(&watcher, &QFutureWatcher<void>::finished,
+          &eventLoop, &QEventLoop::quit);
+  connect(&progressTimer, &QTimer::timeout, &eventLoop, reportProgress);
+
+  watcher.setFuture(QtConcurrent::run([d, &uri, &error]{
+    error = d->write(uri);
+  }));
+
+  progressTimer.start(100);
+  eventLoop.exec();
+  progressTimer.stop();
+
+  // Release whatever data was not written (e.g. if writing was canceled)
+  d->frames.clear();
+  d->sources.clear();
+
+  reportProgress();
+
+  if (!error.isEmpty())
+  {
+    emit this->failed(error);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void KwiverTracksSink::cancel()
+{
+  QTE_D();
+  d->cancelled.store(1);
+}
+
+// ----------------------------------------------------------------------------
+QString KwiverTracksSinkPrivate::write(QUrl const& uri) const
+{
   auto config = kv::config_block::empty_config();
   auto params = QUrlQuery{uri};
   for (auto const& p : params.queryItems())
@@ -194,81 +349,351 @@ void KwiverTracksSink::writeData(QUrl const& uri) const
 
     if (!writer)
     {
-      emit this->failed(
-        QStringLiteral("KwiverTracksSink::writeData: "
-                       "Writer could not be configured"));
-      return;
+      return QStringLiteral("KwiverTracksSink::writeData: "
+                            "Writer could not be configured");
     }
 
     writer->open(stdString(uri.toLocalFile()));
 
+    using ExportMode = KwiverTracksSink::ExportMode;
+
     auto tracks = std::unordered_map<qint64, kv::track_sptr>{};
     auto trackSet = std::make_shared<kv::object_track_set>();
+    auto const accumulate = (this->exportMode != ExportMode::Incremental);
+
+    // Index the states of snapshots by time; the index holds only the
+    // positions of the states
+    auto snapshotStates =
+      QHash<kv::timestamp::time_t, std::vector<SnapshotState>>{};
+    for (auto const s : kvr::iota(static_cast<int>(this->sources.size())))
+    {
+      auto const& source = this->sources[static_cast<size_t>(s)];
+      auto const& snapshot = source.snapshot;
+      for (auto const t : kvr::iota(snapshot.trackCount()))
+      {
+        if (!includes(source, t))
+        {
+          continue;
+        }
+
+        for (auto const i : kvr::iota(snapshot.stateCount(t)))
+        {
+          auto const time = snapshot.stateTime(t, i);
+          if (this->frames.contains(time) && includes(source, t, i))
+          {
+            snapshotStates[time].push_back({s, t, i});
+          }
+        }
+      }
+    }
+
+    // The last frame is needed to write the tracks after all frames have
+    // been written (and released)
+    auto lastTimeStamp = kv::timestamp{};
+    auto lastName = kv::path_t{};
+    if (!this->frames.isEmpty())
+    {
+      auto const& last = this->frames.last();
+      lastTimeStamp = kv::timestamp{this->frames.lastKey(), last.frameNumber};
+      lastName = last.name;
+    }
 
-    // Iterate over frames
-    for (auto const& fi : d->frames | kvr::indirect)
+    // Iterate over frames, releasing the data of each frame once it has been
+    // written
+    while (!this->frames.isEmpty())
     {
-      auto const& frame = fi.value();
-      auto const timeStamp = kv::timestamp{fi.key(), frame.frameNumber};
+      if (this->cancelled.load())
+      {
+        writer->close();
+        return QStringLiteral("Writing tracks was canceled");
+      }
+
+      auto const fi = this->frames.begin();
+      auto const time = fi.key();
+      auto const frame = std::move(fi.value());
+      this->frames.erase(fi);
 
-      // Update tracks
-      for (auto const& si : frame.trackStates)
+      auto const timeStamp = kv::timestamp{time, frame.frameNumber};
+
+      auto frameSnapshotStates = std::vector<SnapshotState>{};
+      auto const si = snapshotStates.find(time);
+      if (si != snapshotStates.end())
       {
+        frameSnapshotStates = std::move(si.value());
+        snapshotStates.erase(si);
+      }
+
+      // Update tracks; if a track has more than one state on this frame, the
+      // first one (i.e. from the primary data) is used
+      auto tracksUpdated = QSet<qint64>{};
+      auto activeTracks = std::vector<kv::track_sptr>{};
+      auto const& addState = [&](qint64 id, auto const& s){
+        if (tracksUpdated.contains(id))
+        {
+          return;
+        }
+        tracksUpdated.insert(id);
+
         // Get track for state, creating a new one if necessary
-        auto& track = tracks[si.first];
+        auto& track = tracks[id];
         if (!track)
         {
           track = kv::track::create();
-          track->set_id(si.first);
-          trackSet->insert(track);
+          track->set_id(id);
+          if (accumulate)
+          {
+            trackSet->insert(track);
+          }
         }
 
-        // Set frame on track state
-        si.second->set_frame(frame.frameNumber);
+        // Create track state
+        auto state = createTrackState(
+          frame.frameNumber, time, this->makeDetection(s));
 
         // Update track
-        track->append(si.second);
-        trackSet->notify_new_state(si.second);
+        track->append(state);
+        if (accumulate)
+        {
+          trackSet->notify_new_state(state);
+        }
+        else
+        {
+          activeTracks.push_back(track);
+        }
+      };
+
+      // Take states in the order of their sources, whether copied or from a
+      // snapshot, so that the primary data takes precedence
+      for (auto const n : kvr::iota(static_cast<int>(this->sources.size())))
+      {
+        for (auto const& s : frame.states)
+        {
+          if (s.source == n)
+          {
+            addState(s.id, s);
+          }
+        }
+
+        for (auto const& s : frameSnapshotStates)
+        {
+          if (s.source == n)
+          {
+            auto const& snapshot =
+              this->sources[static_cast<size_t>(n)].snapshot;
+            addState(snapshot.trackId(s.track), s);
+          }
+        }
       }
 
       // Write tracks at current frame
-      writer->write_set(trackSet, timeStamp, frame.name);
+      switch (this->exportMode)
+      {
+        case ExportMode::Cumulative:
+          writer->write_set(trackSet, timeStamp, frame.name);
+          break;
+
+        case ExportMode::Incremental:
+          writer->write_set(
+            std::make_shared<kv::object_track_set>(activeTracks),
+            timeStamp, frame.name);
+          break;
+
+        default:
+          // Tracks are written after the last frame
+          break;
+      }
+
+      this->framesWritten.fetchAndAddRelaxed(1);
+    }
+
+    if (this->exportMode == ExportMode::Final && lastTimeStamp.is_valid())
+    {
+      writer->write_set(trackSet, lastTimeStamp, lastName);
     }
 
     writer->close();
   }
   catch (std::exception const& e)
   {
-    emit this->failed(QString::fromLocal8Bit(e.what()));
+    return QString::fromLocal8Bit(e.what());
+  }
+
+  return {};
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTracksSinkPrivate::takeSnapshot(
+  Source& source, QAbstractItemModel* model)
+{
+  if (auto* const trackModel = qobject_cast<KwiverTrackModel*>(model))
+  {
+    source.snapshot = trackModel->snapshot();
+    return true;
+  }
+
+  // A filter over a KwiverTrackModel can be applied to a snapshot of the
+  // model if it only bounds the classification score (as is the case when
+  // exporting from the user interface); any other filter is applied by
+  // copying the filtered data
+  auto* const filterModel = qobject_cast<ScalarFilterModel*>(model);
+  if (!filterModel)
+  {
+    return false;
+  }
+
+  auto const& bounds = filterModel->bounds();
+  for (auto const role : bounds.keys())
+  {
+    if (role != ClassificationScoreRole)
+    {
+      return false;
+    }
+  }
+
+  auto* const sourceModel = filterModel->sourceModel();
+  if (auto* const trackModel = qobject_cast<KwiverTrackModel*>(sourceModel))
+  {
+    auto const& scoreBounds = bounds.value(ClassificationScoreRole);
+    if (scoreBounds.first.isValid())
+    {
+      source.lowerScore = scoreBounds.first.toDouble();
+    }
+    if (scoreBounds.second.isValid())
+    {
+      source.upperScore = scoreBounds.second.toDouble();
+    }
+
+    source.snapshot = trackModel->snapshot();
+    return true;
+  }
+
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTracksSinkPrivate::includes(Source const& source, int track)
+{
+  if (source.includeHidden)
+  {
+    return true;
+  }
+
+  // As with the model's data, the classification of a track is that of its
+  // last state
+  auto const& snapshot = source.snapshot;
+  auto const last = snapshot.stateCount(track) - 1;
+  return snapshot.isTrackVisible(track) && last >= 0 &&
+         includes(source, snapshot.stateData(
+                            track, last, ClassificationScoreRole));
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTracksSinkPrivate::includes(
+  Source const& source, int track, int state)
+{
+  return source.includeHidden ||
+         includes(source, source.snapshot.stateData(
+                            track, state, ClassificationScoreRole));
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTracksSinkPrivate::includes(
+  Source const& source, QVariant const& score)
+{
+  // This matches the test used by ScalarFilterModel, which treats a missing
+  // score as zero
+  auto const v = score.toDouble();
+  return !(v < source.lowerScore || source.upperScore < v);
+}
+
+// ----------------------------------------------------------------------------
+bool KwiverTracksSinkPrivate::hasStates(Source const& source) const
+{
+  auto const& snapshot = source.snapshot;
+  for (auto const t : kvr::iota(snapshot.trackCount()))
+  {
+    if (includes(source, t))
+    {
+      for (auto const i : kvr::iota(snapshot.stateCount(t)))
+      {
+        if (this->frames.contains(snapshot.stateTime(t, i)) &&
+            includes(source, t, i))
+        {
+          return true;
+        }
+      }
+    }
   }
+
+  return false;
 }
 
 // ----------------------------------------------------------------------------
 QPointF KwiverTracksSinkPrivate::transformPoint(
-  QPointF const& in, kv::transform_2d_sptr const& transform) const
+  QPointF const& in, Source const& source) const
 {
-  auto const& worldPoint = transform->map({in.x(), in.y()});
-  auto const& out = this->transform->map(worldPoint);
+  auto const& worldPoint = source.toCommon->map({in.x(), in.y()});
+  auto const& out = source.toPrimary->map(worldPoint);
   return {out.x(), out.y()};
 }
 
+// ----------------------------------------------------------------------------
+QRectF KwiverTracksSinkPrivate::transformBox(
+  QRectF const& in, Source const& source) const
+{
+  auto poly = QPolygonF{};
+  poly.append(this->transformPoint(in.topLeft(), source));
+  poly.append(this->transformPoint(in.topRight(), source));
+  poly.append(this->transformPoint(in.bottomLeft(), source));
+  poly.append(this->transformPoint(in.bottomRight(), source));
+
+  return poly.boundingRect();
+}
+
 // ----------------------------------------------------------------------------
 kv::detected_object_sptr KwiverTracksSinkPrivate::makeDetection(
-  QAbstractItemModel* model, QModelIndex const& index,
-  kv::transform_2d_sptr const& transform) const
+  State const& state) const
 {
-  auto const& originalBox = model->data(index, AreaLocationRole).toRectF();
-  auto const& type = model->data(index, ClassificationRole).toHash();
-  auto const& notes = model->data(index, NotesRole).toStringList();
+  auto const& source = this->sources[static_cast<size_t>(state.source)];
+  return createDetection(this->transformBox(state.box, source),
+                         state.classification, state.notes);
+}
 
-  auto poly = QPolygonF{};
-  poly.append(this->transformPoint(originalBox.topLeft(), transform));
-  poly.append(this->transformPoint(originalBox.topRight(), transform));
-  poly.append(this->transformPoint(originalBox.bottomLeft(), transform));
-  poly.append(this->transformPoint(originalBox.bottomRight(), transform));
-  auto const& detection = createDetection(poly.boundingRect(), type, notes);
+// ----------------------------------------------------------------------------
+kv::detected_object_sptr KwiverTracksSinkPrivate::makeDetection(
+  SnapshotState const& state) const
+{
+  auto const& source = this->sources[static_cast<size_t>(state.source)];
+  auto const& detection =
+    source.snapshot.stateDetection(state.track, state.state);
+  if (!detection)
+  {
+    return createDetection(this->transformBox({}, source));
+  }
+
+  // Produce the same detection as would be created from the model's data;
+  // the classification is not modified, and so can be shared
+  auto const& inBox = detection->bounding_box();
+  auto const& box = this->transformBox(
+    {QPointF{inBox.min_x(), inBox.min_y()},
+     QPointF{inBox.max_x(), inBox.max_y()}}, source);
+
+  auto type = detection->type();
+  if (type && !type->size())
+  {
+    type = nullptr;
+  }
+
+  auto result = std::make_shared<kv::detected_object>(
+    kv::bounding_box_d{box.left(), box.top(), box.right(), box.bottom()},
+    1.0, type);
+
+  for (auto const& n : detection->notes())
+  {
+    result->add_note(n);
+  }
 
-  return detection;
+  return result;
 }
 
 } // namespace core
@@ -28,9 +28,43 @@ class SEALTK_CORE_EXPORT KwiverTracksSink : public AbstractDataSink
   Q_OBJECT
 
 public:
+  /// Manner in which tracks are passed to the KWIVER track writer.
+  enum class ExportMode
+  {
+    /// For each frame, the writer is given every track written so far. This
+    /// works with any writer, but the total work done by the writer may grow
+    /// quadratically with the number of tracks.
+    Cumulative,
+    /// For each frame, the writer is given only the tracks which have a state
+    /// on that frame. This is suitable for writers which accumulate the tracks
+    /// they are given by identifier, such as the KW18 and VIAME CSV writers,
+    /// and keeps the work done by the writer proportional to the number of
+    /// track states.
+    Incremental,
+    /// The writer is given every track once, after the last frame. This is
+    /// suitable for writers which do not need the name of each frame.
+    Final,
+  };
+
   KwiverTracksSink(QObject* parent = nullptr);
   ~KwiverTracksSink() override;
 
+  /// Get the manner in which tracks are passed to the writer.
+  ExportMode exportMode() const;
+
+  /// Set the manner in which tracks are passed to the writer.
+  ///
+  /// The default mode is ExportMode::Cumulative.
+  void setExportMode(ExportMode mode);
+
+  /// Get the most efficient export mode which is safe for a writer.
+  ///
+  /// This returns ExportMode::Incremental for writers which are known to
+  /// accumulate the tracks they are given (\c kw18 and \c viame_csv), and
+  /// ExportMode::Cumulative for any other writer. \p writerType is the name
+  /// of the KWIVER plugin which implements the writer.
+  static ExportMode exportModeForWriter(QString const& writerType);
+
   bool setData(
     VideoSource* video, QAbstractItemModel* model,
     bool includeHidden = false) override;
@@ -43,8 +77,40 @@ public:
     kwiver::vital::transform_2d_sptr const& transform,
     bool includeHidden = false) override;
 
+  /// Write data to the specified URI.
+  ///
+  /// The data is converted and written on a separate thread, one frame at a
+  /// time, while this method runs an event loop until writing is finished.
+  /// Progress is reported by #writeProgress, and writing may be stopped
+  /// early by calling #cancel, in which case #failed is emitted.
+  ///
+  /// The data is consumed by this method; the data of each frame is released
+  /// once the frame has been written, and #setData must be called again
+  /// before writing the data again.
+  ///
+  /// \note The models given to #setData and #addData are not used by this
+  ///       method. The data of a KwiverTrackModel is not copied; instead, a
+  ///       snapshot of the model is taken (see KwiverTrackModel::snapshot),
+  ///       which is unaffected by later changes to the model. The same is
+  ///       done for a ScalarFilterModel over a KwiverTrackModel whose only
+  ///       bounds are on the ClassificationScoreRole; the bounds are applied
+  ///       to the snapshot as it is written. The data of other models is
+  ///       copied when it is added to the sink.
+  ///
+  /// \warning Because an event loop runs, timers and queued events are
+  ///          processed while data is being written. Callers which change
+  ///          the models in response to such events must not assume that
+  ///          the models are unchanged when this method returns.
   void writeData(QUrl const& uri) const override;
 
+public slots:
+  /// Stop writing data.
+  void cancel();
+
+signals:
+  /// Emitted periodically while data is being written.
+  void writeProgress(int framesWritten, int framesTotal) const;
+
 protected:
   QTE_DECLARE_PRIVATE_RPTR(KwiverTracksSink)
 
@@ -0,0 +1,213 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/core/PipelineMetrics.hpp>
+
+#include <vital/range/iota.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace kvr = kwiver::vital::range;
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace // anonymous
+{
+
+constexpr auto nsPerMs = 1e6;
+
+// ----------------------------------------------------------------------------
+template <typename Func>
+void forEachStage(PipelineMetrics const& metrics, Func const& func)
+{
+  for (auto const i : kvr::iota(metrics.frameLatency.count()))
+  {
+    func(QStringLiteral("frameLatency"), i, metrics.frameLatency[i]);
+  }
+
+  func(QStringLiteral("inputWait"), -1, metrics.inputWait);
+  func(QStringLiteral("sendTime"), -1, metrics.sendTime);
+  func(QStringLiteral("outputLatency"), -1, metrics.outputLatency);
+  func(QStringLiteral("outputTime"), -1, metrics.outputTime);
+}
+
+// ----------------------------------------------------------------------------
+QJsonObject statisticsToJson(TimingStatistics const& statistics)
+{
+  return {
+    {QStringLiteral("count"), statistics.count},
+    {QStringLiteral("totalMs"), statistics.total / nsPerMs},
+    {QStringLiteral("meanMs"), statistics.mean()},
+    {QStringLiteral("maximumMs"), statistics.maximum / nsPerMs},
+  };
+}
+
+} // namespace <anonymous>
+
+// ----------------------------------------------------------------------------
+void TimingStatistics::add(qint64 duration)
+{
+  ++this->count;
+  this->total += duration;
+  this->maximum = std::max(this->maximum, duration);
+}
+
+// ----------------------------------------------------------------------------
+void TimingStatistics::merge(TimingStatistics const& other)
+{
+  this->count += other.count;
+  this->total += other.total;
+  this->maximum = std::max(this->maximum, other.maximum);
+}
+
+// ----------------------------------------------------------------------------
+double TimingStatistics::mean() const
+{
+  return (this->count ? this->total / (this->count * nsPerMs) : 0.0);
+}
+
+// ----------------------------------------------------------------------------
+void PipelineMetrics::merge(PipelineMetrics const& other)
+{
+  this->elapsed = std::max(this->elapsed, other.elapsed);
+  this->framesReceived += other.framesReceived;
+  this->stepsSent += other.stepsSent;
+  this->stepsReused += other.stepsReused;
+  this->outputsReceived += other.outputsReceived;
+
+  if (this->frameLatency.count() < other.frameLatency.count())
+  {
+    this->frameLatency.resize(other.frameLatency.count());
+  }
+  for (auto const i : kvr::iota(other.frameLatency.count()))
+  {
+    this->frameLatency[i].merge(other.frameLatency[i]);
+  }
+
+  this->inputWait.merge(other.inputWait);
+  this->sendTime.merge(other.sendTime);
+  this->outputLatency.merge(other.outputLatency);
+  this->outputTime.merge(other.outputTime);
+}
+
+// ----------------------------------------------------------------------------
+double PipelineMetrics::framesPerSecond() const
+{
+  if (this->elapsed <= 0)
+  {
+    return 0.0;
+  }
+
+  return this->framesReceived * 1e9 / this->elapsed;
+}
+
+// ----------------------------------------------------------------------------
+QString PipelineMetrics::summary() const
+{
+  auto latency = QStringList{};
+  for (auto const& s : this->frameLatency)
+  {
+    latency.append(QString::number(s.mean(), 'f', 1));
+  }
+
+  return QStringLiteral(
+    "%1 frames (%2 fps); %3 steps sent, %4 reused, %5 outputs; "
+    "mean ms: frame latency [%6], input wait %7, send %8, "
+    "output latency %9, output %10")
+    .arg(this->framesReceived)
+    .arg(this->framesPerSecond(), 0, 'f', 2)
+    .arg(this->stepsSent)
+    .arg(this->stepsReused)
+    .arg(this->outputsReceived)
+    .arg(latency.join(QStringLiteral(", ")))
+    .arg(this->inputWait.mean(), 0, 'f', 1)
+    .arg(this->sendTime.mean(), 0, 'f', 1)
+    .arg(this->outputLatency.mean(), 0, 'f', 1)
+    .arg(this->outputTime.mean(), 0, 'f', 1);
+}
+
+// ----------------------------------------------------------------------------
+QJsonObject PipelineMetrics::toJson() const
+{
+  auto frameLatency = QJsonArray{};
+  for (auto const& s : this->frameLatency)
+  {
+    frameLatency.append(statisticsToJson(s));
+  }
+
+  return {
+    {QStringLiteral("elapsedMs"), this->elapsed / nsPerMs},
+    {QStringLiteral("framesReceived"), this->framesReceived},
+    {QStringLiteral("framesPerSecond"), this->framesPerSecond()},
+    {QStringLiteral("stepsSent"), this->stepsSent},
+    {QStringLiteral("stepsReused"), this->stepsReused},
+    {QStringLiteral("outputsReceived"), this->outputsReceived},
+    {QStringLiteral("frameLatency"), frameLatency},
+    {QStringLiteral("inputWait"), statisticsToJson(this->inputWait)},
+    {QStringLiteral("sendTime"), statisticsToJson(this->sendTime)},
+    {QStringLiteral("outputLatency"),
+     statisticsToJson(this->outputLatency)},
+    {QStringLiteral("outputTime"), statisticsToJson(this->outputTime)},
+  };
+}
+
+// ----------------------------------------------------------------------------
+QString PipelineMetrics::toCsv() const
+{
+  auto result = QString{};
+  QTextStream stream{&result};
+
+  stream << "stage,source,count,totalMs,meanMs,maximumMs\n";
+  forEachStage(
+    *this, [&stream](QString const& name, int source,
+                     TimingStatistics const& statistics){
+      stream << name << ',';
+      if (source >= 0)
+      {
+        stream << source;
+      }
+      stream << ',' << statistics.count
+             << ',' << statistics.total / nsPerMs
+             << ',' << statistics.mean()
+             << ',' << statistics.maximum / nsPerMs << '\n';
+    });
+
+  stream.flush();
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+bool PipelineMetrics::write(QString const& path) const
+{
+  QSaveFile file{path};
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    return false;
+  }
+
+  if (path.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive))
+  {
+    file.write(this->toCsv().toUtf8());
+  }
+  else
+  {
+    file.write(QJsonDocument{this->toJson()}.toJson());
+  }
+
+  return file.commit();
+}
+
+} // namespace core
+
+} // namespace sealtk
@@ -0,0 +1,113 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#ifndef sealtk_core_PipelineMetrics_hpp
+#define sealtk_core_PipelineMetrics_hpp
+
+#include <sealtk/core/Export.h>
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+namespace sealtk
+{
+
+namespace core
+{
+
+// ============================================================================
+/// Statistics of a repeatedly measured duration.
+///
+/// All durations are in nanoseconds.
+struct SEALTK_CORE_EXPORT TimingStatistics
+{
+  void add(qint64 duration);
+
+  /// Add the measurements of \p other to these statistics.
+  void merge(TimingStatistics const& other);
+
+  /// Get the mean duration, in milliseconds.
+  double mean() const;
+
+  int count = 0;
+  qint64 total = 0;
+  qint64 maximum = 0;
+};
+
+// ============================================================================
+/// Throughput and latency of a pipeline execution.
+///
+/// These metrics are collected by KwiverPipelineWorker while it executes, and
+/// describe where time is spent in each stage of getting frames through the
+/// pipeline: waiting for video sources to provide frames, handing input to
+/// the pipeline, and receiving and processing the pipeline's output.
+struct SEALTK_CORE_EXPORT PipelineMetrics
+{
+  /// Time since execution started, in nanoseconds.
+  qint64 elapsed = 0;
+
+  /// Number of frames received from video sources.
+  int framesReceived = 0;
+
+  /// Number of time steps sent to the pipeline.
+  int stepsSent = 0;
+
+  /// Number of time steps whose output was reused rather than computed.
+  int stepsReused = 0;
+
+  /// Number of outputs received from the pipeline.
+  int outputsReceived = 0;
+
+  /// Time from requesting a frame to receiving it, for each video source.
+  QVector<TimingStatistics> frameLatency;
+
+  /// Time spent waiting for all frames of a time step to be received.
+  TimingStatistics inputWait;
+
+  /// Time spent blocked handing input to the pipeline.
+  TimingStatistics sendTime;
+
+  /// Time from sending input to receiving the corresponding output.
+  TimingStatistics outputLatency;
+
+  /// Time spent processing output received from the pipeline.
+  TimingStatistics outputTime;
+
+  /// Combine the metrics of an execution which ran concurrently.
+  ///
+  /// This adds the counters and timing statistics of \p other to these
+  /// metrics, e.g. to describe the combined execution of several pipeline
+  /// instances which each process part of the input. Since the executions
+  /// overlap, the elapsed time is the longer of the two elapsed times.
+  void merge(PipelineMetrics const& other);
+
+  /// Get the number of frames received per second of execution.
+  double framesPerSecond() const;
+
+  /// Get a human readable, single line summary of the metrics.
+  QString summary() const;
+
+  /// Get the metrics as a JSON object.
+  QJsonObject toJson() const;
+
+  /// Get the metrics as CSV.
+  ///
+  /// The result has a header line, followed by one line of timing statistics
+  /// for each stage (and for each video source, for frame latency). Unlike
+  /// the JSON form, the result does not include the counters.
+  QString toCsv() const;
+
+  /// Write the metrics to the file \p path.
+  ///
+  /// The metrics are written as CSV if the name of the file ends with
+  /// <code>.csv</code>, and as JSON otherwise.
+  bool write(QString const& path) const;
+};
+
+} // namespace core
+
+} // namespace sealtk
+
+#endif
@@ -0,0 +1,313 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/core/PipelineResultCache.hpp>
+
+#include <sealtk/core/TrackCache.hpp>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTextStream>
+
+namespace kv = kwiver::vital;
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace // anonymous
+{
+
+// ----------------------------------------------------------------------------
+void addIdentity(QCryptographicHash& hash, QFileInfo const& info)
+{
+  auto data = QByteArray{};
+  QDataStream stream{&data, QIODevice::WriteOnly};
+
+  stream << info.absoluteFilePath() << info.size()
+         << info.lastModified().toMSecsSinceEpoch();
+
+  hash.addData(data);
+}
+
+// ----------------------------------------------------------------------------
+bool addPipeline(QCryptographicHash& hash, QString const& path,
+                 QSet<QString>& visited)
+{
+  static auto const includeRe = QRegularExpression{
+    QStringLiteral("^\\s*include\\s+(\\S.*?)\\s*$")};
+  static auto const relativePathRe = QRegularExpression{
+    QStringLiteral("^\\s*relativepath\\s+[^=]+=\\s*(\\S.*?)\\s*$")};
+
+  auto const& info = QFileInfo{path};
+  auto const& canonicalPath = info.canonicalFilePath();
+  if (visited.contains(canonicalPath))
+  {
+    return true;
+  }
+  visited.insert(canonicalPath);
+
+  QFile file{path};
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    return false;
+  }
+
+  auto const& content = file.readAll();
+  hash.addData(content);
+
+  // Account for files referenced by the pipeline; included files are hashed
+  // by content, while other files (e.g. models) are identified by their size
+  // and modification time
+  auto const& base = info.absoluteDir();
+  QTextStream stream{content};
+  while (!stream.atEnd())
+  {
+    auto const& line = stream.readLine();
+
+    auto const& im = includeRe.match(line);
+    if (im.hasMatch())
+    {
+      if (!addPipeline(hash, base.filePath(im.captured(1)), visited))
+      {
+        return false;
+      }
+      continue;
+    }
+
+    auto const& rm = relativePathRe.match(line);
+    if (rm.hasMatch())
+    {
+      auto const& referenceInfo = QFileInfo{base.filePath(rm.captured(1))};
+      if (referenceInfo.exists())
+      {
+        addIdentity(hash, referenceInfo);
+      }
+    }
+  }
+
+  return true;
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class PipelineResultCachePrivate
+{
+public:
+  QString entryPath(QByteArray const& key, int index) const;
+
+  void trim();
+
+  QByteArray pipelineHash;
+  QDir directory;
+  qint64 sizeLimit;
+  bool valid = false;
+
+  QMutex mutex;
+  qint64 size = -1;
+};
+
+QTE_IMPLEMENT_D_FUNC(PipelineResultCache)
+
+// ----------------------------------------------------------------------------
+QString PipelineResultCachePrivate::entryPath(
+  QByteArray const& key, int index) const
+{
+  auto const& name = QString::fromLatin1(key.toHex());
+  return this->directory.filePath(
+    QStringLiteral("%1-%2.cache").arg(name).arg(index));
+}
+
+// ----------------------------------------------------------------------------
+void PipelineResultCachePrivate::trim()
+{
+  // Get entries, most recently used first
+  auto const& entries = this->directory.entryInfoList(
+    {QStringLiteral("*.cache")}, QDir::Files, QDir::Time);
+
+  this->size = 0;
+  for (auto const& entry : entries)
+  {
+    this->size += entry.size();
+  }
+
+  if (this->size <= this->sizeLimit)
+  {
+    return;
+  }
+
+  // Remove least recently used entries until the cache is comfortably within
+  // its limit, so that we don't need to do this again immediately
+  auto const target = this->sizeLimit - (this->sizeLimit / 10);
+  for (auto i = entries.count(); this->size > target && i > 0; --i)
+  {
+    auto const& entry = entries[i - 1];
+    if (QFile::remove(entry.filePath()))
+    {
+      this->size -= entry.size();
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+PipelineResultCache::PipelineResultCache(
+  QString const& pipelineFile, QString const& directory, qint64 sizeLimit)
+  : d_ptr{new PipelineResultCachePrivate}
+{
+  QTE_D();
+
+  d->directory = QDir{directory};
+  d->sizeLimit = sizeLimit;
+
+  QCryptographicHash hash{QCryptographicHash::Sha1};
+  auto visited = QSet<QString>{};
+  if (addPipeline(hash, pipelineFile, visited))
+  {
+    d->pipelineHash = hash.result();
+    d->valid = d->directory.mkpath(QStringLiteral("."));
+  }
+}
+
+// ----------------------------------------------------------------------------
+PipelineResultCache::~PipelineResultCache()
+{
+}
+
+// ----------------------------------------------------------------------------
+QString PipelineResultCache::defaultDirectory()
+{
+  auto const& base = QStandardPaths::writableLocation(
+    QStandardPaths::GenericCacheLocation);
+  return base + QStringLiteral("/sealtk/pipeline-results");
+}
+
+// ----------------------------------------------------------------------------
+qint64 PipelineResultCache::defaultSizeLimit()
+{
+  return qint64{1} << 30;
+}
+
+// ----------------------------------------------------------------------------
+bool PipelineResultCache::isValid() const
+{
+  QTE_D();
+  return d->valid;
+}
+
+// ----------------------------------------------------------------------------
+QByteArray PipelineResultCache::key(
+  kv::timestamp::time_t time, QVector<QString> const& inputs) const
+{
+  QTE_D();
+
+  if (!d->valid)
+  {
+    return {};
+  }
+
+  QCryptographicHash hash{QCryptographicHash::Sha1};
+  hash.addData(d->pipelineHash);
+
+  auto data = QByteArray{};
+  QDataStream stream{&data, QIODevice::WriteOnly};
+  stream << static_cast<qint64>(time) << inputs.count();
+  hash.addData(data);
+
+  for (auto const& input : inputs)
+  {
+    if (input.isEmpty())
+    {
+      hash.addData(QByteArray(1, '\0'));
+      continue;
+    }
+
+    auto const& info = QFileInfo{input};
+    if (!info.isFile())
+    {
+      return {};
+    }
+
+    addIdentity(hash, info);
+  }
+
+  return hash.result();
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr PipelineResultCache::find(
+  QByteArray const& key, int index) const
+{
+  QTE_D();
+
+  if (key.isEmpty())
+  {
+    return nullptr;
+  }
+
+  auto const& path = d->entryPath(key, index);
+  auto tracks = readTrackCache(path);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+  if (tracks)
+  {
+    // Mark the entry as recently used
+    QFile file{path};
+    if (file.open(QIODevice::Append))
+    {
+      file.setFileTime(QDateTime::currentDateTimeUtc(),
+                       QFileDevice::FileModificationTime);
+    }
+  }
+#endif
+
+  return tracks;
+}
+
+// ----------------------------------------------------------------------------
+void PipelineResultCache::insert(
+  QByteArray const& key, int index, kv::object_track_set_sptr const& tracks)
+{
+  QTE_D();
+
+  if (key.isEmpty() || !tracks)
+  {
+    return;
+  }
+
+  auto const& path = d->entryPath(key, index);
+  if (!writeTrackCache(path, tracks))
+  {
+    return;
+  }
+
+  QMutexLocker locker{&d->mutex};
+
+  if (d->size < 0)
+  {
+    d->trim();
+  }
+  else
+  {
+    d->size += QFileInfo{path}.size();
+    if (d->size > d->sizeLimit)
+    {
+      d->trim();
+    }
+  }
+}
+
+} // namespace core
+
+} // namespace sealtk
@@ -0,0 +1,107 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#ifndef sealtk_core_PipelineResultCache_hpp
+#define sealtk_core_PipelineResultCache_hpp
+
+#include <sealtk/core/Export.h>
+
+#include <vital/types/object_track_set.h>
+#include <vital/types/timestamp.h>
+
+#include <qtGlobal.h>
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace sealtk
+{
+
+namespace core
+{
+
+class PipelineResultCachePrivate;
+
+// ============================================================================
+/// On-disk cache of the results of executing a pipeline.
+///
+/// This class stores the output of a pipeline for individual time steps, so
+/// that executing the same pipeline again over the same input can reuse the
+/// earlier output instead of recomputing it. Results are addressed by a key
+/// which identifies the pipeline (by the content of the pipeline file, the
+/// content of any files it includes, and the size and modification time of
+/// any other files it references), the time step, and the input images (by
+/// their paths, sizes and modification times).
+///
+/// Results are stored as track cache files (see #writeTrackCache) in a cache
+/// directory. When the total size of the cache exceeds its size limit, the
+/// least recently used results are removed.
+///
+/// \note
+///   Like all track caches, cached results preserve only the bounding box,
+///   confidence, classification and notes of each detection. Any other data
+///   produced by the pipeline, such as masks, descriptors or key points, is
+///   not available from results which are reused.
+///
+/// All methods are thread safe.
+class SEALTK_CORE_EXPORT PipelineResultCache
+{
+public:
+  /// Create a cache for the results of \p pipelineFile.
+  ///
+  /// Results are stored in \p directory, which is created if necessary, and
+  /// which may be shared by caches for different pipelines. The size of the
+  /// directory is limited to approximately \p sizeLimit bytes.
+  explicit PipelineResultCache(QString const& pipelineFile,
+                               QString const& directory = defaultDirectory(),
+                               qint64 sizeLimit = defaultSizeLimit());
+  ~PipelineResultCache();
+
+  /// Get the default cache directory.
+  ///
+  /// This is a directory in the user's cache location.
+  static QString defaultDirectory();
+
+  /// Get the default limit on the size of the cache directory, in bytes.
+  static qint64 defaultSizeLimit();
+
+  /// Test if the cache can be used.
+  ///
+  /// This returns \c false if the pipeline file could not be read or the
+  /// cache directory could not be created.
+  bool isValid() const;
+
+  /// Compute the key of a time step.
+  ///
+  /// This computes the key for the results of the pipeline for the time step
+  /// at \p time, whose inputs are the images \p inputs (in the order of the
+  /// pipeline's inputs). An input may be empty, if the time step has no image
+  /// for that input. If any (non-empty) input does not name an existing file,
+  /// the inputs cannot be identified and an empty key is returned.
+  QByteArray key(kwiver::vital::timestamp::time_t time,
+                 QVector<QString> const& inputs) const;
+
+  /// Look up the results for output \p index of a time step.
+  ///
+  /// \return The cached tracks, or \c nullptr if no results are cached.
+  kwiver::vital::object_track_set_sptr find(
+    QByteArray const& key, int index) const;
+
+  /// Store the results for output \p index of a time step.
+  void insert(QByteArray const& key, int index,
+              kwiver::vital::object_track_set_sptr const& tracks);
+
+protected:
+  QTE_DECLARE_PRIVATE_RPTR(PipelineResultCache)
+
+private:
+  QTE_DECLARE_PRIVATE(PipelineResultCache)
+};
+
+} // namespace core
+
+} // namespace sealtk
+
+#endif
@@ -6,11 +6,17 @@
 
 #include <sealtk/core/DataModelTypes.hpp>
 
-#include <vital/range/indirect.h>
+#include <vital/types/timestamp.h>
 
 #include <QHash>
 
-namespace kvr = kwiver::vital::range;
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace kv = kwiver::vital;
+
+using time_us_t = kv::timestamp::time_t;
 
 namespace sealtk
 {
@@ -22,15 +28,108 @@ namespace core
 class ScalarFilterModelPrivate
 {
 public:
+  ScalarFilterModelPrivate(ScalarFilterModel* q) : q_ptr{q} {}
+
+  enum class Kind
+  {
+    Time,
+    Real,
+    Text,
+    Generic,
+  };
+
+  // A bound, compiled into a form that can be tested without going through
+  // the role-switching comparison, together with the source values of the
+  // top-level rows for the bound's role
+  struct Predicate
+  {
+    int role;
+    Kind kind;
+
+    QVariant lower;
+    QVariant upper;
+
+    time_us_t lowerTime;
+    time_us_t upperTime;
+    double lowerReal;
+    double upperReal;
+    QString lowerText;
+    QString upperText;
+
+    std::vector<time_us_t> times;
+    std::vector<double> reals;
+    std::vector<QString> texts;
+    std::vector<QVariant> values;
+  };
+
+  static Kind kind(int role);
+
+  void compile(int role);
+
+  bool accepts(QModelIndex const& sourceIndex) const;
+  bool accepts(Predicate const& predicate, QVariant const& data) const;
+  static bool accepts(Predicate const& predicate, QString const& text);
+
+  template <typename Change>
+  void update(Change const& change);
+
+  void rebuild();
+  void insertRows(int first, int last);
+  void removeRows(int first, int last);
+  void updateRows(int first, int last, QVector<int> const& roles = {});
+
+  void load(Predicate& predicate, int first, int last);
+  void evaluate(int first, int last);
+
   QHash<int, QPair<QVariant, QVariant>> bounds;
+
+  QAbstractItemModel* source = nullptr;
+  QList<QMetaObject::Connection> sourceConnections;
+
+  // Compiled bounds and cached visibility of the source model's top-level
+  // rows; the cache is only maintained while at least one bound is active
+  std::vector<Predicate> predicates;
+  std::vector<bool> visible;
+
+private:
+  QTE_DECLARE_PUBLIC(ScalarFilterModel)
+  QTE_DECLARE_PUBLIC_PTR(ScalarFilterModel)
 };
 
 // ----------------------------------------------------------------------------
 QTE_IMPLEMENT_D_FUNC(ScalarFilterModel)
 
+// ----------------------------------------------------------------------------
+template <typename Change>
+void ScalarFilterModelPrivate::update(Change const& change)
+{
+  QTE_Q();
+
+  // Apply the change, and report the rows whose cached visibility flipped; an
+  // empty cache means that no bounds are active, i.e. that all rows pass
+  auto const before = this->visible;
+  change();
+
+  auto const& after = this->visible;
+  auto const size = std::max(before.size(), after.size());
+
+  auto rows = QVector<int>{};
+  for (auto i = size_t{0}; i < size; ++i)
+  {
+    auto const wasVisible = (i < before.size() ? before[i] : true);
+    auto const isVisible = (i < after.size() ? after[i] : true);
+    if (wasVisible != isVisible)
+    {
+      rows.append(static_cast<int>(i));
+    }
+  }
+
+  q->invalidateVisibility(rows);
+}
+
 // ----------------------------------------------------------------------------
 ScalarFilterModel::ScalarFilterModel(QObject* parent)
-  : AbstractProxyModel{parent}, d_ptr{new ScalarFilterModelPrivate}
+  : AbstractProxyModel{parent}, d_ptr{new ScalarFilterModelPrivate{this}}
 {
   // Our filtering is dependent on the logical data model's data; therefore, we
   // need to re-filter and/or re-sort when the underlying data changes, and so
@@ -43,6 +142,13 @@ ScalarFilterModel::~ScalarFilterModel()
 {
 }
 
+// ----------------------------------------------------------------------------
+QHash<int, QPair<QVariant, QVariant>> ScalarFilterModel::bounds() const
+{
+  QTE_D();
+  return d->bounds;
+}
+
 // ----------------------------------------------------------------------------
 void ScalarFilterModel::setLowerBound(int role, QVariant const& bound)
 {
@@ -53,8 +159,10 @@ void ScalarFilterModel::setLowerBound(int role, QVariant const& bound)
     auto& old = d->bounds[role];
     if (bound != old.first)
     {
-      old.first = bound;
-      this->invalidateVisibility();
+      d->update([&]{
+        old.first = bound;
+        d->compile(role);
+      });
     }
   }
 }
@@ -69,8 +177,10 @@ void ScalarFilterModel::setUpperBound(int role, QVariant const& bound)
     auto& old = d->bounds[role];
     if (bound != old.second)
     {
-      old.second = bound;
-      this->invalidateVisibility();
+      d->update([&]{
+        old.second = bound;
+        d->compile(role);
+      });
     }
   }
 }
@@ -86,9 +196,11 @@ void ScalarFilterModel::setBound(
     auto& old = d->bounds[role];
     if (lower != old.first || upper != old.second)
     {
-      old.first = lower;
-      old.second = upper;
-      this->invalidateVisibility();
+      d->update([&]{
+        old.first = lower;
+        old.second = upper;
+        d->compile(role);
+      });
     }
   }
 }
@@ -101,16 +213,18 @@ void ScalarFilterModel::clearLowerBound(int role)
   auto const& i = d->bounds.find(role);
   if (i != d->bounds.end() && i->first.isValid())
   {
-    if (i->second.isValid())
-    {
-      i->first.clear();
-    }
-    else
-    {
-      d->bounds.erase(i);
-    }
+    d->update([&]{
+      if (i->second.isValid())
+      {
+        i->first.clear();
+      }
+      else
+      {
+        d->bounds.erase(i);
+      }
 
-    this->invalidateVisibility();
+      d->compile(role);
+    });
   }
 }
 
@@ -122,16 +236,18 @@ void ScalarFilterModel::clearUpperBound(int role)
   auto const& i = d->bounds.find(role);
   if (i != d->bounds.end() && i->second.isValid())
   {
-    if (i->first.isValid())
-    {
-      i->second.clear();
-    }
-    else
-    {
-      d->bounds.erase(i);
-    }
+    d->update([&]{
+      if (i->first.isValid())
+      {
+        i->second.clear();
+      }
+      else
+      {
+        d->bounds.erase(i);
+      }
 
-    this->invalidateVisibility();
+      d->compile(role);
+    });
   }
 }
 
@@ -140,9 +256,12 @@ void ScalarFilterModel::clearBound(int role)
 {
   QTE_D();
 
-  if (d->bounds.remove(role))
+  if (d->bounds.contains(role))
   {
-    this->invalidateVisibility();
+    d->update([&]{
+      d->bounds.remove(role);
+      d->compile(role);
+    });
   }
 }
 
@@ -153,11 +272,90 @@ void ScalarFilterModel::clearBounds()
 
   if (!d->bounds.isEmpty())
   {
-    d->bounds.clear();
-    this->invalidateVisibility();
+    d->update([&]{
+      d->bounds.clear();
+      d->predicates.clear();
+      d->visible.clear();
+    });
   }
 }
 
+// ----------------------------------------------------------------------------
+void ScalarFilterModel::setSourceModel(QAbstractItemModel* sourceModel)
+{
+  QTE_D();
+
+  for (auto const& c : d->sourceConnections)
+  {
+    disconnect(c);
+  }
+  d->sourceConnections.clear();
+
+  // Connect to the source model and build the visibility cache before the
+  // base class does its own work, so that the cache is already up to date
+  // whenever the proxy announces a change in the source model
+  d->source = sourceModel;
+  if (sourceModel)
+  {
+    using Model = QAbstractItemModel;
+
+    auto add = [d](QMetaObject::Connection&& c){
+      d->sourceConnections.append(std::move(c));
+    };
+
+    // The data of a top-level row (e.g. a track's start and end times) may
+    // depend on its children, so changes to the children of a top-level row
+    // are treated as a change to that row
+    add(connect(
+      sourceModel, &Model::rowsInserted, this,
+      [d](QModelIndex const& parent, int first, int last){
+        if (!parent.isValid())
+        {
+          d->insertRows(first, last);
+        }
+        else if (!parent.parent().isValid())
+        {
+          d->updateRows(parent.row(), parent.row());
+        }
+      }));
+    add(connect(
+      sourceModel, &Model::rowsRemoved, this,
+      [d](QModelIndex const& parent, int first, int last){
+        if (!parent.isValid())
+        {
+          d->removeRows(first, last);
+        }
+        else if (!parent.parent().isValid())
+        {
+          d->updateRows(parent.row(), parent.row());
+        }
+      }));
+    add(connect(
+      sourceModel, &Model::dataChanged, this,
+      [d](QModelIndex const& topLeft, QModelIndex const& bottomRight,
+          QVector<int> const& roles){
+        auto const& parent = topLeft.parent();
+        if (!parent.isValid())
+        {
+          d->updateRows(topLeft.row(), bottomRight.row(), roles);
+        }
+        else if (!parent.parent().isValid())
+        {
+          d->updateRows(parent.row(), parent.row(), roles);
+        }
+      }));
+    add(connect(sourceModel, &Model::rowsMoved, this,
+                [d]{ d->rebuild(); }));
+    add(connect(sourceModel, &Model::layoutChanged, this,
+                [d]{ d->rebuild(); }));
+    add(connect(sourceModel, &Model::modelReset, this,
+                [d]{ d->rebuild(); }));
+  }
+  d->rebuild();
+
+  this->AbstractProxyModel::setSourceModel(sourceModel);
+}
+
 // ----------------------------------------------------------------------------
 QVariant ScalarFilterModel::data(QModelIndex const& index, int role) const
 {
@@ -165,18 +363,18 @@ QVariant ScalarFilterModel::data(QModelIndex const& index, int role) const
   {
     QTE_D();
 
-    auto* const sm = this->sourceModel();
-    auto const& si = this->mapToSource(index);
-
-    for (auto const& i : d->bounds | kvr::indirect)
+    if (!d->predicates.empty())
     {
-      auto const role = i.key();
-      auto const& sd = sm->data(si, role);
-      if (i->first.isValid() && this->lessThan(sd, i->first, role))
+      auto const& si = this->mapToSource(index);
+      if (si.isValid() && !si.parent().isValid())
       {
-        return false;
+        auto const row = static_cast<size_t>(si.row());
+        if (row < d->visible.size() && !d->visible[row])
+        {
+          return false;
+        }
       }
-      if (i->second.isValid() && this->lessThan(i->second, sd, role))
+      else if (!d->accepts(si))
       {
         return false;
       }
@@ -186,6 +384,365 @@ QVariant ScalarFilterModel::data(QModelIndex const& index, int role) const
   return this->AbstractProxyModel::data(index, role);
 }
 
+// ----------------------------------------------------------------------------
+auto ScalarFilterModelPrivate::kind(int role) -> Kind
+{
+  switch (role)
+  {
+    case StartTimeRole:
+    case EndTimeRole:
+      return Kind::Time;
+
+    case ClassificationScoreRole:
+      return Kind::Real;
+
+    case ClassificationTypeRole:
+      return Kind::Text;
+
+    default:
+      return Kind::Generic;
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ScalarFilterModelPrivate::compile(int role)
+{
+  auto iter = std::find_if(
+    this->predicates.begin(), this->predicates.end(),
+    [role](Predicate const& p){ return p.role == role; });
+
+  auto const& b = this->bounds.find(role);
+  if (b == this->bounds.end())
+  {
+    if (iter != this->predicates.end())
+    {
+      this->predicates.erase(iter);
+      if (this->predicates.empty())
+      {
+        this->visible.clear();
+      }
+      else if (!this->visible.empty())
+      {
+        this->evaluate(0, static_cast<int>(this->visible.size()) - 1);
+      }
+    }
+    return;
+  }
+
+  auto const isNew = (iter == this->predicates.end());
+  if (isNew)
+  {
+    this->predicates.push_back({});
+    iter = this->predicates.end() - 1;
+    iter->role = role;
+    iter->kind = kind(role);
+  }
+
+  auto& p = *iter;
+  p.lower = b->first;
+  p.upper = b->second;
+
+  // Unset bounds are compiled to the extremes of the type, so that tests do
+  // not need to check whether each bound is set
+  constexpr auto inf = std::numeric_limits<double>::infinity();
+  using time_limits = std::numeric_limits<time_us_t>;
+
+  switch (p.kind)
+  {
+    case Kind::Time:
+      p.lowerTime = (p.lower.isValid() ? p.lower.value<time_us_t>()
+                                       : time_limits::lowest());
+      p.upperTime = (p.upper.isValid() ? p.upper.value<time_us_t>()
+                                       : time_limits::max());
+      break;
+
+    case Kind::Real:
+      p.lowerReal = (p.lower.isValid() ? p.lower.toDouble() : -inf);
+      p.upperReal = (p.upper.isValid() ? p.upper.toDouble() : +inf);
+      break;
+
+    case Kind::Text:
+      p.lowerText = p.lower.toString();
+      p.upperText = p.upper.toString();
+      break;
+
+    default:
+      break;
+  }
+
+  if (isNew && this->predicates.size() == 1)
+  {
+    // First active bound; build the cache from scratch
+    this->rebuild();
+  }
+  else if (!this->visible.empty())
+  {
+    auto const last = static_cast<int>(this->visible.size()) - 1;
+    if (isNew)
+    {
+      this->load(p, 0, last);
+    }
+    this->evaluate(0, last);
+  }
+}
+
+// ----------------------------------------------------------------------------
+bool ScalarFilterModelPrivate::accepts(QModelIndex const& sourceIndex) const
+{
+  auto* const sm = this->source;
+  for (auto const& p : this->predicates)
+  {
+    if (!this->accepts(p, (sm ? sm->data(sourceIndex, p.role) : QVariant{})))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+bool ScalarFilterModelPrivate::accepts(
+  Predicate const& p, QVariant const& data) const
+{
+  switch (p.kind)
+  {
+    case Kind::Time:
+    {
+      auto const v = data.value<time_us_t>();
+      return v >= p.lowerTime && v <= p.upperTime;
+    }
+
+    case Kind::Real:
+    {
+      auto const v = data.toDouble();
+      return !(v < p.lowerReal || p.upperReal < v);
+    }
+
+    case Kind::Text:
+      return accepts(p, data.toString());
+
+    default:
+    {
+      QTE_Q();
+      return
+        (!p.lower.isValid() || !q->lessThan(data, p.lower, p.role)) &&
+        (!p.upper.isValid() || !q->lessThan(p.upper, data, p.role));
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+bool ScalarFilterModelPrivate::accepts(Predicate const& p, QString const& text)
+{
+  if (p.lower.isValid() && QString::localeAwareCompare(text, p.lowerText) < 0)
+  {
+    return false;
+  }
+  if (p.upper.isValid() && QString::localeAwareCompare(p.upperText, text) < 0)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+void ScalarFilterModelPrivate::rebuild()
+{
+  if (this->predicates.empty())
+  {
+    this->visible.clear();
+    return;
+  }
+
+  auto const rows = (this->source ? this->source->rowCount() : 0);
+  auto const size = static_cast<size_t>(rows);
+
+  this->visible.assign(size, true);
+  for (auto& p : this->predicates)
+  {
+    p.times.clear();
+    p.reals.clear();
+    p.texts.clear();
+    p.values.clear();
+
+    switch (p.kind)
+    {
+      case Kind::Time: p.times.resize(size); break;
+      case Kind::Real: p.reals.resize(size); break;
+      case Kind::Text: p.texts.resize(size); break;
+      default: p.values.resize(size); break;
+    }
+  }
+
+  if (rows)
+  {
+    this->updateRows(0, rows - 1);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ScalarFilterModelPrivate::insertRows(int first, int last)
+{
+  if (this->predicates.empty())
+  {
+    return;
+  }
+
+  auto const count = static_cast<size_t>(last - first + 1);
+  auto const at = static_cast<size_t>(first);
+
+  this->visible.insert(this->visible.begin() + at, count, true);
+  for (auto& p : this->predicates)
+  {
+    switch (p.kind)
+    {
+      case Kind::Time:
+        p.times.insert(p.times.begin() + at, count, time_us_t{});
+        break;
+      case Kind::Real:
+        p.reals.insert(p.reals.begin() + at, count, 0.0);
+        break;
+      case Kind::Text:
+        p.texts.insert(p.texts.begin() + at, count, QString{});
+        break;
+      default:
+        p.values.insert(p.values.begin() + at, count, QVariant{});
+        break;
+    }
+  }
+
+  this->updateRows(first, last);
+}
+
+// ----------------------------------------------------------------------------
+void ScalarFilterModelPrivate::removeRows(int first, int last)
+{
+  if (this->predicates.empty())
+  {
+    return;
+  }
+
+  auto erase = [first, last](auto& container){
+    container.erase(container.begin() + first, container.begin() + last + 1);
+  };
+
+  erase(this->visible);
+  for (auto& p : this->predicates)
+  {
+    switch (p.kind)
+    {
+      case Kind::Time: erase(p.times); break;
+      case Kind::Real: erase(p.reals); break;
+      case Kind::Text: erase(p.texts); break;
+      default: erase(p.values); break;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ScalarFilterModelPrivate::updateRows(
+  int first, int last, QVector<int> const& roles)
+{
+  if (this->predicates.empty())
+  {
+    return;
+  }
+
+  auto changed = false;
+  for (auto& p : this->predicates)
+  {
+    if (isRoleAffected(roles, p.role))
+    {
+      this->load(p, first, last);
+      changed = true;
+    }
+  }
+
+  if (changed)
+  {
+    this->evaluate(first, last);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ScalarFilterModelPrivate::load(Predicate& p, int first, int last)
+{
+  auto* const sm = this->source;
+  auto const size = this->visible.size();
+
+  switch (p.kind)
+  {
+    case Kind::Time: p.times.resize(size); break;
+    case Kind::Real: p.reals.resize(size); break;
+    case Kind::Text: p.texts.resize(size); break;
+    default: p.values.resize(size); break;
+  }
+
+  for (auto row = first; row <= last; ++row)
+  {
+    auto const& data = sm->data(sm->index(row, 0), p.role);
+    auto const i = static_cast<size_t>(row);
+
+    switch (p.kind)
+    {
+      case Kind::Time: p.times[i] = data.value<time_us_t>(); break;
+      case Kind::Real: p.reals[i] = data.toDouble(); break;
+      case Kind::Text: p.texts[i] = data.toString(); break;
+      default: p.values[i] = data; break;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ScalarFilterModelPrivate::evaluate(int first, int last)
+{
+  auto const begin = static_cast<size_t>(first);
+  auto const end = static_cast<size_t>(last) + 1;
+
+  std::fill(this->visible.begin() + first, this->visible.begin() + end, true);
+
+  // Test each bound over the whole range at once; the time and real tests
+  // are simple comparisons over contiguous arrays
+  auto& v = this->visible;
+  for (auto const& p : this->predicates)
+  {
+    switch (p.kind)
+    {
+      case Kind::Time:
+        for (auto i = begin; i < end; ++i)
+        {
+          auto const t = p.times[i];
+          v[i] = v[i] && t >= p.lowerTime && t <= p.upperTime;
+        }
+        break;
+
+      case Kind::Real:
+        for (auto i = begin; i < end; ++i)
+        {
+          auto const r = p.reals[i];
+          v[i] = v[i] && !(r < p.lowerReal || p.upperReal < r);
+        }
+        break;
+
+      case Kind::Text:
+        for (auto i = begin; i < end; ++i)
+        {
+          v[i] = v[i] && accepts(p, p.texts[i]);
+        }
+        break;
+
+      default:
+        for (auto i = begin; i < end; ++i)
+        {
+          v[i] = v[i] && this->accepts(p, p.values[i]);
+        }
+        break;
+    }
+  }
+}
+
 } // namespace core
 
 } // namespace sealtk
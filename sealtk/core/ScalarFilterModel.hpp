@@ -9,6 +9,9 @@
 
 #include <qtGlobal.h>
 
+#include <QHash>
+#include <QPair>
+
 namespace sealtk
 {
 
@@ -25,6 +28,10 @@ class ScalarFilterModelPrivate;
 ///
 /// Note that, unlike a "normal" filter, this does \em not actually reject
 /// rows, but rather modifies the VisibilityRole data of the underlying model.
+///
+/// The bounds are compiled into typed tests, and the visibility of the source
+/// model's top-level rows is cached and kept up to date as the bounds or the
+/// source data change, so that querying the visibility of such a row is cheap.
 class SEALTK_CORE_EXPORT ScalarFilterModel : public AbstractProxyModel
 {
   Q_OBJECT
@@ -33,8 +40,16 @@ public:
   explicit ScalarFilterModel(QObject* parent = nullptr);
   ~ScalarFilterModel() override;
 
+  void setSourceModel(QAbstractItemModel* sourceModel) override;
+
   QVariant data(QModelIndex const& index, int role) const override;
 
+  /// Get the active bounds.
+  ///
+  /// This returns the lower and upper bound (either of which may be invalid,
+  /// i.e. unset) of each role for which a bound is set.
+  QHash<int, QPair<QVariant, QVariant>> bounds() const;
+
 public slots:
   void setLowerBound(int role, QVariant const& bound);
   void setUpperBound(int role, QVariant const& bound);
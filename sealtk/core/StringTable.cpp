@@ -0,0 +1,86 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/core/StringTable.hpp>
+
+#include <qtStlUtil.h>
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace // anonymous
+{
+
+// ============================================================================
+struct StringTable
+{
+  QReadWriteLock lock;
+  QHash<QString, int> ids;
+  QVector<QString> strings;
+};
+
+// ----------------------------------------------------------------------------
+StringTable& table()
+{
+  static auto* const instance = new StringTable;
+  return *instance;
+}
+
+} // namespace <anonymous>
+
+// ----------------------------------------------------------------------------
+int internString(std::string const& s)
+{
+  return internString(qtString(s));
+}
+
+// ----------------------------------------------------------------------------
+int internString(QString const& s)
+{
+  auto& t = table();
+
+  {
+    QReadLocker locker{&t.lock};
+    auto const i = t.ids.find(s);
+    if (i != t.ids.end())
+    {
+      return i.value();
+    }
+  }
+
+  QWriteLocker locker{&t.lock};
+
+  // Check again, in case another thread added the string while we were
+  // waiting for the write lock
+  auto const i = t.ids.find(s);
+  if (i != t.ids.end())
+  {
+    return i.value();
+  }
+
+  auto const id = t.strings.size();
+  t.strings.append(s);
+  t.ids.insert(s, id);
+  return id;
+}
+
+// ----------------------------------------------------------------------------
+QString internedString(int id)
+{
+  auto& t = table();
+
+  QReadLocker locker{&t.lock};
+  return t.strings.value(id);
+}
+
+} // namespace core
+
+} // namespace sealtk
@@ -0,0 +1,48 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#ifndef sealtk_core_StringTable_hpp
+#define sealtk_core_StringTable_hpp
+
+#include <sealtk/core/Export.h>
+
+#include <QString>
+
+#include <string>
+
+namespace sealtk
+{
+
+namespace core
+{
+
+/// Get the identifier of an interned string.
+///
+/// This function returns the identifier of \p s in the global string table,
+/// adding \p s to the table if it is not already present. Identifiers are
+/// non-negative, are stable for the lifetime of the process, and are equal
+/// if and only if the strings are equal.
+///
+/// This function is thread safe.
+SEALTK_CORE_EXPORT
+int internString(std::string const& s);
+
+/// \copydoc internString(std::string const&)
+SEALTK_CORE_EXPORT
+int internString(QString const& s);
+
+/// Get the value of an interned string.
+///
+/// This function returns the string with the identifier \p id in the global
+/// string table, or a null string if \p id is not a valid identifier.
+///
+/// This function is thread safe.
+SEALTK_CORE_EXPORT
+QString internedString(int id);
+
+} // namespace core
+
+} // namespace sealtk
+
+#endif
@@ -0,0 +1,465 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/core/TrackCache.hpp>
+
+#include <sealtk/core/TrackUtils.hpp>
+
+#include <vital/types/track.h>
+
+#include <vital/range/iota.h>
+#include <vital/range/valid.h>
+
+#include <qtGet.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace kv = kwiver::vital;
+namespace kvr = kwiver::vital::range;
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace // anonymous
+{
+
+constexpr char cacheMagic[8] = {'S', 'E', 'A', 'L', 'T', 'K', 'T', 'C'};
+constexpr quint32 cacheVersion = 1;
+constexpr quint32 cacheByteOrder = 0x01020304;
+
+enum StateFlag : quint32
+{
+  HasDetection = 1 << 0,
+  HasClassification = 1 << 1,
+};
+
+// All records are multiples of eight bytes in size, and tables are written
+// contiguously following the header, so that every record in a mapped file
+// is suitably aligned to be accessed in place
+
+// ============================================================================
+struct Header
+{
+  char magic[8];
+  quint32 version;
+  quint32 byteOrder;
+
+  qint64 sourceSize;
+  qint64 sourceTime; // milliseconds since epoch
+
+  quint64 trackCount;
+  quint64 trackOffset;
+  quint64 stateCount;
+  quint64 stateOffset;
+  quint64 classCount;
+  quint64 classOffset;
+  quint64 noteCount;
+  quint64 noteOffset;
+
+  // The string table consists of (stringCount + 1) offsets, relative to the
+  // end of the offsets, followed by the UTF-8 string data
+  quint64 stringCount;
+  quint64 stringOffset;
+  quint64 stringDataSize;
+};
+
+// ============================================================================
+struct TrackRecord
+{
+  qint64 id;
+  quint64 firstState;
+  quint64 stateCount;
+};
+
+// ============================================================================
+struct StateRecord
+{
+  qint64 frame;
+  qint64 time;
+  double box[4]; // min x, min y, max x, max y
+  double confidence;
+  quint64 firstClass;
+  quint64 firstNote;
+  quint32 classCount;
+  quint32 noteCount;
+  quint32 flags;
+  quint32 reserved;
+};
+
+// ============================================================================
+struct ClassRecord
+{
+  quint64 name;
+  double score;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "bad Header alignment");
+static_assert(sizeof(TrackRecord) % 8 == 0, "bad TrackRecord alignment");
+static_assert(sizeof(StateRecord) % 8 == 0, "bad StateRecord alignment");
+static_assert(sizeof(ClassRecord) % 8 == 0, "bad ClassRecord alignment");
+
+// ============================================================================
+class StringTableBuilder
+{
+public:
+  quint64 insert(std::string const& s);
+
+  std::vector<quint64> offsets{0};
+  std::string data;
+
+private:
+  QHash<QByteArray, quint64> ids;
+};
+
+// ----------------------------------------------------------------------------
+quint64 StringTableBuilder::insert(std::string const& s)
+{
+  auto const size = static_cast<int>(s.size());
+  auto const key = QByteArray::fromRawData(s.data(), size);
+  if (auto const* const id = qtGet(this->ids, key))
+  {
+    return *id;
+  }
+
+  auto const id = static_cast<quint64>(this->offsets.size() - 1);
+  this->data.append(s);
+  this->offsets.push_back(this->data.size());
+
+  // Store a deep copy of the key, as the raw data will not outlive the call
+  this->ids.insert(QByteArray{s.data(), size}, id);
+
+  return id;
+}
+
+// ----------------------------------------------------------------------------
+template <typename T>
+bool writeTable(QSaveFile& file, std::vector<T> const& table)
+{
+  auto const bytes = static_cast<qint64>(sizeof(T) * table.size());
+  return bytes == 0 ||
+         file.write(reinterpret_cast<char const*>(table.data()), bytes) ==
+           bytes;
+}
+
+// ----------------------------------------------------------------------------
+template <typename T>
+T const* table(uchar const* base, qint64 fileSize,
+               quint64 offset, quint64 count)
+{
+  auto const size = static_cast<quint64>(fileSize);
+  if (offset % alignof(T) || offset > size ||
+      count > (size - offset) / sizeof(T))
+  {
+    return nullptr;
+  }
+
+  return reinterpret_cast<T const*>(base + offset);
+}
+
+} // namespace <anonymous>
+
+// ----------------------------------------------------------------------------
+QString trackCachePath(QString const& sourcePath, QString const& readerConfig)
+{
+  if (readerConfig.isEmpty())
+  {
+    return sourcePath + QStringLiteral(".sealtk-cache");
+  }
+
+  auto const& digest = QCryptographicHash::hash(
+    readerConfig.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+  return QStringLiteral("%1.%2.sealtk-cache")
+    .arg(sourcePath, QString::fromLatin1(digest));
+}
+
+// ----------------------------------------------------------------------------
+bool writeTrackCache(QString const& path,
+                     kv::object_track_set_sptr const& tracks,
+                     QFileInfo const& source)
+{
+  auto header = Header{};
+  std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+  header.version = cacheVersion;
+  header.byteOrder = cacheByteOrder;
+  header.sourceSize = -1;
+  header.sourceTime = -1;
+
+  if (!source.filePath().isEmpty())
+  {
+    header.sourceSize = source.size();
+    header.sourceTime = source.lastModified().toMSecsSinceEpoch();
+  }
+
+  // Build tables
+  std::vector<TrackRecord> trackRecords;
+  std::vector<StateRecord> stateRecords;
+  std::vector<ClassRecord> classRecords;
+  std::vector<quint64> noteRecords;
+  StringTableBuilder strings;
+
+  if (tracks)
+  {
+    for (auto const& track : tracks->tracks() | kvr::valid)
+    {
+      auto trackRecord = TrackRecord{track->id(), stateRecords.size(), 0};
+
+      for (auto const& state : *track | kv::as_object_track | kvr::valid)
+      {
+        auto stateRecord = StateRecord{};
+        stateRecord.frame = state->frame();
+        stateRecord.time = state->time();
+        stateRecord.firstClass = classRecords.size();
+        stateRecord.firstNote = noteRecords.size();
+
+        if (auto const& detection = state->detection())
+        {
+          auto const& bb = detection->bounding_box();
+          stateRecord.box[0] = bb.min_x();
+          stateRecord.box[1] = bb.min_y();
+          stateRecord.box[2] = bb.max_x();
+          stateRecord.box[3] = bb.max_y();
+          stateRecord.confidence = detection->confidence();
+          stateRecord.flags |= HasDetection;
+
+          if (auto const& type = detection->type())
+          {
+            stateRecord.flags |= HasClassification;
+            for (auto const& c : *type)
+            {
+              classRecords.push_back({strings.insert(*c.first), c.second});
+            }
+          }
+
+          for (auto const& note : detection->notes())
+          {
+            noteRecords.push_back(strings.insert(note));
+          }
+        }
+
+        stateRecord.classCount = static_cast<quint32>(
+          classRecords.size() - stateRecord.firstClass);
+        stateRecord.noteCount = static_cast<quint32>(
+          noteRecords.size() - stateRecord.firstNote);
+
+        stateRecords.push_back(stateRecord);
+        ++trackRecord.stateCount;
+      }
+
+      trackRecords.push_back(trackRecord);
+    }
+  }
+
+  // Compute table locations
+  auto offset = static_cast<quint64>(sizeof(Header));
+  auto place = [&offset](quint64& tableOffset, quint64& tableCount,
+                         size_t count, size_t recordSize){
+    tableOffset = offset;
+    tableCount = count;
+    offset += count * recordSize;
+  };
+
+  place(header.trackOffset, header.trackCount,
+        trackRecords.size(), sizeof(TrackRecord));
+  place(header.stateOffset, header.stateCount,
+        stateRecords.size(), sizeof(StateRecord));
+  place(header.classOffset, header.classCount,
+        classRecords.size(), sizeof(ClassRecord));
+  place(header.noteOffset, header.noteCount,
+        noteRecords.size(), sizeof(quint64));
+
+  header.stringOffset = offset;
+  header.stringCount = strings.offsets.size() - 1;
+  header.stringDataSize = strings.data.size();
+
+  // Write file
+  QSaveFile file{path};
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+
+  auto const* const headerData = reinterpret_cast<char const*>(&header);
+  if (file.write(headerData, sizeof(header)) != sizeof(header) ||
+      !writeTable(file, trackRecords) ||
+      !writeTable(file, stateRecords) ||
+      !writeTable(file, classRecords) ||
+      !writeTable(file, noteRecords) ||
+      !writeTable(file, strings.offsets) ||
+      file.write(strings.data.data(),
+                 static_cast<qint64>(strings.data.size())) !=
+        static_cast<qint64>(strings.data.size()))
+  {
+    file.cancelWriting();
+    return false;
+  }
+
+  return file.commit();
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr readTrackCache(
+  QString const& path, QFileInfo const& source)
+{
+  QFile file{path};
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return nullptr;
+  }
+
+  // Read and validate the header
+  auto header = Header{};
+  auto* const headerData = reinterpret_cast<char*>(&header);
+  if (file.read(headerData, sizeof(header)) != sizeof(header) ||
+      std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+      header.version != cacheVersion || header.byteOrder != cacheByteOrder)
+  {
+    return nullptr;
+  }
+
+  if (!source.filePath().isEmpty())
+  {
+    if (header.sourceSize != source.size() ||
+        header.sourceTime != source.lastModified().toMSecsSinceEpoch())
+    {
+      return nullptr;
+    }
+  }
+
+  // Map the file (the mapping is released when the file is closed)
+  auto const fileSize = file.size();
+  auto const* const base = file.map(0, fileSize);
+  if (!base)
+  {
+    return nullptr;
+  }
+
+  if (header.stringCount >= static_cast<quint64>(fileSize))
+  {
+    return nullptr;
+  }
+
+  auto const* const trackRecords = table<TrackRecord>(
+    base, fileSize, header.trackOffset, header.trackCount);
+  auto const* const stateRecords = table<StateRecord>(
+    base, fileSize, header.stateOffset, header.stateCount);
+  auto const* const classRecords = table<ClassRecord>(
+    base, fileSize, header.classOffset, header.classCount);
+  auto const* const noteRecords = table<quint64>(
+    base, fileSize, header.noteOffset, header.noteCount);
+  auto const* const stringOffsets = table<quint64>(
+    base, fileSize, header.stringOffset, header.stringCount + 1);
+
+  if (!trackRecords || !stateRecords || !classRecords || !noteRecords ||
+      !stringOffsets)
+  {
+    return nullptr;
+  }
+
+  auto const stringDataOffset =
+    header.stringOffset + ((header.stringCount + 1) * sizeof(quint64));
+  auto const* const stringData = table<char>(
+    base, fileSize, stringDataOffset, header.stringDataSize);
+  if (!stringData)
+  {
+    return nullptr;
+  }
+
+  // Extract strings
+  std::vector<std::string> strings;
+  strings.reserve(header.stringCount);
+  for (auto const i : kvr::iota(header.stringCount))
+  {
+    auto const first = stringOffsets[i];
+    auto const last = stringOffsets[i + 1];
+    if (first > last || last > header.stringDataSize)
+    {
+      return nullptr;
+    }
+    strings.emplace_back(stringData + first, last - first);
+  }
+
+  // Build tracks
+  std::vector<kv::track_sptr> tracks;
+  tracks.reserve(header.trackCount);
+
+  for (auto const i : kvr::iota(header.trackCount))
+  {
+    auto const& trackRecord = trackRecords[i];
+    if (trackRecord.firstState > header.stateCount ||
+        trackRecord.stateCount > header.stateCount - trackRecord.firstState)
+    {
+      return nullptr;
+    }
+
+    auto track = kv::track::create();
+    track->set_id(trackRecord.id);
+
+    for (auto const j : kvr::iota(trackRecord.stateCount))
+    {
+      auto const& s = stateRecords[trackRecord.firstState + j];
+      if (s.firstClass > header.classCount ||
+          s.classCount > header.classCount - s.firstClass ||
+          s.firstNote > header.noteCount ||
+          s.noteCount > header.noteCount - s.firstNote)
+      {
+        return nullptr;
+      }
+
+      kv::detected_object_sptr detection;
+      if (s.flags & HasDetection)
+      {
+        kv::detected_object_type_sptr type;
+        if (s.flags & HasClassification)
+        {
+          type = std::make_shared<kv::detected_object_type>();
+          for (auto const k : kvr::iota(s.classCount))
+          {
+            auto const& c = classRecords[s.firstClass + k];
+            if (c.name >= strings.size())
+            {
+              return nullptr;
+            }
+            type->set_score(strings[c.name], c.score);
+          }
+        }
+
+        auto const box = kv::bounding_box_d{s.box[0], s.box[1],
+                                            s.box[2], s.box[3]};
+        detection =
+          std::make_shared<kv::detected_object>(box, s.confidence, type);
+
+        for (auto const k : kvr::iota(s.noteCount))
+        {
+          auto const note = noteRecords[s.firstNote + k];
+          if (note >= strings.size())
+          {
+            return nullptr;
+          }
+          detection->add_note(strings[note]);
+        }
+      }
+
+      track->append(createTrackState(s.frame, s.time, std::move(detection)));
+    }
+
+    tracks.push_back(std::move(track));
+  }
+
+  return std::make_shared<kv::object_track_set>(std::move(tracks));
+}
+
+} // namespace core
+
+} // namespace sealtk
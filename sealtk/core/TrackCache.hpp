@@ -0,0 +1,70 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#ifndef sealtk_core_TrackCache_hpp
+#define sealtk_core_TrackCache_hpp
+
+#include <sealtk/core/Export.h>
+
+#include <vital/types/object_track_set.h>
+
+#include <QFileInfo>
+#include <QString>
+
+namespace sealtk
+{
+
+namespace core
+{
+
+/// Get the path of the track cache file for a track file.
+///
+/// This function returns the path at which a track cache for the track file
+/// \p sourcePath is stored, which is next to the track file. If
+/// \p readerConfig is not empty, the name of the cache file also includes a
+/// digest of it, so that tracks read from the same file using different
+/// reader configurations are cached separately.
+SEALTK_CORE_EXPORT
+QString trackCachePath(QString const& sourcePath,
+                       QString const& readerConfig = {});
+
+/// Write tracks to a binary track cache file.
+///
+/// This function writes \p tracks to \p path in a versioned binary format,
+/// consisting of a table of track records, a table of fixed-size state
+/// records, tables of classifier scores and notes, and a table of the
+/// (unique) strings used by the classifiers and notes. Only the bounding box,
+/// confidence, classification and notes of each detection are preserved.
+///
+/// If \p source is given, its size and modification time are recorded, so
+/// that the cache can be recognized as out of date if the source changes.
+/// The file is replaced atomically; if writing fails, any existing file at
+/// \p path is left unchanged.
+///
+/// \return \c true if the file was written successfully, otherwise \c false.
+SEALTK_CORE_EXPORT
+bool writeTrackCache(QString const& path,
+                     kwiver::vital::object_track_set_sptr const& tracks,
+                     QFileInfo const& source = {});
+
+/// Read tracks from a binary track cache file.
+///
+/// This function reads tracks from \p path, which must have been written by
+/// #writeTrackCache. The file is memory mapped, and tracks are constructed
+/// directly from the mapped records, without parsing any text.
+///
+/// If \p source is given, the cache is only accepted if it was written from
+/// a file of the same size and modification time as \p source.
+///
+/// \return The tracks which were read, or \c nullptr if \p path is not a
+///         valid track cache, is an unsupported version, or is out of date.
+SEALTK_CORE_EXPORT
+kwiver::vital::object_track_set_sptr readTrackCache(
+  QString const& path, QFileInfo const& source = {});
+
+} // namespace core
+
+} // namespace sealtk
+
+#endif
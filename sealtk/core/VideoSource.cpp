@@ -13,7 +13,9 @@
 #include <QPointer>
 #include <QThread>
 
+#include <algorithm>
 #include <unordered_map>
+#include <vector>
 
 namespace kv = kwiver::vital;
 
@@ -188,8 +190,26 @@ void VideoSourcePrivate::enqueueFrameRequest(VideoRequest&& request)
 // ----------------------------------------------------------------------------
 void VideoSourcePrivate::dispatchFrameRequests()
 {
+  // Process the requests in time order; several requestors may have requests
+  // outstanding at once (e.g. when frames are requested ahead of time), and
+  // a provider which decodes a video file can generally move forward through
+  // the video far more cheaply than it can seek backward
+  using Request = decltype(this->requests)::value_type;
+  auto orderedRequests = std::vector<Request*>{};
+  orderedRequests.reserve(this->requests.size());
   for (auto& request : this->requests)
   {
+    orderedRequests.push_back(&request);
+  }
+
+  std::sort(orderedRequests.begin(), orderedRequests.end(),
+            [](Request const* a, Request const* b){
+              return a->second.time < b->second.time;
+            });
+
+  for (auto* const r : orderedRequests)
+  {
+    auto& request = *r;
     Q_ASSERT(request.first == request.second.requestor.get());
     Q_ASSERT(this->lastFrameProvided.count(request.first)); // TODO(C++20)
 
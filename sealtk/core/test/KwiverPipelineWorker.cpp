@@ -22,10 +22,14 @@
 #include <qtGet.h>
 #include <qtStlUtil.h>
 
+#include <QElapsedTimer>
 #include <QImage>
+#include <QJsonArray>
 
 #include <QtTest>
 
+#include <limits>
+
 namespace ka = kwiver::adapter;
 namespace kv = kwiver::vital;
 namespace kvr = kwiver::vital::range;
@@ -63,8 +67,12 @@ void TestPipelineWorker::processOutput(ka::adapter_data_set_t const& output)
 
   if (output)
   {
+    QElapsedTimer timer;
+    timer.start();
+
     auto newNames = QHash<int, QString>{};
     auto newImages = QHash<int, QImage>{};
+    auto time = std::numeric_limits<kv::timestamp::time_t>::min();
 
     for (auto const& datum : *output)
     {
@@ -75,6 +83,12 @@ void TestPipelineWorker::processOutput(ka::adapter_data_set_t const& output)
         continue;
       }
 
+      if (portName == QStringLiteral("timestamp"))
+      {
+        time = datum.second->get_datum<kv::timestamp>().get_time_usec();
+        continue;
+      }
+
       auto const& p = portRegExp.match(portName);
       if (p.isValid())
       {
@@ -97,6 +111,8 @@ void TestPipelineWorker::processOutput(ka::adapter_data_set_t const& output)
 
     this->outputNames.append(newNames);
     this->outputImages.append(newImages);
+
+    this->recordOutput(time, timer.nsecsElapsed());
   }
 }
 
@@ -110,6 +126,9 @@ private slots:
   void cleanupTestCase();
   void pipeline();
   void pipeline_data();
+  void timeRanges();
+  void timeRanges_data();
+  void metrics();
 
 private:
   SourceVector videoSources;
@@ -156,8 +175,10 @@ void TestKwiverPipelineWorker::pipeline()
   QFETCH(QVector<int>, sourceIndices);
   QFETCH(QVector<QStringList>, expectedFrames);
   QFETCH(bool, testProgress);
+  QFETCH(int, lookAhead);
 
   TestPipelineWorker worker;
+  worker.setLookAhead(lookAhead);
   for (auto const si : sourceIndices)
   {
     if (si >= 0)
@@ -240,17 +261,23 @@ void TestKwiverPipelineWorker::pipeline_data()
   QTest::addColumn<bool>("testProgress");
   QTest::addColumn<QVector<int>>("sourceIndices");
   QTest::addColumn<QVector<QStringList>>("expectedFrames");
+  QTest::addColumn<int>("lookAhead");
+
+  auto const& matchingFrames = QVector<QStringList>{
+    {"1000.png", "1000.png", QString{}},
+    {QString{},  "2000.png", "2000.png"},
+    {"3000.png", QString{},  "3000.png"},
+    {"4000.png", "4000.png", "4000.png"},
+    {QString{},  QString{},  "5000.png"},
+  };
 
   QTest::newRow("matching sources")
     << SEALTK_TEST_DATA_PATH("KwiverPipelineWorker/matching.pipe")
-    << true << QVector<int>{0, 1, 2}
-    << QVector<QStringList>{
-         {"1000.png", "1000.png", QString{}},
-         {QString{},  "2000.png", "2000.png"},
-         {"3000.png", QString{},  "3000.png"},
-         {"4000.png", "4000.png", "4000.png"},
-         {QString{},  QString{},  "5000.png"},
-       };
+    << true << QVector<int>{0, 1, 2} << matchingFrames << 4;
+
+  QTest::newRow("matching sources (no look-ahead)")
+    << SEALTK_TEST_DATA_PATH("KwiverPipelineWorker/matching.pipe")
+    << true << QVector<int>{0, 1, 2} << matchingFrames << 1;
 
   QTest::newRow("missing source")
     << SEALTK_TEST_DATA_PATH("KwiverPipelineWorker/missing.pipe")
@@ -261,7 +288,8 @@ void TestKwiverPipelineWorker::pipeline_data()
          {"3000.png", QString{}, "3000.png"},
          {"4000.png", QString{}, "4000.png"},
          {QString{},  QString{}, "5000.png"},
-       };
+       }
+    << 4;
 
   QTest::newRow("excess sources")
     << SEALTK_TEST_DATA_PATH("KwiverPipelineWorker/excess.pipe")
@@ -270,7 +298,164 @@ void TestKwiverPipelineWorker::pipeline_data()
          {"1000.png"},
          {"2000.png"},
          {"4000.png"},
-       };
+       }
+    << 4;
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverPipelineWorker::timeRanges()
+{
+  QFETCH(int, count);
+  QFETCH(int, expectedRanges);
+
+  auto const& pipeline =
+    SEALTK_TEST_DATA_PATH("KwiverPipelineWorker/matching.pipe");
+
+  auto const& expectedNames = QVector<QStringList>{
+    {"1000.png", "1000.png", QString{}},
+    {QString{},  "2000.png", "2000.png"},
+    {"3000.png", QString{},  "3000.png"},
+    {"4000.png", "4000.png", "4000.png"},
+    {QString{},  QString{},  "5000.png"},
+  };
+
+  auto addSources = [this](KwiverPipelineWorker& worker){
+    for (auto const& source : this->videoSources)
+    {
+      worker.addVideoSource(source.get());
+    }
+  };
+
+  TestPipelineWorker splitter;
+  addSources(splitter);
+
+  auto const& ranges = splitter.splitTimeline(count);
+  QCOMPARE(ranges.count(), expectedRanges);
+
+  // Run each range separately; together, they should produce the same output
+  // as running the whole timeline at once
+  auto actualNames = QVector<QStringList>{};
+  auto totalFrames = int{0};
+  for (auto const& range : ranges)
+  {
+    QVERIFY(range.first <= range.second);
+
+    TestPipelineWorker worker;
+    addSources(worker);
+    worker.setTimeRange(range.first, range.second);
+
+    auto progressMax = int{-1};
+    connect(&worker, &KwiverPipelineWorker::progressRangeChanged,
+            this, [&progressMax](int, int max){ progressMax = max; });
+
+    QVERIFY(worker.initialize(pipeline));
+    worker.execute();
+
+    QVERIFY(!worker.outputNames.isEmpty());
+    for (auto const& names : worker.outputNames)
+    {
+      auto frameNames = QStringList{};
+      for (auto const j : kvr::iota(3))
+      {
+        auto const& name = names.value(j);
+        frameNames.append(name.isEmpty() ? name : QFileInfo{name}.fileName());
+      }
+      actualNames.append(frameNames);
+    }
+
+    totalFrames += progressMax;
+  }
+
+  QCOMPARE(actualNames, expectedNames);
+  QCOMPARE(totalFrames, 10);
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverPipelineWorker::timeRanges_data()
+{
+  QTest::addColumn<int>("count");
+  QTest::addColumn<int>("expectedRanges");
+
+  QTest::newRow("one") << 1 << 1;
+  QTest::newRow("two") << 2 << 2;
+  QTest::newRow("three") << 3 << 3;
+  QTest::newRow("excess") << 8 << 5;
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverPipelineWorker::metrics()
+{
+  TestPipelineWorker worker;
+  for (auto const& source : this->videoSources)
+  {
+    worker.addVideoSource(source.get());
+  }
+
+  QVERIFY(worker.initialize(
+    SEALTK_TEST_DATA_PATH("KwiverPipelineWorker/matching.pipe")));
+  worker.execute();
+
+  auto const& metrics = worker.metrics();
+  QCOMPARE(metrics.framesReceived, 10);
+  QCOMPARE(metrics.stepsSent, 5);
+  QCOMPARE(metrics.stepsReused, 0);
+  QCOMPARE(metrics.outputsReceived, 5);
+  QVERIFY(metrics.elapsed > 0);
+  QVERIFY(metrics.framesPerSecond() > 0.0);
+
+  QCOMPARE(metrics.frameLatency.count(), 3);
+  QCOMPARE(metrics.frameLatency[0].count, 3);
+  QCOMPARE(metrics.frameLatency[1].count, 3);
+  QCOMPARE(metrics.frameLatency[2].count, 4);
+  QCOMPARE(metrics.inputWait.count, 5);
+  QCOMPARE(metrics.sendTime.count, 5);
+  QCOMPARE(metrics.outputLatency.count, 5);
+  QCOMPARE(metrics.outputTime.count, 5);
+
+  for (auto const& s : {metrics.inputWait, metrics.sendTime,
+                        metrics.outputLatency, metrics.outputTime})
+  {
+    QVERIFY(s.total >= 0);
+    QVERIFY(s.maximum <= s.total);
+  }
+
+  // Test machine-readable forms
+  auto const& json = metrics.toJson();
+  QCOMPARE(json.value("framesReceived").toInt(), 10);
+  QCOMPARE(json.value("frameLatency").toArray().count(), 3);
+
+  auto const& csv = metrics.toCsv().split('\n', QString::SkipEmptyParts);
+  QCOMPARE(csv.count(), 8);
+  QCOMPARE(csv.first(),
+           QStringLiteral("stage,source,count,totalMs,meanMs,maximumMs"));
+  QVERIFY(csv[3].startsWith(QStringLiteral("frameLatency,2,4,")));
+
+  // Test combining metrics of concurrent executions
+  auto combined = metrics;
+  combined.merge(metrics);
+  QCOMPARE(combined.elapsed, metrics.elapsed);
+  QCOMPARE(combined.framesReceived, 20);
+  QCOMPARE(combined.stepsSent, 10);
+  QCOMPARE(combined.frameLatency[2].count, 8);
+  QCOMPARE(combined.frameLatency[2].maximum, metrics.frameLatency[2].maximum);
+  QCOMPARE(combined.outputTime.total, 2 * metrics.outputTime.total);
+
+  // Test that output which cannot be matched to its input (here, because the
+  // pipeline does not pass the time stamps through) is not used to measure
+  // latency
+  TestPipelineWorker unmatchedWorker;
+  unmatchedWorker.addVideoSource(this->videoSources[0].get());
+  unmatchedWorker.addVideoSource(nullptr);
+  unmatchedWorker.addVideoSource(this->videoSources[2].get());
+
+  QVERIFY(unmatchedWorker.initialize(
+    SEALTK_TEST_DATA_PATH("KwiverPipelineWorker/missing.pipe")));
+  unmatchedWorker.execute();
+
+  auto const& unmatchedMetrics = unmatchedWorker.metrics();
+  QCOMPARE(unmatchedMetrics.outputsReceived, 5);
+  QCOMPARE(unmatchedMetrics.outputTime.count, 5);
+  QCOMPARE(unmatchedMetrics.outputLatency.count, 0);
 }
 
 } // namespace test
@@ -118,6 +118,13 @@ private slots:
   void data();
   void mergeTracks();
   void updateTrack();
+  void activeTracks();
+  void trackSet();
+  void stateIndex();
+  void mergeTrackStates();
+  void updateLongTrack();
+  void removeTracks();
+  void undo();
 };
 
 // ----------------------------------------------------------------------------
@@ -305,6 +312,416 @@ void TestKwiverTrackModel::updateTrack()
   counter.reset();
 }
 
+// ----------------------------------------------------------------------------
+void TestKwiverTrackModel::activeTracks()
+{
+  KwiverTrackModel model;
+  model.setTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(1, data::track1),
+        createTrack(2, data::track2),
+        createTrack(3, data::track3),
+        createTrack(4, data::track4),
+        createTrack(5, data::track5, 10),
+      }));
+  QCOMPARE(model.rowCount(), 5);
+
+  using Result = KwiverTrackModel::MergeTracksResult;
+  using Rows = QVector<int>;
+
+  // Test queries against the initial index
+  QCOMPARE(model.activeTracks(50), Rows{});
+  QCOMPARE(model.activeTracks(100), Rows{0});
+  QCOMPARE(model.activeTracks(300), Rows{1});
+  QCOMPARE(model.activeTracks(350), Rows{1});
+  QCOMPARE(model.activeTracks(400), Rows{1});
+  QCOMPARE(model.activeTracks(500), Rows{});
+  QCOMPARE(model.activeTracks(1200), Rows{4});
+  QCOMPARE(model.activeTracks(2100), Rows{3});
+  QCOMPARE(model.activeTracks(3000), Rows{});
+
+  // Test queries including tracks added after the index was built
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{createTrack(6, data::track4)}));
+
+  QCOMPARE(model.activeTracks(1900), (Rows{3, 5}));
+  QCOMPARE(model.activeTracks(1200), Rows{4});
+
+  // Test queries after a track's lifetime has changed
+  auto const state = TrackState{{0, 0, 10, 10}, {{"Dab", 0.2}}};
+  model.updateTrack(model.index(0, 0), createState(30, 2500, state));
+
+  QCOMPARE(model.activeTracks(1900), (Rows{0, 3, 5}));
+  QCOMPARE(model.activeTracks(2500), Rows{0});
+  QCOMPARE(model.activeTracks(50), Rows{});
+
+  // Test queries after states have been merged into an existing track
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(3, TimeMap<TrackState>{{3000, state}}, 4)}));
+
+  QCOMPARE(model.activeTracks(2500), (Rows{0, 2}));
+  QCOMPARE(model.activeTracks(700), Rows{2});
+
+  // Test queries after tracks have been merged
+  QCOMPARE(model.mergeTracks({4, 5}), Result::Success);
+  QCOMPARE(model.rowCount(), 5);
+
+  QCOMPARE(model.activeTracks(1200), Rows{3});
+  QCOMPARE(model.activeTracks(1900), (Rows{3, 4}));
+  QCOMPARE(model.activeTracks(2500), (Rows{0, 2}));
+
+  // Test queries after tracks have been removed
+  model.removeTracks({2});
+  QCOMPARE(model.rowCount(), 4);
+
+  QCOMPARE(model.activeTracks(350), Rows{});
+  QCOMPARE(model.activeTracks(1200), Rows{2});
+  QCOMPARE(model.activeTracks(1900), (Rows{2, 3}));
+  QCOMPARE(model.activeTracks(2500), (Rows{0, 1}));
+
+  model.removeTracks({1, 4});
+  QCOMPARE(model.rowCount(), 2);
+
+  QCOMPARE(model.activeTracks(100), Rows{});
+  QCOMPARE(model.activeTracks(1900), Rows{1});
+  QCOMPARE(model.activeTracks(2500), Rows{0});
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackModel::trackSet()
+{
+  KwiverTrackModel model;
+  model.setTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(1, data::track1),
+        createTrack(2, data::track2),
+        createTrack(4, data::track4),
+      }));
+  QCOMPARE(model.rowCount(), 3);
+
+  // Test that tracks survive conversion to and from a KWIVER track set
+  auto const& trackSet = model.trackSet();
+  QVERIFY(trackSet);
+  QCOMPARE(trackSet->size(), size_t{3});
+
+  KwiverTrackModel copy;
+  copy.setTracks(trackSet);
+  QCOMPARE(copy.rowCount(), 3);
+
+  testTrackData(copy, 1, data::track1);
+  testTrackData(copy, 2, data::track2);
+  testTrackData(copy, 4, data::track4);
+
+  // Test that modifying the model does not affect the exported tracks
+  auto const& index = model.index(0, 0);
+  auto const classification = QVariantHash{{"Eel", 0.9}};
+  QVERIFY(model.setData(index, classification, ClassificationRole));
+  QCOMPARE(model.data(index, ClassificationTypeRole).toString(),
+           QStringLiteral("Eel"));
+
+  // Test that roles which cannot be edited are rejected
+  QVERIFY(!model.setData(index, 0.5, ClassificationScoreRole));
+  QCOMPARE(model.data(index, ClassificationScoreRole).toDouble(), 0.9);
+
+  testTrackData(copy, 1, data::track1);
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackModel::stateIndex()
+{
+  KwiverTrackModel model;
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{createTrack(2, data::track2, 2)}));
+
+  auto const& parent = model.index(0, 0);
+
+  QCOMPARE(model.stateIndex(parent, 3), model.index(0, 0, parent));
+  QCOMPARE(model.stateIndex(parent, 4), model.index(1, 0, parent));
+  QVERIFY(!model.stateIndex(parent, 2).isValid());
+  QVERIFY(!model.stateIndex(parent, 5).isValid());
+
+  QCOMPARE(model.stateIndexAtTime(parent, 300), model.index(0, 0, parent));
+  QCOMPARE(model.stateIndexAtTime(parent, 400), model.index(1, 0, parent));
+  QVERIFY(!model.stateIndexAtTime(parent, 350).isValid());
+  QVERIFY(!model.stateIndexAtTime(parent, 500).isValid());
+
+  QVERIFY(!model.stateIndex({}, 3).isValid());
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackModel::mergeTrackStates()
+{
+  KwiverTrackModel model;
+  auto expected = data::track2;
+
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{createTrack(2, expected, 2)}));
+
+  // Set up signal tested
+  ModelSignalCounter counter{&model};
+
+  // Merge states before, between and after existing states, and one state
+  // that replaces an existing state
+  auto const frontState = TrackState{{0, 0, 10, 10}, {{"Dab", 0.2}}};
+  auto const alterState = TrackState{{410, 150, 25, 35}, {{"Gar", 0.7}}};
+  auto const backState1 = TrackState{{160, 190, 50, 70}, {{"Cod", 0.7}}};
+  auto const backState2 = TrackState{{170, 200, 50, 70}, {{"Cod", 0.8}}};
+
+  auto const track = kv::track::create();
+  track->set_id(2);
+  track->append(createState(1, 100, frontState));
+  track->append(createState(4, 400, alterState));
+  track->append(createState(6, 600, backState1));
+  track->append(createState(7, 700, backState2));
+
+  model.mergeTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{track}));
+
+  expected.insert(100, frontState);
+  expected.insert(400, alterState);
+  expected.insert(600, backState1);
+  expected.insert(700, backState2);
+
+  QCOMPARE(model.rowCount(), 1);
+  testTrackData(model, 2, expected);
+
+  // Check that insertions were batched
+  QVERIFY(counter.count() >= 4);
+  QCOMPARE(counter[0].type, RowsAboutToBeInserted);
+  QCOMPARE(counter[0].first, 0);
+  QCOMPARE(counter[0].last, 0);
+  QCOMPARE(counter[1].type, RowsInserted);
+  QCOMPARE(counter[2].type, RowsAboutToBeInserted);
+  QCOMPARE(counter[2].first, 3);
+  QCOMPARE(counter[2].last, 4);
+  QCOMPARE(counter[3].type, RowsInserted);
+  counter.reset();
+
+  // Check that merging unchanged states does nothing
+  model.mergeTracks(model.trackSet());
+  QCOMPARE(counter.count(), 0);
+  testTrackData(model, 2, expected);
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackModel::updateLongTrack()
+{
+  static constexpr auto stateCount = kv::frame_id_t{50000};
+  auto const state = TrackState{{0, 0, 10, 10}, {{"Dab", 0.2}}};
+
+  // Create a long track, leaving a gap in every other frame
+  auto const track = kv::track::create();
+  track->set_id(1);
+  for (auto frame = kv::frame_id_t{0}; frame < 2 * stateCount; frame += 2)
+  {
+    track->append(createState(frame, frame * 100, state));
+  }
+
+  KwiverTrackModel model;
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{track}));
+
+  auto const& parent = model.index(0, 0);
+  QCOMPARE(model.rowCount(parent), static_cast<int>(stateCount));
+
+  // Replace, look up, and insert states in the middle of the track
+  auto frame = stateCount - 1;
+  QBENCHMARK
+  {
+    auto const time = stateCount * 100;
+    model.updateTrack(parent, createState(stateCount, time, state));
+    QVERIFY(model.stateIndex(parent, stateCount).isValid());
+
+    if (frame > 0)
+    {
+      model.updateTrack(parent, createState(frame, frame * 100, state));
+      frame -= 2;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackModel::removeTracks()
+{
+  KwiverTrackModel model;
+  model.setTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(1, data::track1),
+        createTrack(2, data::track2),
+        createTrack(3, data::track3),
+        createTrack(4, data::track4),
+        createTrack(5, data::track5),
+      }));
+  QCOMPARE(model.rowCount(), 5);
+
+  QPersistentModelIndex const track4{model.index(3, 0)};
+  QPersistentModelIndex const track4State{
+    model.index(2, 0, model.index(3, 0))};
+
+  // Test removal of non-contiguous rows
+  model.removeTracks({1, 3, 7});
+  QCOMPARE(model.rowCount(), 3);
+
+  testTrackData(model, 2, data::track2);
+  testTrackData(model, 4, data::track4);
+  testTrackData(model, 5, data::track5);
+
+  QVERIFY(track4.isValid());
+  QCOMPARE(model.data(track4, LogicalIdentityRole).value<qint64>(), 4ll);
+  QVERIFY(track4State.isValid());
+  QCOMPARE(track4State.parent(), QModelIndex{track4});
+  QCOMPARE(model.data(track4State, StartTimeRole).value<qint64>(), 2000ll);
+
+  // Test removal of contiguous rows
+  model.removeTracks({4, 5});
+  QCOMPARE(model.rowCount(), 1);
+  QVERIFY(!track4.isValid());
+
+  testTrackData(model, 2, data::track2);
+
+  // Test that the model's track map was updated
+  model.mergeTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{createTrack(2, data::track3, 6)}));
+  QCOMPARE(model.rowCount(), 1);
+
+  auto expected = data::track2;
+  expected.unite(data::track3);
+  testTrackData(model, 2, expected);
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackModel::undo()
+{
+  using Result = KwiverTrackModel::MergeTracksResult;
+
+  // Use enough tracks that the model's data is split across several chunks
+  std::vector<kv::track_sptr> tracks;
+  tracks.push_back(createTrack(1, data::track2, 2));
+  tracks.push_back(createTrack(2, data::track3, 6));
+  for (auto id = kv::track_id_t{3}; id < 600; ++id)
+  {
+    tracks.push_back(createTrack(id, data::track4, 17));
+  }
+
+  KwiverTrackModel model;
+  model.setTracks(std::make_shared<kv::object_track_set>(tracks));
+  QCOMPARE(model.rowCount(), 599);
+  QVERIFY(!model.canUndo());
+  QVERIFY(!model.canRedo());
+
+  QSignalSpy undoSpy{&model, &KwiverTrackModel::canUndoChanged};
+  QSignalSpy redoSpy{&model, &KwiverTrackModel::canRedoChanged};
+
+  // Test that rejected edits are not recorded
+  QVERIFY(!model.setData(model.index(400, 0), 0.5, ClassificationScoreRole));
+  QVERIFY(!model.canUndo());
+  QCOMPARE(undoSpy.count(), 0);
+
+  // Test undoing a classification change
+  auto const& index = model.index(400, 0);
+  auto const classification = QVariantHash{{"Eel", 0.9}};
+  QVERIFY(model.setData(index, classification, ClassificationRole));
+  QCOMPARE(model.data(index, ClassificationTypeRole).toString(),
+           QStringLiteral("Eel"));
+  QVERIFY(model.canUndo());
+  QCOMPARE(undoSpy.count(), 1);
+
+  model.undo();
+  QVERIFY(!model.canUndo());
+  QVERIFY(model.canRedo());
+  QCOMPARE(undoSpy.count(), 2);
+  QCOMPARE(redoSpy.count(), 1);
+  QVERIFY(!model.data(model.index(400, 0), ClassificationTypeRole).isValid());
+
+  model.redo();
+  QVERIFY(model.canUndo());
+  QVERIFY(!model.canRedo());
+  QCOMPARE(model.data(model.index(400, 0), ClassificationTypeRole).toString(),
+           QStringLiteral("Eel"));
+
+  // Test undoing a notes change
+  auto const notes = QStringList{QStringLiteral("Partially occluded")};
+  QVERIFY(model.setData(model.index(10, 0), notes, NotesRole));
+  QCOMPARE(model.data(model.index(10, 0), NotesRole).toStringList(), notes);
+
+  model.undo();
+  QVERIFY(model.data(model.index(10, 0), NotesRole).toStringList().isEmpty());
+  QCOMPARE(model.data(model.index(400, 0), ClassificationTypeRole).toString(),
+           QStringLiteral("Eel"));
+
+  // Test undoing a merge
+  QCOMPARE(model.mergeTracks({1, 2}), Result::Success);
+  QCOMPARE(model.rowCount(), 598);
+
+  auto expected = data::track2;
+  expected.unite(data::track3);
+  testTrackData(model, 1, expected);
+
+  model.undo();
+  QCOMPARE(model.rowCount(), 599);
+  testTrackData(model, 1, data::track2);
+  testTrackData(model, 2, data::track3);
+
+  // Test that a new edit discards undone edits
+  model.removeTracks({3, 300, 500});
+  QCOMPARE(model.rowCount(), 596);
+  QVERIFY(!model.canRedo());
+
+  model.undo();
+  QCOMPARE(model.rowCount(), 599);
+  testTrackData(model, 300, data::track4);
+
+  // Test that the classification change is still in the history
+  QCOMPARE(model.data(model.index(400, 0), ClassificationTypeRole).toString(),
+           QStringLiteral("Eel"));
+  model.undo();
+  QVERIFY(!model.data(model.index(400, 0), ClassificationTypeRole).isValid());
+  QVERIFY(!model.canUndo());
+
+  // Test that consecutive updates of a track are undone together
+  auto const state = TrackState{{0, 0, 10, 10}, {{"Dab", 0.2}}};
+  auto const& parent = model.index(1, 0);
+  auto const stateCount = model.rowCount(parent);
+  model.updateTrack(parent, createState(30, 2500, state));
+  model.updateTrack(parent, createState(31, 2600, state));
+  QCOMPARE(model.rowCount(model.index(1, 0)), stateCount + 2);
+
+  model.undo();
+  QCOMPARE(model.rowCount(model.index(1, 0)), stateCount);
+  testTrackData(model, 2, data::track3);
+  QVERIFY(!model.data(model.index(400, 0), ClassificationTypeRole).isValid());
+
+  // Test that updates of different tracks are separate edits
+  auto const otherStateCount = model.rowCount(model.index(0, 0));
+  model.updateTrack(model.index(0, 0), createState(30, 2500, state));
+  model.updateTrack(model.index(1, 0), createState(30, 2500, state));
+
+  model.undo();
+  QCOMPARE(model.rowCount(model.index(0, 0)), otherStateCount + 1);
+  QCOMPARE(model.rowCount(model.index(1, 0)), stateCount);
+
+  model.undo();
+  QCOMPARE(model.rowCount(model.index(0, 0)), otherStateCount);
+
+  // Test that replacing the model's tracks clears the history
+  model.redo();
+  QVERIFY(model.canUndo());
+  model.setTracks(std::make_shared<kv::object_track_set>(tracks));
+  QVERIFY(!model.canUndo());
+  QVERIFY(!model.canRedo());
+}
+
 } // namespace test
 
 } // namespace core
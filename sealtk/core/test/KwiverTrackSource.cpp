@@ -7,15 +7,21 @@
 #include <sealtk/core/test/TestCommon.hpp>
 #include <sealtk/core/test/TestTracks.hpp>
 
+#include <sealtk/core/KwiverTrackModel.hpp>
 #include <sealtk/core/KwiverTrackSource.hpp>
+#include <sealtk/core/TrackCache.hpp>
+#include <sealtk/core/TrackUtils.hpp>
 
 #include <vital/range/indirect.h>
 
 #include <QEventLoop>
+#include <QFile>
+#include <QTemporaryDir>
 #include <QUrlQuery>
 
 #include <QtTest>
 
+namespace kv = kwiver::vital;
 namespace kvr = kwiver::vital::range;
 
 using ModelPointer = std::shared_ptr<QAbstractItemModel>;
@@ -47,6 +53,52 @@ TimeMap<TrackState> stripClassification(TimeMap<TrackState> const& in)
   return out;
 }
 
+// ----------------------------------------------------------------------------
+kv::track_sptr createTrack(
+  kv::track_id_t id, TimeMap<TrackState> const& states,
+  kv::frame_id_t frameOffset)
+{
+  auto track = kv::track::create();
+  track->set_id(id);
+
+  auto frame = frameOffset;
+
+  for (auto const& i : states | kvr::indirect)
+  {
+    auto const& state = i.value();
+    auto detection = createDetection(state.location, state.classification);
+    track->append(createTrackState(++frame, i.key(), std::move(detection)));
+  }
+
+  return track;
+}
+
+// ----------------------------------------------------------------------------
+ModelPointer loadTracks(
+  QList<QUrl> const& uris, KwiverTrackSource::IdCollisionPolicy policy)
+{
+  KwiverTrackSource source;
+  ModelPointer model;
+  QEventLoop loop;
+
+  source.setIdCollisionPolicy(policy);
+
+  QObject::connect(&source, &AbstractDataSource::modelReady, &loop,
+                   [&](ModelPointer const& sourceModel){
+                     model = sourceModel;
+                     loop.quit();
+                   });
+  QObject::connect(&source, &AbstractDataSource::failed,
+                   &loop, &QEventLoop::quit);
+
+  if (source.readData(uris))
+  {
+    loop.exec();
+  }
+
+  return model;
+}
+
 } // namespace <anonymous>
 
 // ============================================================================
@@ -57,6 +109,9 @@ class TestKwiverTrackSource : public QObject
 private slots:
   void initTestCase();
   void loadTracks();
+  void loadTracksProgressive();
+  void loadTracksCached();
+  void loadMultipleFiles();
 };
 
 // ----------------------------------------------------------------------------
@@ -74,6 +129,8 @@ void TestKwiverTrackSource::loadTracks()
   ModelPointer model;
   QEventLoop loop;
 
+  QVERIFY(!source.cachingEnabled());
+
   connect(&source, &AbstractDataSource::modelReady, this,
           [&](ModelPointer const& sourceModel){
             model = sourceModel;
@@ -103,6 +160,222 @@ void TestKwiverTrackSource::loadTracks()
   testTrackData(*model, 5, stripClassification(data::track5));
 }
 
+// ----------------------------------------------------------------------------
+void TestKwiverTrackSource::loadTracksProgressive()
+{
+  KwiverTrackSource source;
+  ModelPointer model;
+  QEventLoop loop;
+
+  source.setProgressiveLoading(true);
+  QVERIFY(source.progressiveLoading());
+
+  connect(&source, &AbstractDataSource::modelReady, this,
+          [&](ModelPointer const& sourceModel){ model = sourceModel; });
+  connect(&source, &KwiverTrackSource::loadFinished, this,
+          [&](){ loop.quit(); });
+  connect(&source, &AbstractDataSource::failed, this,
+          [&](){ loop.quit(); });
+
+  QSignalSpy progressSpy{&source, &KwiverTrackSource::loadProgress};
+
+  auto const filename =
+    SEALTK_TEST_DATA_PATH("KwiverTrackSource/test.kw18");
+  auto uri = QUrl::fromLocalFile(filename);
+  auto params = QUrlQuery{};
+
+  params.addQueryItem("input:type", "kw18");
+  uri.setQuery(params);
+
+  QVERIFY(source.readData(uri));
+  QVERIFY(source.active());
+  loop.exec();
+
+  QVERIFY(!source.active());
+  QVERIFY(model);
+  QCOMPARE(model->rowCount(), 5);
+  QVERIFY(!progressSpy.isEmpty());
+  QCOMPARE(progressSpy.last().first().value<qint64>(), qint64{10});
+
+  testTrackData(*model, 1, stripClassification(data::track1));
+  testTrackData(*model, 2, stripClassification(data::track2));
+  testTrackData(*model, 3, stripClassification(data::track3));
+  testTrackData(*model, 4, stripClassification(data::track4));
+  testTrackData(*model, 5, stripClassification(data::track5));
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackSource::loadTracksCached()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  auto const& filename = dir.filePath(QStringLiteral("test.kw18"));
+  QVERIFY(QFile::copy(
+    SEALTK_TEST_DATA_PATH("KwiverTrackSource/test.kw18"), filename));
+
+  auto uri = QUrl::fromLocalFile(filename);
+  auto params = QUrlQuery{};
+
+  params.addQueryItem("input:type", "kw18");
+  uri.setQuery(params);
+
+  auto load = [&uri]{
+    KwiverTrackSource source;
+    ModelPointer model;
+    QEventLoop loop;
+
+    source.setCachingEnabled(true);
+
+    QObject::connect(&source, &AbstractDataSource::modelReady, &loop,
+                     [&](ModelPointer const& sourceModel){
+                       model = sourceModel;
+                       loop.quit();
+                     });
+    QObject::connect(&source, &AbstractDataSource::failed,
+                     &loop, &QEventLoop::quit);
+
+    source.readData(uri);
+    loop.exec();
+
+    // Destroying the source waits for the cache to be written
+    return model;
+  };
+
+  // Test that loading the tracks writes a cache for the reader configuration
+  auto const& cachePath =
+    trackCachePath(filename, QStringLiteral("input:type=kw18"));
+  QVERIFY(load());
+  QVERIFY(QFile::exists(cachePath));
+  QVERIFY(!QFile::exists(trackCachePath(filename)));
+
+  // Test that the tracks are loaded from the cache; replace the cache with
+  // different tracks, without touching the source
+  QVERIFY(writeTrackCache(
+    cachePath, std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{createTrack(7, data::track4, 17)}),
+    QFileInfo{filename}));
+
+  auto model = load();
+  QVERIFY(model);
+  QCOMPARE(model->rowCount(), 1);
+  testTrackData(*model, 7, data::track4);
+
+  // Test that the cache is not used with a different reader configuration
+  params.addQueryItem("input:kw18:unused", "1");
+  uri.setQuery(params);
+
+  model = load();
+  QVERIFY(model);
+  QCOMPARE(model->rowCount(), 5);
+
+  testTrackData(*model, 1, stripClassification(data::track1));
+  testTrackData(*model, 2, stripClassification(data::track2));
+  testTrackData(*model, 3, stripClassification(data::track3));
+  testTrackData(*model, 4, stripClassification(data::track4));
+  testTrackData(*model, 5, stripClassification(data::track5));
+
+  // Test that a cache written while loading progressively holds the tracks
+  // which were read, not the tracks in the model, which may have been edited
+  QVERIFY(QFile::remove(cachePath));
+  params.removeAllQueryItems("input:kw18:unused");
+  uri.setQuery(params);
+
+  {
+    KwiverTrackSource source;
+    QEventLoop loop;
+
+    source.setCachingEnabled(true);
+    source.setProgressiveLoading(true);
+
+    QObject::connect(&source, &AbstractDataSource::modelReady, &loop,
+                     [&](ModelPointer const& sourceModel){
+                       model = sourceModel;
+                     });
+    QObject::connect(&source, &KwiverTrackSource::loadFinished, &loop,
+                     [&]{
+                       auto* const trackModel =
+                         qobject_cast<KwiverTrackModel*>(model.get());
+                       QVERIFY(trackModel);
+                       trackModel->removeTracks({1, 2});
+                       loop.quit();
+                     });
+    QObject::connect(&source, &AbstractDataSource::failed,
+                     &loop, &QEventLoop::quit);
+
+    source.readData(uri);
+    loop.exec();
+  }
+
+  QCOMPARE(model->rowCount(), 3);
+
+  auto const& cachedTracks = readTrackCache(cachePath, QFileInfo{filename});
+  QVERIFY(cachedTracks);
+  QCOMPARE(cachedTracks->size(), size_t{5});
+
+  // Test that the cache file itself can be loaded
+  uri = QUrl::fromLocalFile(cachePath);
+
+  QVERIFY(load());
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTrackSource::loadMultipleFiles()
+{
+  using Policy = KwiverTrackSource::IdCollisionPolicy;
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  // Write two track files (as caches, which are read directly); track 2
+  // appears in both files, with disjoint states
+  auto const& path1 = dir.filePath(QStringLiteral("a.sealtk-cache"));
+  auto const& path2 = dir.filePath(QStringLiteral("b.sealtk-cache"));
+
+  QVERIFY(writeTrackCache(
+    path1, std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(1, data::track1, 0),
+        createTrack(2, data::track2, 2),
+      })));
+  QVERIFY(writeTrackCache(
+    path2, std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(2, data::track3, 6),
+        createTrack(3, data::track4, 17),
+      })));
+
+  auto const uris =
+    QList<QUrl>{QUrl::fromLocalFile(path1), QUrl::fromLocalFile(path2)};
+
+  // Test renumbering of colliding identifiers
+  auto model = loadTracks(uris, Policy::Renumber);
+  QVERIFY(model);
+  QCOMPARE(model->rowCount(), 4);
+
+  testTrackData(*model, 1, data::track1);
+  testTrackData(*model, 2, data::track2);
+  testTrackData(*model, 3, data::track4);
+  testTrackData(*model, 4, data::track3);
+
+  // Test merging of colliding identifiers
+  model = loadTracks(uris, Policy::Merge);
+  QVERIFY(model);
+  QCOMPARE(model->rowCount(), 3);
+
+  auto expected = data::track2;
+  expected.unite(data::track3);
+
+  testTrackData(*model, 1, data::track1);
+  testTrackData(*model, 2, expected);
+  testTrackData(*model, 3, data::track4);
+
+  // Test that a missing file causes the import to fail
+  auto const badUris =
+    QList<QUrl>{uris.first(), QUrl::fromLocalFile(dir.filePath("c.csv"))};
+  QVERIFY(!loadTracks(badUris, Policy::Renumber));
+}
+
 } // namespace test
 
 } // namespace core
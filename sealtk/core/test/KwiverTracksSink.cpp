@@ -10,18 +10,29 @@
 #include <sealtk/core/test/TestVideoSource.hpp>
 
 #include <sealtk/core/IdentityTransform.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
 #include <sealtk/core/KwiverTracksSink.hpp>
+#include <sealtk/core/ScalarFilterModel.hpp>
+#include <sealtk/core/TrackUtils.hpp>
 #include <sealtk/core/VideoRequest.hpp>
 
 #include <vital/types/homography.h>
 
+#include <vital/range/indirect.h>
+#include <vital/range/iota.h>
+
+#include <qtStlUtil.h>
+
 #include <QRegularExpression>
 #include <QTemporaryFile>
 #include <QUrlQuery>
 
 #include <QtTest>
 
+Q_DECLARE_METATYPE(sealtk::core::KwiverTracksSink::ExportMode)
+
 namespace kv = kwiver::vital;
+namespace kvr = kwiver::vital::range;
 
 namespace sealtk
 {
@@ -58,6 +69,32 @@ void compareFiles(QIODevice& actual, QString const& expected,
   QVERIFY(ef.atEnd());
 }
 
+// ----------------------------------------------------------------------------
+void addTracks(KwiverTrackModel& model,
+               QVector<TimeMap<TrackState>> const& data,
+               kv::track_id_t firstId)
+{
+  auto tracks = std::vector<kv::track_sptr>{};
+  for (auto const i : kvr::iota(data.count()))
+  {
+    auto track = kv::track::create();
+    track->set_id(firstId + i);
+
+    for (auto const& s : data[i] | kvr::indirect)
+    {
+      auto const& state = s.value();
+      track->append(
+        createTrackState(s.key() / 100, s.key(),
+                         createDetection(state.location,
+                                         state.classification)));
+    }
+
+    tracks.push_back(std::move(track));
+  }
+
+  model.addTracks(std::make_shared<kv::object_track_set>(tracks));
+}
+
 } // namespace <anonymous>
 
 // ============================================================================
@@ -71,6 +108,13 @@ private slots:
   void cleanup();
 
   void kw18();
+  void kw18_data();
+  void kw18Snapshot();
+  void kw18Snapshot_data();
+  void kw18Filtered();
+  void exportModeForWriter();
+  void benchmark();
+  void benchmark_data();
 
 private:
   std::unique_ptr<SimpleVideoSource> source;
@@ -144,7 +188,10 @@ void TestKwiverTracksSink::cleanup()
 // ----------------------------------------------------------------------------
 void TestKwiverTracksSink::kw18()
 {
+  QFETCH(KwiverTracksSink::ExportMode, exportMode);
+
   KwiverTracksSink sink;
+  sink.setExportMode(exportMode);
 
   connect(&sink, &AbstractDataSink::failed,
           this, [](QString const& message){
@@ -164,13 +211,265 @@ void TestKwiverTracksSink::kw18()
   params.addQueryItem("output:type", "kw18");
   uri.setQuery(params);
 
+  auto progress = QPair<int, int>{-1, -1};
+  connect(&sink, &KwiverTracksSink::writeProgress,
+          this, [&progress](int framesWritten, int framesTotal){
+            QVERIFY(framesWritten >= progress.first);
+            progress = {framesWritten, framesTotal};
+          });
+
+  sink.writeData(uri);
+
+  QCOMPARE(progress, (QPair<int, int>{10, 10}));
+
+  auto const& expected =
+    SEALTK_TEST_DATA_PATH("KwiverTracksSink/expected.kw18");
+  compareFiles(out, expected, QRegularExpression{QStringLiteral("^#")});
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTracksSink::kw18_data()
+{
+  QTest::addColumn<KwiverTracksSink::ExportMode>("exportMode");
+
+  QTest::newRow("cumulative") << KwiverTracksSink::ExportMode::Cumulative;
+  QTest::newRow("incremental") << KwiverTracksSink::ExportMode::Incremental;
+  QTest::newRow("final") << KwiverTracksSink::ExportMode::Final;
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTracksSink::kw18Snapshot()
+{
+  QFETCH(KwiverTracksSink::ExportMode, exportMode);
+
+  KwiverTrackModel primaryModel;
+  KwiverTrackModel shadowModel;
+  addTracks(primaryModel, {data::track1, data::track2, data::track3}, 1);
+  addTracks(shadowModel, {data::track4, data::track5}, 4);
+
+  KwiverTracksSink sink;
+  sink.setExportMode(exportMode);
+
+  connect(&sink, &AbstractDataSink::failed,
+          this, [](QString const& message){
+            QFAIL(qPrintable(message));
+          });
+
+  QVERIFY(sink.setData(this->source.get(), &primaryModel));
+  QVERIFY(sink.setTransform(this->primaryTransform));
+  QVERIFY(sink.addData(&shadowModel, this->shadowTransform));
+
+  // Test that the data of a KwiverTrackModel is not affected by changes to
+  // the model after it has been added to the sink
+  primaryModel.removeTracks({2});
+  shadowModel.clear();
+
+  QTemporaryFile out;
+  QVERIFY(out.open());
+
+  auto uri = QUrl::fromLocalFile(out.fileName());
+  auto params = QUrlQuery{};
+
+  params.addQueryItem("output:type", "kw18");
+  uri.setQuery(params);
+
   sink.writeData(uri);
 
+  // Test that the output is the same as for data copied from other models
   auto const& expected =
     SEALTK_TEST_DATA_PATH("KwiverTracksSink/expected.kw18");
   compareFiles(out, expected, QRegularExpression{QStringLiteral("^#")});
 }
 
+// ----------------------------------------------------------------------------
+void TestKwiverTracksSink::kw18Snapshot_data()
+{
+  this->kw18_data();
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTracksSink::kw18Filtered()
+{
+  KwiverTrackModel primaryModel;
+  KwiverTrackModel shadowModel;
+  addTracks(primaryModel, {data::track1, data::track2, data::track3}, 1);
+  addTracks(shadowModel, {data::track4, data::track5}, 4);
+
+  auto const& write = [&](bool scoreOnly){
+    KwiverTracksSink sink;
+    sink.setExportMode(KwiverTracksSink::ExportMode::Incremental);
+
+    connect(&sink, &AbstractDataSink::failed,
+            this, [](QString const& message){
+              QFAIL(qPrintable(message));
+            });
+
+    // Filters which bound anything other than the classification score are
+    // applied by copying the filtered data, rather than to a snapshot
+    ScalarFilterModel primaryFilter;
+    ScalarFilterModel shadowFilter;
+    for (auto* const filter : {&primaryFilter, &shadowFilter})
+    {
+      filter->setLowerBound(ClassificationScoreRole, 0.5);
+      if (!scoreOnly)
+      {
+        filter->setLowerBound(StartTimeRole, QVariant::fromValue(
+                                kv::timestamp::time_t{0}));
+      }
+    }
+    primaryFilter.setSourceModel(&primaryModel);
+    shadowFilter.setSourceModel(&shadowModel);
+
+    auto haveData = sink.setData(this->source.get(), &primaryFilter);
+    sink.setTransform(this->primaryTransform);
+    haveData = sink.addData(&shadowFilter, this->shadowTransform) && haveData;
+
+    QTemporaryFile out;
+    auto lines = QStringList{};
+    if (haveData && out.open())
+    {
+      auto uri = QUrl::fromLocalFile(out.fileName());
+      auto params = QUrlQuery{};
+
+      params.addQueryItem("output:type", "kw18");
+      uri.setQuery(params);
+
+      sink.writeData(uri);
+
+      out.seek(0);
+      while (!out.atEnd())
+      {
+        auto const& line = QString::fromUtf8(out.readLine());
+        if (!line.startsWith(QLatin1Char{'#'}))
+        {
+          lines.append(line);
+        }
+      }
+    }
+
+    return lines;
+  };
+
+  // Test that only tracks and states whose classification score passes the
+  // filter are written, i.e. all of track 3 and the last states of tracks 2
+  // and 5
+  auto const& snapshotLines = write(true);
+  auto ids = QStringList{};
+  for (auto const& line : snapshotLines)
+  {
+    ids.append(line.section(QLatin1Char{' '}, 0, 0));
+  }
+  QCOMPARE(ids, (QStringList{"2", "3", "5"}));
+
+  // Test that the output is the same as when the filtered data is copied
+  QCOMPARE(snapshotLines, write(false));
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTracksSink::exportModeForWriter()
+{
+  using ExportMode = KwiverTracksSink::ExportMode;
+
+  QCOMPARE(KwiverTracksSink::exportModeForWriter(QStringLiteral("kw18")),
+           ExportMode::Incremental);
+  QCOMPARE(KwiverTracksSink::exportModeForWriter(QStringLiteral("viame_csv")),
+           ExportMode::Incremental);
+  QCOMPARE(KwiverTracksSink::exportModeForWriter(QStringLiteral("kpf")),
+           ExportMode::Cumulative);
+  QCOMPARE(KwiverTracksSink::exportModeForWriter(QString{}),
+           ExportMode::Cumulative);
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTracksSink::benchmark()
+{
+  QFETCH(KwiverTracksSink::ExportMode, exportMode);
+  QFETCH(int, frameCount);
+
+  using vmd = core::VideoMetaData;
+
+  // Generate overlapping tracks, each having a state on ten consecutive
+  // frames, so that the number of active tracks on any frame is constant
+  // and the total number of states is proportional to the number of frames
+  constexpr auto trackLength = 10;
+
+  auto frames = TimeMap<vmd>{};
+  auto tracks = QVector<TimeMap<TrackState>>{};
+  for (auto const f : kvr::iota(frameCount))
+  {
+    auto const t = kv::timestamp::time_t{100} * (f + 1);
+    auto const& name =
+      QStringLiteral("frame%1.png").arg(f + 1, 6, 10, QLatin1Char{'0'});
+    frames.insert(t, vmd{kv::timestamp{t, f + 1}, stdString(name)});
+
+    if (f + trackLength <= frameCount)
+    {
+      tracks.append({});
+    }
+
+    for (auto const i : kvr::iota(trackLength))
+    {
+      auto const k = f - i;
+      if (k >= 0 && k < tracks.count())
+      {
+        auto const x = static_cast<double>(10 * i);
+        tracks[k].insert(t, {{x, 5.0 * k, 10.0, 10.0}, {{"Dab", 0.5}}});
+      }
+    }
+  }
+
+  SimpleVideoSource source{frames};
+  SimpleTrackModel model{tracks};
+
+  KwiverTracksSink sink;
+  sink.setExportMode(exportMode);
+
+  QTemporaryFile out;
+  QVERIFY(out.open());
+
+  auto uri = QUrl::fromLocalFile(out.fileName());
+  auto params = QUrlQuery{};
+
+  params.addQueryItem("output:type", "kw18");
+  uri.setQuery(params);
+
+  // With incremental and final export, the time taken should grow linearly
+  // with the number of frames (and thus the number of states); since writing
+  // consumes the data, the data must be set for each iteration
+  QBENCHMARK
+  {
+    sink.setData(&source, &model);
+    sink.writeData(uri);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void TestKwiverTracksSink::benchmark_data()
+{
+  QTest::addColumn<KwiverTracksSink::ExportMode>("exportMode");
+  QTest::addColumn<int>("frameCount");
+
+  auto const modes = {
+    qMakePair(QStringLiteral("cumulative"),
+              KwiverTracksSink::ExportMode::Cumulative),
+    qMakePair(QStringLiteral("incremental"),
+              KwiverTracksSink::ExportMode::Incremental),
+    qMakePair(QStringLiteral("final"),
+              KwiverTracksSink::ExportMode::Final),
+  };
+
+  for (auto const& mode : modes)
+  {
+    for (auto const frameCount : {250, 500, 1000, 2000})
+    {
+      auto const& name =
+        QStringLiteral("%1, %2 states")
+          .arg(mode.first).arg(frameCount * 10);
+      QTest::newRow(qPrintable(name)) << mode.second << frameCount;
+    }
+  }
+}
+
 } // namespace test
 
 } // namespace core
@@ -0,0 +1,253 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/test/TestCore.hpp>
+
+#include <sealtk/core/PipelineResultCache.hpp>
+#include <sealtk/core/TrackUtils.hpp>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <QtTest>
+
+#include <memory>
+
+namespace kv = kwiver::vital;
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace test
+{
+
+namespace // anonymous
+{
+
+// ----------------------------------------------------------------------------
+bool writeFile(QString const& path, QByteArray const& content,
+               QIODevice::OpenMode mode = QIODevice::WriteOnly)
+{
+  QFile file{path};
+  if (!file.open(mode))
+  {
+    return false;
+  }
+
+  return file.write(content) == content.size();
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr createTracks(int count)
+{
+  auto tracks = std::vector<kv::track_sptr>{};
+  for (auto i = 0; i < count; ++i)
+  {
+    auto track = kv::track::create();
+    track->set_id(i + 1);
+
+    auto detection =
+      createDetection({10.0 * i, 5.0, 10.0, 10.0}, {{"Dab", 0.5}});
+    track->append(createTrackState(0, 100, std::move(detection)));
+
+    tracks.emplace_back(std::move(track));
+  }
+
+  return std::make_shared<kv::object_track_set>(tracks);
+}
+
+// ----------------------------------------------------------------------------
+qint64 directorySize(QString const& path)
+{
+  auto size = qint64{0};
+  for (auto const& entry : QDir{path}.entryInfoList(QDir::Files))
+  {
+    size += entry.size();
+  }
+
+  return size;
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class TestPipelineResultCache : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void key();
+  void pipelineIdentity();
+  void roundTrip();
+  void eviction();
+
+private:
+  std::unique_ptr<QTemporaryDir> dir;
+  QString pipelinePath;
+  QString cachePath;
+  QString imagePath;
+};
+
+// ----------------------------------------------------------------------------
+void TestPipelineResultCache::init()
+{
+  this->dir.reset(new QTemporaryDir);
+  QVERIFY(this->dir->isValid());
+
+  this->pipelinePath = this->dir->filePath(QStringLiteral("test.pipe"));
+  this->cachePath = this->dir->filePath(QStringLiteral("cache"));
+  this->imagePath = this->dir->filePath(QStringLiteral("image.png"));
+
+  QVERIFY(writeFile(this->dir->filePath(QStringLiteral("common.pipe")),
+                    "process common :: common_process\n"));
+  QVERIFY(writeFile(this->dir->filePath(QStringLiteral("model.bin")),
+                    "weights"));
+  QVERIFY(writeFile(this->pipelinePath,
+                    "include common.pipe\n"
+                    "process detector :: detector_process\n"
+                    "  relativepath model = model.bin\n"));
+  QVERIFY(writeFile(this->imagePath, "image"));
+}
+
+// ----------------------------------------------------------------------------
+void TestPipelineResultCache::cleanup()
+{
+  this->dir.reset();
+}
+
+// ----------------------------------------------------------------------------
+void TestPipelineResultCache::key()
+{
+  PipelineResultCache cache{this->pipelinePath, this->cachePath};
+  QVERIFY(cache.isValid());
+  QVERIFY(QDir{this->cachePath}.exists());
+
+  auto const& key = cache.key(100, {this->imagePath, {}});
+  QVERIFY(!key.isEmpty());
+
+  // Test that keys are stable
+  QCOMPARE(cache.key(100, {this->imagePath, {}}), key);
+
+  // Test that keys depend on the time and inputs
+  QVERIFY(cache.key(200, {this->imagePath, {}}) != key);
+  QVERIFY(cache.key(100, {{}, this->imagePath}) != key);
+  QVERIFY(cache.key(100, {this->imagePath}) != key);
+
+  // Test that inputs which are not files cannot be identified
+  QVERIFY(cache.key(100, {this->dir->path()}).isEmpty());
+  QVERIFY(cache.key(100, {this->dir->filePath("missing.png")}).isEmpty());
+
+  // Test that keys depend on the content of the inputs
+  QVERIFY(writeFile(this->imagePath, "modified", QIODevice::Append));
+  QVERIFY(cache.key(100, {this->imagePath, {}}) != key);
+}
+
+// ----------------------------------------------------------------------------
+void TestPipelineResultCache::pipelineIdentity()
+{
+  auto const inputs = QVector<QString>{this->imagePath};
+
+  auto const& originalKey =
+    PipelineResultCache{this->pipelinePath, this->cachePath}.key(0, inputs);
+  QVERIFY(!originalKey.isEmpty());
+
+  // Test that keys depend on files included by the pipeline
+  QVERIFY(writeFile(this->dir->filePath(QStringLiteral("common.pipe")),
+                    "  :value = 1\n", QIODevice::Append));
+
+  auto const& includeKey =
+    PipelineResultCache{this->pipelinePath, this->cachePath}.key(0, inputs);
+  QVERIFY(!includeKey.isEmpty());
+  QVERIFY(includeKey != originalKey);
+
+  // Test that keys depend on other files referenced by the pipeline
+  QVERIFY(writeFile(this->dir->filePath(QStringLiteral("model.bin")),
+                    "retrained", QIODevice::Append));
+
+  auto const& modelKey =
+    PipelineResultCache{this->pipelinePath, this->cachePath}.key(0, inputs);
+  QVERIFY(!modelKey.isEmpty());
+  QVERIFY(modelKey != includeKey);
+
+  // Test that a cache cannot be used without a pipeline
+  PipelineResultCache invalidCache{
+    this->dir->filePath(QStringLiteral("missing.pipe")), this->cachePath};
+  QVERIFY(!invalidCache.isValid());
+  QVERIFY(invalidCache.key(0, inputs).isEmpty());
+}
+
+// ----------------------------------------------------------------------------
+void TestPipelineResultCache::roundTrip()
+{
+  PipelineResultCache cache{this->pipelinePath, this->cachePath};
+  QVERIFY(cache.isValid());
+
+  auto const& key = cache.key(100, {this->imagePath});
+  QVERIFY(!cache.find(key, 0));
+
+  cache.insert(key, 0, createTracks(3));
+  cache.insert(key, 1, createTracks(0));
+
+  auto const& tracks = cache.find(key, 0);
+  QVERIFY(tracks);
+  QCOMPARE(tracks->size(), size_t{3});
+
+  // Test that empty results are distinguished from missing results
+  auto const& emptyTracks = cache.find(key, 1);
+  QVERIFY(emptyTracks);
+  QVERIFY(emptyTracks->empty());
+
+  QVERIFY(!cache.find(key, 2));
+  QVERIFY(!cache.find(cache.key(200, {this->imagePath}), 0));
+  QVERIFY(!cache.find({}, 0));
+
+  // Test that results are shared by caches of the same pipeline
+  PipelineResultCache otherCache{this->pipelinePath, this->cachePath};
+  QVERIFY(otherCache.find(key, 0));
+}
+
+// ----------------------------------------------------------------------------
+void TestPipelineResultCache::eviction()
+{
+  // Determine the size of a single entry
+  auto entrySize = qint64{0};
+  {
+    auto const& path = this->dir->filePath(QStringLiteral("probe"));
+    PipelineResultCache cache{this->pipelinePath, path};
+    cache.insert(cache.key(0, {}), 0, createTracks(10));
+    entrySize = directorySize(path);
+    QVERIFY(entrySize > 0);
+  }
+
+  // Test that the cache stays within its limit
+  auto const sizeLimit = entrySize * 3;
+  PipelineResultCache cache{this->pipelinePath, this->cachePath, sizeLimit};
+
+  for (auto t = 0; t < 10; ++t)
+  {
+    cache.insert(cache.key(t, {}), 0, createTracks(10));
+    QVERIFY(directorySize(this->cachePath) <= sizeLimit);
+  }
+
+  auto const& entries = QDir{this->cachePath}.entryList(QDir::Files);
+  QVERIFY(entries.count() > 0);
+  QVERIFY(entries.count() <= 3);
+}
+
+} // namespace test
+
+} // namespace core
+
+} // namespace sealtk
+
+// ----------------------------------------------------------------------------
+QTEST_MAIN(sealtk::core::test::TestPipelineResultCache)
+#include "PipelineResultCache.moc"
@@ -6,15 +6,20 @@
 
 #include <sealtk/core/AbstractItemModel.hpp>
 #include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/TrackUtils.hpp>
 
+#include <vital/types/object_track_set.h>
 #include <vital/types/timestamp.h>
 
 #include <vital/range/iota.h>
 
 #include <QSet>
+#include <QVector>
 
 #include <QtTest>
 
+namespace kv = kwiver::vital;
 namespace kvr = kwiver::vital::range;
 
 using time_us_t = kwiver::vital::timestamp::time_t;
@@ -86,6 +91,76 @@ QVariant TestModel::data(QModelIndex const& index, int role) const
   return this->sealtk::core::AbstractItemModel::data(index, role);
 }
 
+// ============================================================================
+class TestMutatingModel : public sealtk::core::AbstractItemModel
+{
+public:
+  int rowCount(QModelIndex const& parent = {}) const override
+  { return (parent.isValid() ? 0 : this->times.count()); }
+
+  QVariant data(QModelIndex const& index, int role) const override;
+
+  void insertRow(int i, time_us_t time)
+  {
+    this->beginInsertRows({}, i, i);
+    this->times.insert(i, time);
+    this->endInsertRows();
+  }
+
+  void removeRow(int i)
+  {
+    this->beginRemoveRows({}, i, i);
+    this->times.remove(i);
+    this->endRemoveRows();
+  }
+
+  void setTime(int i, time_us_t time)
+  {
+    this->times[i] = time;
+
+    auto const& index = this->index(i, 0);
+    emit this->dataChanged(index, index, {sealtk::core::StartTimeRole});
+  }
+
+private:
+  QVector<time_us_t> times;
+};
+
+// ----------------------------------------------------------------------------
+QVariant TestMutatingModel::data(QModelIndex const& index, int role) const
+{
+  if (this->checkIndex(index, IndexIsValid | ParentIsInvalid))
+  {
+    switch (role)
+    {
+      case sealtk::core::StartTimeRole:
+        return QVariant::fromValue(this->times[index.row()]);
+
+      default:
+        break;
+    }
+  }
+
+  return this->sealtk::core::AbstractItemModel::data(index, role);
+}
+
+// ----------------------------------------------------------------------------
+kv::track_state_sptr createState(kv::frame_id_t frame, time_us_t time)
+{
+  return createTrackState(frame, time, createDetection({0.0, 0.0, 1.0, 1.0}));
+}
+
+// ----------------------------------------------------------------------------
+kv::track_sptr createTrack(kv::track_id_t id, time_us_t start, time_us_t end)
+{
+  auto track = kv::track::create();
+  track->set_id(id);
+  track->append(createState(1, start));
+  track->append(createState(2, end));
+
+  return track;
+}
+
 // ----------------------------------------------------------------------------
 QSet<int> visibleRows(QAbstractItemModel const& model)
 {
@@ -116,6 +191,10 @@ class TestScalarFilterModel : public QObject
 private slots:
   void filtering();
   void filtering_data();
+  void sourceChanges();
+  void childChanges();
+  void classificationChanges();
+  void visibilityNotification();
 };
 
 // ----------------------------------------------------------------------------
@@ -195,6 +274,164 @@ void TestScalarFilterModel::filtering_data()
     << QSet<int>{4, 5, 6};
 }
 
+// ----------------------------------------------------------------------------
+void TestScalarFilterModel::sourceChanges()
+{
+  using sealtk::core::StartTimeRole;
+
+  TestMutatingModel model;
+  ScalarFilterModel filter;
+
+  filter.setSourceModel(&model);
+  filter.setBound(StartTimeRole, QVariant::fromValue(300),
+                  QVariant::fromValue(700));
+
+  // Test visibility of inserted rows
+  model.insertRow(0, 100);
+  model.insertRow(1, 500);
+  model.insertRow(2, 900);
+  model.insertRow(1, 400);
+  QCOMPARE(visibleRows(filter), (QSet<int>{1, 2}));
+
+  // Test visibility after removing a row
+  model.removeRow(0);
+  QCOMPARE(visibleRows(filter), (QSet<int>{0, 1}));
+
+  // Test visibility after changing the data of a row
+  model.setTime(2, 600);
+  model.setTime(0, 200);
+  QCOMPARE(visibleRows(filter), (QSet<int>{1, 2}));
+
+  // Test visibility after changing and clearing the bounds
+  filter.setUpperBound(StartTimeRole, QVariant::fromValue(550));
+  QCOMPARE(visibleRows(filter), (QSet<int>{1}));
+
+  filter.clearLowerBound(StartTimeRole);
+  QCOMPARE(visibleRows(filter), (QSet<int>{0, 1}));
+
+  filter.clearBounds();
+  QCOMPARE(visibleRows(filter), (QSet<int>{0, 1, 2}));
+}
+
+// ----------------------------------------------------------------------------
+void TestScalarFilterModel::childChanges()
+{
+  using sealtk::core::EndTimeRole;
+
+  KwiverTrackModel model;
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(1, 100, 200),
+        createTrack(2, 300, 400),
+      }));
+
+  ScalarFilterModel filter;
+  filter.setSourceModel(&model);
+  filter.setLowerBound(EndTimeRole, QVariant::fromValue(350));
+  QCOMPARE(visibleRows(filter), (QSet<int>{1}));
+
+  // Test that extending a track (inserting a state) updates its visibility
+  model.updateTrack(model.index(0, 0), createState(3, 500));
+  QCOMPARE(visibleRows(filter), (QSet<int>{0, 1}));
+
+  // Test that changing a track's state updates its visibility
+  model.updateTrack(model.index(0, 0), createState(3, 300));
+  QCOMPARE(visibleRows(filter), (QSet<int>{1}));
+
+  // Test that changing another track updates only that track's visibility
+  model.updateTrack(model.index(1, 0), createState(2, 200));
+  QCOMPARE(visibleRows(filter), (QSet<int>{}));
+
+  model.updateTrack(model.index(0, 0), createState(4, 600));
+  QCOMPARE(visibleRows(filter), (QSet<int>{0}));
+}
+
+// ----------------------------------------------------------------------------
+void TestScalarFilterModel::classificationChanges()
+{
+  using sealtk::core::ClassificationRole;
+  using sealtk::core::ClassificationScoreRole;
+
+  KwiverTrackModel model;
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(1, 100, 200),
+        createTrack(2, 300, 400),
+      }));
+
+  QVERIFY(model.setData(model.index(0, 0), QVariantHash{{"Dab", 0.3}},
+                        ClassificationRole));
+  QVERIFY(model.setData(model.index(1, 0), QVariantHash{{"Eel", 0.8}},
+                        ClassificationRole));
+
+  ScalarFilterModel filter;
+  filter.setSourceModel(&model);
+  filter.setLowerBound(ClassificationScoreRole, QVariant::fromValue(0.5));
+  QCOMPARE(visibleRows(filter), (QSet<int>{1}));
+
+  // Test that changing a track's classification updates its visibility,
+  // even though only the complete classification is reported as changed
+  QVERIFY(model.setData(model.index(0, 0), QVariantHash{{"Dab", 0.9}},
+                        ClassificationRole));
+  QCOMPARE(visibleRows(filter), (QSet<int>{0, 1}));
+
+  QVERIFY(model.setData(model.index(1, 0),
+                        QVariantHash{{"Eel", 0.2}, {"Gar", 0.4}},
+                        ClassificationRole));
+  QCOMPARE(visibleRows(filter), (QSet<int>{0}));
+}
+
+// ----------------------------------------------------------------------------
+void TestScalarFilterModel::visibilityNotification()
+{
+  using sealtk::core::StartTimeRole;
+
+  TestModel model{10};
+  ScalarFilterModel filter;
+  filter.setSourceModel(&model);
+
+  QSignalSpy spy{&filter, &QAbstractItemModel::dataChanged};
+
+  auto testRange = [&](int first, int last){
+    QVERIFY(!spy.isEmpty());
+
+    auto const& args = spy.takeFirst();
+    QCOMPARE(args[0].toModelIndex().row(), first);
+    QCOMPARE(args[1].toModelIndex().row(), last);
+    QCOMPARE(args[2].value<QVector<int>>(), QVector<int>{VisibilityRole});
+  };
+
+  // Test that only rows which changed visibility are reported
+  filter.setLowerBound(StartTimeRole, QVariant::fromValue(300));
+  QCOMPARE(spy.count(), 1);
+  testRange(0, 2);
+
+  filter.setLowerBound(StartTimeRole, QVariant::fromValue(500));
+  QCOMPARE(spy.count(), 1);
+  testRange(3, 4);
+
+  filter.setUpperBound(StartTimeRole, QVariant::fromValue(800));
+  QCOMPARE(spy.count(), 1);
+  testRange(9, 9);
+
+  filter.setBound(StartTimeRole, QVariant::fromValue(200),
+                  QVariant::fromValue(800));
+  QCOMPARE(spy.count(), 1);
+  testRange(2, 4);
+
+  // Test that nothing is reported if no row changed visibility
+  filter.setLowerBound(StartTimeRole, QVariant::fromValue(150));
+  QCOMPARE(spy.count(), 0);
+
+  // Test that separate ranges are reported separately
+  filter.clearBound(StartTimeRole);
+  QCOMPARE(spy.count(), 2);
+  testRange(0, 1);
+  testRange(9, 9);
+}
+
 } // namespace test
 
 } // namespace core
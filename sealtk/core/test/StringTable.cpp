@@ -0,0 +1,98 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/core/StringTable.hpp>
+
+#include <QObject>
+#include <QtTest>
+
+#include <thread>
+#include <vector>
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace test
+{
+
+// ============================================================================
+class TestStringTable : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void intern();
+  void concurrentIntern();
+};
+
+// ----------------------------------------------------------------------------
+void TestStringTable::intern()
+{
+  auto const dab = core::internString(QStringLiteral("Dab"));
+  auto const eel = core::internString(QStringLiteral("Eel"));
+
+  QVERIFY(dab >= 0);
+  QVERIFY(eel >= 0);
+  QVERIFY(dab != eel);
+
+  QCOMPARE(core::internString(QStringLiteral("Dab")), dab);
+  QCOMPARE(core::internString(std::string{"Dab"}), dab);
+  QCOMPARE(core::internString(std::string{"Eel"}), eel);
+
+  QCOMPARE(core::internedString(dab), QStringLiteral("Dab"));
+  QCOMPARE(core::internedString(eel), QStringLiteral("Eel"));
+
+  QVERIFY(core::internedString(-1).isNull());
+}
+
+// ----------------------------------------------------------------------------
+void TestStringTable::concurrentIntern()
+{
+  static constexpr auto threadCount = 8;
+  static constexpr auto stringCount = 1000;
+
+  std::vector<std::vector<int>> ids(threadCount);
+  std::vector<std::thread> threads;
+
+  for (auto t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([t, &ids]{
+      for (auto n = 0; n < stringCount; ++n)
+      {
+        auto const s = QStringLiteral("concurrent-%1").arg(n);
+        ids[static_cast<size_t>(t)].push_back(core::internString(s));
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (auto n = 0; n < stringCount; ++n)
+  {
+    auto const expected = QStringLiteral("concurrent-%1").arg(n);
+    auto const id = ids[0][static_cast<size_t>(n)];
+    QCOMPARE(core::internedString(id), expected);
+
+    for (auto t = 1; t < threadCount; ++t)
+    {
+      QCOMPARE(ids[static_cast<size_t>(t)][static_cast<size_t>(n)], id);
+    }
+  }
+}
+
+} // namespace test
+
+} // namespace core
+
+} // namespace sealtk
+
+// ----------------------------------------------------------------------------
+QTEST_MAIN(sealtk::core::test::TestStringTable)
+#include "StringTable.moc"
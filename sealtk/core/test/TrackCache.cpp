@@ -0,0 +1,179 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/test/TestCore.hpp>
+
+#include <sealtk/core/test/TestTracks.hpp>
+
+#include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/TrackCache.hpp>
+#include <sealtk/core/TrackUtils.hpp>
+
+#include <vital/range/indirect.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <QtTest>
+
+namespace kv = kwiver::vital;
+namespace kvr = kwiver::vital::range;
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace test
+{
+
+namespace // anonymous
+{
+
+// ----------------------------------------------------------------------------
+kv::track_sptr createTrack(
+  kv::track_id_t id, TimeMap<TrackState> const& states,
+  kv::frame_id_t frameOffset = 0, QStringList const& notes = {})
+{
+  auto track = kv::track::create();
+  track->set_id(id);
+
+  auto frame = frameOffset;
+
+  for (auto const& i : states | kvr::indirect)
+  {
+    auto const& state = i.value();
+    auto detection =
+      createDetection(state.location, state.classification, notes);
+    track->append(createTrackState(++frame, i.key(), std::move(detection)));
+  }
+
+  return track;
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr createTracks()
+{
+  return std::make_shared<kv::object_track_set>(
+    std::vector<kv::track_sptr>{
+      createTrack(1, data::track1, 0, {"first", "second"}),
+      createTrack(2, data::track2, 2),
+      createTrack(3, data::track3, 6, {"first"}),
+      createTrack(4, data::track4, 17),
+      createTrack(5, data::track5, 10),
+    });
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class TestTrackCache : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void roundTrip();
+  void sourceValidation();
+  void invalidFile();
+};
+
+// ----------------------------------------------------------------------------
+void TestTrackCache::roundTrip()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  auto const& path = dir.filePath(QStringLiteral("tracks.sealtk-cache"));
+  QVERIFY(writeTrackCache(path, createTracks()));
+
+  auto const& tracks = readTrackCache(path);
+  QVERIFY(tracks);
+  QCOMPARE(tracks->size(), size_t{5});
+
+  KwiverTrackModel model;
+  model.addTracks(tracks);
+  QCOMPARE(model.rowCount(), 5);
+
+  testTrackData(model, 1, data::track1);
+  testTrackData(model, 2, data::track2);
+  testTrackData(model, 3, data::track3);
+  testTrackData(model, 4, data::track4);
+  testTrackData(model, 5, data::track5);
+
+  // Test that frame numbers and notes were preserved
+  auto const& track3 = model.index(2, 0);
+  QCOMPARE(model.stateIndex(track3, 7), model.index(0, 0, track3));
+  QCOMPARE(model.data(track3, NotesRole).toStringList(),
+           (QStringList{"first"}));
+  QCOMPARE(model.data(model.index(0, 0), NotesRole).toStringList(),
+           (QStringList{"first", "second"}));
+  QCOMPARE(model.data(model.index(1, 0), NotesRole).toStringList(),
+           QStringList{});
+}
+
+// ----------------------------------------------------------------------------
+void TestTrackCache::sourceValidation()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  auto const& sourcePath = dir.filePath(QStringLiteral("tracks.csv"));
+  auto const& cachePath = trackCachePath(sourcePath);
+
+  QFile source{sourcePath};
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write("original");
+  source.close();
+
+  QVERIFY(writeTrackCache(cachePath, createTracks(), QFileInfo{sourcePath}));
+  QVERIFY(readTrackCache(cachePath, QFileInfo{sourcePath}));
+
+  // Test that the cache is rejected if the source changes
+  QVERIFY(source.open(QIODevice::Append));
+  source.write(" and modified");
+  source.close();
+
+  QVERIFY(!readTrackCache(cachePath, QFileInfo{sourcePath}));
+
+  // Test that the cache can still be read without reference to the source
+  QVERIFY(readTrackCache(cachePath));
+}
+
+// ----------------------------------------------------------------------------
+void TestTrackCache::invalidFile()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  auto const& path = dir.filePath(QStringLiteral("tracks.sealtk-cache"));
+  QVERIFY(!readTrackCache(path));
+
+  // Test that a file which is not a cache is rejected
+  QFile file{path};
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write("1,2,3,4,5,6,7,8,9,10\n");
+  file.close();
+
+  QVERIFY(!readTrackCache(path));
+
+  // Test that a truncated cache is rejected
+  QVERIFY(writeTrackCache(path, createTracks()));
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QVERIFY(file.resize(file.size() - 64));
+  file.close();
+
+  QVERIFY(!readTrackCache(path));
+}
+
+} // namespace test
+
+} // namespace core
+
+} // namespace sealtk
+
+// ----------------------------------------------------------------------------
+QTEST_MAIN(sealtk::core::test::TestTrackCache)
+#include "TrackCache.moc"
@@ -0,0 +1,162 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/core/VideoFrame.hpp>
+#include <sealtk/core/VideoMetaData.hpp>
+#include <sealtk/core/VideoProvider.hpp>
+#include <sealtk/core/VideoRequest.hpp>
+#include <sealtk/core/VideoRequestor.hpp>
+#include <sealtk/core/VideoSource.hpp>
+
+#include <QMutex>
+#include <QSemaphore>
+#include <QVector>
+
+#include <QtTest>
+
+#include <memory>
+
+namespace kv = kwiver::vital;
+
+using time_us_t = kv::timestamp::time_t;
+
+namespace sealtk
+{
+
+namespace core
+{
+
+namespace test
+{
+
+namespace // anonymous
+{
+
+// ============================================================================
+class RecordingProvider : public VideoProvider
+{
+public:
+  QVector<time_us_t> requestedTimes() const;
+
+  QSemaphore started;
+  QSemaphore proceed;
+
+protected:
+  void initialize() override {}
+
+  kv::timestamp processRequest(
+    VideoRequest&& request, kv::timestamp const& lastTime) override;
+
+private:
+  mutable QMutex mutex;
+  QVector<time_us_t> times;
+};
+
+// ============================================================================
+class RecordingVideoSource : public VideoSource
+{
+public:
+  RecordingVideoSource() : RecordingVideoSource{new RecordingProvider} {}
+  ~RecordingVideoSource() override { this->cleanup(); }
+
+  bool isReady() const override { return true; }
+  TimeMap<VideoMetaData> metaData() const override { return {}; }
+  TimeMap<kv::timestamp::frame_t> frames() const override { return {}; }
+
+  std::unique_ptr<RecordingProvider> const provider;
+
+private:
+  RecordingVideoSource(RecordingProvider* provider)
+    : VideoSource{provider}, provider{provider} {}
+};
+
+// ============================================================================
+class NullRequestor : public VideoRequestor
+{
+protected:
+  void update(VideoRequestInfo const&, VideoFrame&&) override {}
+};
+
+// ----------------------------------------------------------------------------
+QVector<time_us_t> RecordingProvider::requestedTimes() const
+{
+  QMutexLocker locker{&this->mutex};
+  return this->times;
+}
+
+// ----------------------------------------------------------------------------
+kv::timestamp RecordingProvider::processRequest(
+  VideoRequest&& request, kv::timestamp const&)
+{
+  auto first = false;
+  {
+    QMutexLocker locker{&this->mutex};
+    first = this->times.isEmpty();
+    this->times.append(request.time);
+  }
+
+  if (first)
+  {
+    // Hold up the source's thread, so that further requests accumulate
+    this->started.release();
+    this->proceed.acquire();
+  }
+
+  return {};
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class TestVideoSource : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void requestOrder();
+};
+
+// ----------------------------------------------------------------------------
+void TestVideoSource::requestOrder()
+{
+  RecordingVideoSource source;
+  source.start();
+
+  auto requestors = std::vector<std::shared_ptr<NullRequestor>>{};
+  auto const& request = [&](time_us_t time){
+    auto requestor = std::make_shared<NullRequestor>();
+    requestors.push_back(requestor);
+
+    auto r = VideoRequest{};
+    r.requestor = std::move(requestor);
+    r.time = time;
+    source.requestFrame(std::move(r));
+  };
+
+  // Issue requests from several requestors while the source is busy, in
+  // the order in which a pipeline worker with look-ahead might issue them
+  request(100);
+  QVERIFY(source.provider->started.tryAcquire(1, 5000));
+
+  request(500);
+  request(300);
+  request(700);
+  request(400);
+
+  // Test that the source processes the requests in time order, rather than
+  // in the order in which they were issued (or any other order)
+  source.provider->proceed.release();
+  QTRY_COMPARE(source.provider->requestedTimes(),
+               (QVector<time_us_t>{100, 300, 400, 500, 700}));
+}
+
+} // namespace test
+
+} // namespace core
+
+} // namespace sealtk
+
+// ----------------------------------------------------------------------------
+QTEST_MAIN(sealtk::core::test::TestVideoSource)
+#include "VideoSource.moc"
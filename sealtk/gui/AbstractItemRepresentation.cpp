@@ -355,15 +355,9 @@ bool AbstractItemRepresentation::lessThan(
 bool AbstractItemRepresentation::lessThan(
   QModelIndex const& left, QModelIndex const& right, int role) const
 {
-  if (!this->sourceModel())
-  {
-    return false;
-  }
-
   Q_ASSERT(left.column() == right.column());
 
-  auto* const sm = this->sourceModel();
-  return this->lessThan(sm->data(left, role), sm->data(right, role), role);
+  return this->sourceLessThan(left, right, role);
 }
 
 // ----------------------------------------------------------------------------
@@ -10,8 +10,12 @@
 #include <vital/range/iota.h>
 
 #include <QHash>
+#include <QSet>
+#include <QTimer>
 #include <QVector>
 
+#include <algorithm>
+
 namespace sc = sealtk::core;
 
 namespace kvr = kwiver::vital::range;
@@ -47,10 +51,28 @@ class ClassificationSummaryRepresentationPrivate
 {
 public:
   void recompute(ClassificationSummaryRepresentation* q);
+  void flush(ClassificationSummaryRepresentation* q);
+
+  QStringList contribution(int sourceRow) const;
+
+  void insertRows(int first, int last);
+  void removeRows(int first, int last);
+  void updateRows(int first, int last);
+
+  void add(QStringList const& types);
+  void subtract(QStringList const& types);
 
   QAbstractItemModel* sourceModel = nullptr;
   QVector<Record> data;
   QHash<QString, int> map;
+
+  // Types counted for each top-level row of the source model, and the
+  // resulting (possibly not yet published) count of each type
+  QVector<QStringList> contributions;
+  QHash<QString, int> counts;
+
+  QSet<QString> changedTypes;
+  QTimer updateTimer;
 };
 
 // ----------------------------------------------------------------------------
@@ -62,6 +84,16 @@ ClassificationSummaryRepresentation::ClassificationSummaryRepresentation(
   : QAbstractItemModel{parent},
     d_ptr{new ClassificationSummaryRepresentationPrivate}
 {
+  QTE_D();
+
+  // Changes to the source model are accumulated and published in batches, so
+  // that e.g. streaming many small insertions does not flood our users with
+  // notifications
+  d->updateTimer.setSingleShot(true);
+  d->updateTimer.setInterval(50);
+
+  connect(&d->updateTimer, &QTimer::timeout,
+          this, [this, d]{ d->flush(this); });
 }
 
 // ----------------------------------------------------------------------------
@@ -84,16 +116,53 @@ void ClassificationSummaryRepresentation::setSourceModel(
 
   if (d->sourceModel != sourceModel)
   {
+    if (d->sourceModel)
+    {
+      disconnect(d->sourceModel, nullptr, this, nullptr);
+    }
+
     d->sourceModel = sourceModel;
     d->recompute(this);
 
     if (sourceModel)
     {
-      auto recompute = [this, d]{ d->recompute(this); };
+      using Model = QAbstractItemModel;
 
-      connect(sourceModel, &QAbstractItemModel::rowsInserted, this, recompute);
-      connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, recompute);
-      connect(sourceModel, &QAbstractItemModel::dataChanged, this, recompute);
+      auto recompute = [this, d]{ d->recompute(this); };
+      auto schedule = [d]{ d->updateTimer.start(); };
+
+      connect(sourceModel, &Model::rowsInserted, this,
+              [d](QModelIndex const& parent, int first, int last){
+                if (!parent.isValid())
+                {
+                  d->insertRows(first, last);
+                }
+              });
+      connect(sourceModel, &Model::rowsRemoved, this,
+              [d](QModelIndex const& parent, int first, int last){
+                if (!parent.isValid())
+                {
+                  d->removeRows(first, last);
+                }
+              });
+      connect(sourceModel, &Model::dataChanged, this,
+              [d](QModelIndex const& topLeft, QModelIndex const& bottomRight,
+                  QVector<int> const& roles){
+                if (!topLeft.parent().isValid() &&
+                    (roles.isEmpty() ||
+                     roles.contains(sc::ClassificationRole) ||
+                     roles.contains(sc::VisibilityRole) ||
+                     roles.contains(sc::UserVisibilityRole)))
+                {
+                  d->updateRows(topLeft.row(), bottomRight.row());
+                }
+              });
+      connect(sourceModel, &Model::rowsInserted, this, schedule);
+      connect(sourceModel, &Model::rowsRemoved, this, schedule);
+      connect(sourceModel, &Model::dataChanged, this, schedule);
+      connect(sourceModel, &Model::rowsMoved, this, recompute);
+      connect(sourceModel, &Model::layoutChanged, this, recompute);
+      connect(sourceModel, &Model::modelReset, this, recompute);
 
       connect(sourceModel, &QObject::destroyed,
               this, [this]{ this->setSourceModel(nullptr); });
@@ -197,123 +266,246 @@ QVariant ClassificationSummaryRepresentation::headerData(
 void ClassificationSummaryRepresentationPrivate::recompute(
   ClassificationSummaryRepresentation* q)
 {
-  // Extract information from underlying model
-  auto newData = QHash<QString, Record>{};
+  // Rebuild contributions from the underlying model
+  for (auto const& c : this->contributions)
+  {
+    this->subtract(c);
+  }
+  this->contributions.clear();
 
   if (this->sourceModel)
   {
-    for (auto const row : kvr::iota(this->sourceModel->rowCount()))
+    auto const rows = this->sourceModel->rowCount();
+    if (rows > 0)
     {
-      auto const& index = this->sourceModel->index(row, 0);
+      this->insertRows(0, rows - 1);
+    }
+  }
 
-      auto const& vd = this->sourceModel->data(index, sc::VisibilityRole);
-      if (!vd.toBool())
-      {
-        continue;
-      }
+  this->flush(q);
+}
 
-      auto const& cd = this->sourceModel->data(index, sc::ClassificationRole);
-      for (auto const& c : cd.toHash() | kvr::indirect)
-      {
-        if (c.value().toDouble() > 0.0)
-        {
-          auto const& type = c.key();
-          auto& newRecord = newData[type];
-          if (newRecord.type.isEmpty())
-          {
-            newRecord.type = type;
-          }
-
-          ++newRecord.count;
-        }
-      }
+// ----------------------------------------------------------------------------
+QStringList ClassificationSummaryRepresentationPrivate::contribution(
+  int sourceRow) const
+{
+  auto const& index = this->sourceModel->index(sourceRow, 0);
+
+  auto const& vd = this->sourceModel->data(index, sc::VisibilityRole);
+  if (!vd.toBool())
+  {
+    return {};
+  }
+
+  auto types = QStringList{};
+  auto const& cd = this->sourceModel->data(index, sc::ClassificationRole);
+  for (auto const& c : cd.toHash() | kvr::indirect)
+  {
+    if (c.value().toDouble() > 0.0)
+    {
+      types.append(c.key());
     }
   }
 
-  // First, identify and remove rows with zero counts
-  if (!this->data.isEmpty())
+  return types;
+}
+
+// ----------------------------------------------------------------------------
+void ClassificationSummaryRepresentationPrivate::insertRows(
+  int first, int last)
+{
+  auto newContributions = QVector<QStringList>{};
+  newContributions.reserve(1 + last - first);
+
+  for (auto row = first; row <= last; ++row)
   {
-    auto start = decltype(this->data.size()){0};
-    auto count = decltype(start){0};
+    newContributions.append(this->contribution(row));
+    this->add(newContributions.last());
+  }
 
-    auto shuffle = [&]{
-      // Adjust map
-      for (auto& index : this->map)
-      {
-        if (index > start)
-        {
-          index -= count;
-        }
-      }
+  if (first >= this->contributions.size())
+  {
+    this->contributions.append(newContributions);
+  }
+  else
+  {
+    this->contributions.insert(first, newContributions.size(), {});
+    std::move(newContributions.begin(), newContributions.end(),
+              this->contributions.begin() + first);
+  }
+}
 
-      // Remove rows from internal data
-      q->beginRemoveRows({}, start, start + count - 1);
-      this->data.remove(start, count);
-      q->endRemoveRows();
+// ----------------------------------------------------------------------------
+void ClassificationSummaryRepresentationPrivate::removeRows(
+  int first, int last)
+{
+  last = std::min(last, this->contributions.size() - 1);
+  if (last < first)
+  {
+    return;
+  }
 
-      // Update/reset counters
-      start += count;
-      count = 0;
-    };
+  for (auto row = first; row <= last; ++row)
+  {
+    this->subtract(this->contributions[row]);
+  }
+  this->contributions.remove(first, 1 + last - first);
+}
 
-    while (start + count < this->data.size())
+// ----------------------------------------------------------------------------
+void ClassificationSummaryRepresentationPrivate::updateRows(
+  int first, int last)
+{
+  last = std::min(last, this->contributions.size() - 1);
+  for (auto row = first; row <= last; ++row)
+  {
+    auto& c = this->contributions[row];
+    auto newContribution = this->contribution(row);
+    if (newContribution != c)
+    {
+      this->subtract(c);
+      this->add(newContribution);
+      c = std::move(newContribution);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ClassificationSummaryRepresentationPrivate::add(QStringList const& types)
+{
+  for (auto const& type : types)
+  {
+    ++this->counts[type];
+    this->changedTypes.insert(type);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ClassificationSummaryRepresentationPrivate::subtract(
+  QStringList const& types)
+{
+  for (auto const& type : types)
+  {
+    auto const i = this->counts.find(type);
+    if (i != this->counts.end() && --(*i) <= 0)
+    {
+      this->counts.erase(i);
+    }
+    this->changedTypes.insert(type);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ClassificationSummaryRepresentationPrivate::flush(
+  ClassificationSummaryRepresentation* q)
+{
+  this->updateTimer.stop();
+
+  if (this->changedTypes.isEmpty())
+  {
+    return;
+  }
+
+  auto const changedTypes = std::move(this->changedTypes);
+  this->changedTypes.clear();
+
+  // First, identify and remove rows with zero counts
+  auto emptyRows = QVector<int>{};
+  for (auto const& type : changedTypes)
+  {
+    auto const row = this->map.value(type, -1);
+    if (row >= 0 && !this->counts.contains(type))
     {
-      auto const& type = this->data[start + count].type;
-      if (newData.contains(type))
+      emptyRows.append(row);
+    }
+  }
+
+  if (!emptyRows.isEmpty())
+  {
+    std::sort(emptyRows.begin(), emptyRows.end());
+
+    // Remove rows in contiguous runs, starting with the last run so that the
+    // rows of earlier runs are not disturbed
+    auto end = emptyRows.size();
+    while (end > 0)
+    {
+      auto begin = end - 1;
+      while (begin > 0 && emptyRows[begin - 1] == emptyRows[begin] - 1)
       {
-        if (count)
-        {
-          shuffle();
-        }
-        else
-        {
-          ++start;
-        }
+        --begin;
       }
-      else
+
+      auto const first = emptyRows[begin];
+      auto const last = emptyRows[end - 1];
+
+      q->beginRemoveRows({}, first, last);
+      for (auto row = first; row <= last; ++row)
       {
-        this->map.remove(type);
-        ++count;
+        this->map.remove(this->data[row].type);
       }
+      this->data.remove(first, 1 + last - first);
+      q->endRemoveRows();
+
+      end = begin;
     }
-    if (count)
+
+    // Update map
+    for (auto row = emptyRows.first(); row < this->data.size(); ++row)
     {
-      shuffle();
+      this->map[this->data[row].type] = row;
     }
   }
 
   // Merge in updates and determine what rows have changed
   auto newRecords = QVector<Record>{};
-  auto firstRow = this->data.size();
-  auto lastRow = decltype(firstRow){-1};
+  auto changedRows = QVector<int>{};
 
-  for (auto const& newRecord : newData)
+  for (auto const& type : changedTypes)
   {
-    auto const i = this->map.value(newRecord.type, -1);
+    auto const count = this->counts.value(type, 0);
+    if (count <= 0)
+    {
+      continue;
+    }
+
+    auto const i = this->map.value(type, -1);
     if (i < 0)
     {
-      newRecords.append(newRecord);
+      newRecords.append({type, count});
     }
     else
     {
       auto& oldRecord = this->data[i];
-      if (oldRecord.count != newRecord.count)
+      if (oldRecord.count != count)
       {
-        oldRecord.count = newRecord.count;
-        firstRow = std::min(firstRow, i);
-        lastRow = std::max(lastRow, i);
+        oldRecord.count = count;
+        changedRows.append(i);
       }
     }
   }
 
-  if (lastRow >= firstRow)
+  // Emit notifications for runs of changed rows
+  if (!changedRows.isEmpty())
   {
-    // Conservatively assume that everything between the first and last
-    // modified rows has changed; this shouldn't hurt our users too much, and
-    // figuring out how to emit more fine-grained notifications is a pain, on
-    // top of which the extra signal emissions may well outweigh any benefit
-    emit q->dataChanged(q->index(firstRow, CountColumn),
-                        q->index(lastRow, CountColumn));
+    std::sort(changedRows.begin(), changedRows.end());
+
+    auto first = changedRows.first();
+    auto last = first;
+    auto notify = [&]{
+      emit q->dataChanged(q->index(first, CountColumn),
+                          q->index(last, CountColumn));
+    };
+
+    for (auto const row : changedRows)
+    {
+      if (row > last + 1)
+      {
+        notify();
+        first = row;
+      }
+      last = row;
+    }
+    notify();
   }
 
   // Add new rows
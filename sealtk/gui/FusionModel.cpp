@@ -16,6 +16,9 @@
 #include <QMultiHash>
 #include <QSet>
 
+#include <algorithm>
+#include <array>
+
 namespace kv = kwiver::vital;
 namespace kvr = kwiver::vital::range;
 
@@ -28,13 +31,89 @@ namespace gui
 namespace // anonymous
 {
 
+// ============================================================================
+enum FusedValue
+{
+  FusedStartTime,
+  FusedEndTime,
+  FusedClassificationType,
+  FusedClassificationScore,
+  FusedClassification,
+  FusedNotes,
+  FusedUserVisibility,
+  FusedValueCount,
+};
+
 // ============================================================================
 struct RowData
 {
   qint64 id;
   QMultiHash<QAbstractItemModel*, int> rows;
+
+  // Memoized fused values; a value is valid if its bit in cachedValues is set
+  mutable std::array<QVariant, FusedValueCount> fusedValues;
+  mutable quint32 cachedValues = 0;
+
+  void invalidate(quint32 values = ~quint32{0}) { cachedValues &= ~values; }
 };
 
+// ----------------------------------------------------------------------------
+constexpr quint32 bit(FusedValue value)
+{
+  return quint32{1} << value;
+}
+
+// ----------------------------------------------------------------------------
+quint32 affectedValues(QVector<int> const& roles)
+{
+  if (roles.isEmpty())
+  {
+    return ~quint32{0};
+  }
+
+  auto result = quint32{0};
+  for (auto const role : roles)
+  {
+    switch (role)
+    {
+      case core::StartTimeRole:
+        result |= bit(FusedStartTime);
+        break;
+
+      case core::EndTimeRole:
+        result |= bit(FusedEndTime);
+        break;
+
+      // The best classification type and score are picked together, and
+      // both are derived from the full classification
+      case core::ClassificationRole:
+        result |= bit(FusedClassification);
+        result |= bit(FusedClassificationType);
+        result |= bit(FusedClassificationScore);
+        break;
+
+      case core::ClassificationTypeRole:
+      case core::ClassificationScoreRole:
+        result |= bit(FusedClassificationType);
+        result |= bit(FusedClassificationScore);
+        break;
+
+      case core::NotesRole:
+        result |= bit(FusedNotes);
+        break;
+
+      case core::UserVisibilityRole:
+        result |= bit(FusedUserVisibility);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  return result;
+}
+
 // ============================================================================
 template <typename T>
 struct GenericFusor
@@ -161,53 +240,6 @@ struct MergeStringLists : GenericFusor<QStringList>
   }
 };
 
-// ============================================================================
-class RowRemover
-{
-public:
-  virtual ~RowRemover() = default;
-
-  virtual void operator()(QMultiHash<QAbstractItemModel*, int>& rows,
-                          QAbstractItemModel* model) const
-  {
-    rows.remove(model);
-  }
-};
-
-// ============================================================================
-class RowRangeRemover : public RowRemover
-{
-public:
-  explicit RowRangeRemover(int first, int last) : first{first}, last{last} {}
-
-  void operator()(QMultiHash<QAbstractItemModel*, int>& rows,
-                  QAbstractItemModel* model) const override
-  {
-    auto const offset = 1 + this->last - this->first;
-
-    auto iter = rows.find(model);
-    while (iter != rows.end() && iter.key() == model)
-    {
-      auto const r = iter.value();
-      if (r >= this->first && r <= this->last)
-      {
-        iter = rows.erase(iter);
-      }
-      else
-      {
-        if (r > this->last)
-        {
-          iter.value() -= offset;
-        }
-        ++iter;
-      }
-    }
-  }
-
-protected:
-  int first, last;
-};
-
 } // namespace <anonymous>
 
 // ============================================================================
@@ -217,8 +249,9 @@ public:
   FusionModelPrivate(FusionModel* q) : q_ptr{q} {}
 
   void addModelData(QAbstractItemModel* model);
-  void removeModelData(QAbstractItemModel* model,
-                       RowRemover const& remove = {});
+  void removeModelData(QAbstractItemModel* model);
+  void removeModelRows(QAbstractItemModel* model, int firstRow, int lastRow);
+  void renumberRows(QVector<int> const& removedRows);
 
   void addModelData(QAbstractItemModel* model, int firstRow, int rowAfterLast);
   void shiftModelRows(QAbstractItemModel* model, int firstRow, int rowOffset);
@@ -227,15 +260,33 @@ public:
     QAbstractItemModel* model, QVector<int> const& roles,
     QModelIndex const& first, QModelIndex const& last);
 
+  void saveModelLayout(QAbstractItemModel* model);
+  void restoreModelLayout(QAbstractItemModel* model);
+
   template <typename Fusor>
   static QVariant fuseData(RowData const& rowData, int role);
 
+  template <typename Fusor>
+  static QVariant cachedData(
+    RowData const& rowData, int role, FusedValue value);
+
   static bool setData(RowData const& rowData, QVariant const& value, int role);
 
   QSet<QAbstractItemModel*> models;
   QHash<qint64, int> items;
   QVector<RowData> data;
 
+  // Reverse index from each source model's rows to our rows
+  QHash<QAbstractItemModel*, QVector<int>> fusedRows;
+
+  QHash<QAbstractItemModel*, QVector<QPair<int, QPersistentModelIndex>>>
+    savedLayouts;
+
+  // Row being edited by setData, and whether a source model has reported a
+  // change to it
+  int editedRow = -1;
+  bool editedRowReported = false;
+
 private:
   QTE_DECLARE_PUBLIC_PTR(FusionModel);
   QTE_DECLARE_PUBLIC(FusionModel);
@@ -283,25 +334,28 @@ QVariant FusionModel::data(QModelIndex const& index, int role) const
         return r.id;
 
       case core::StartTimeRole:
-        return d->fuseData<MinTime>(r, role);
+        return d->cachedData<MinTime>(r, role, FusedStartTime);
 
       case core::EndTimeRole:
-        return d->fuseData<MaxTime>(r, role);
+        return d->cachedData<MaxTime>(r, role, FusedEndTime);
 
       case core::ClassificationTypeRole:
-        return d->fuseData<BestClassificationType>(r, role);
+        return d->cachedData<BestClassificationType>(
+          r, role, FusedClassificationType);
 
       case core::ClassificationScoreRole:
-        return d->fuseData<BestClassificationScore>(r, role);
+        return d->cachedData<BestClassificationScore>(
+          r, role, FusedClassificationScore);
 
       case core::ClassificationRole:
-        return d->fuseData<MergeClassifications>(r, role);
+        return d->cachedData<MergeClassifications>(
+          r, role, FusedClassification);
 
       case core::NotesRole:
-        return d->fuseData<MergeStringLists>(r, role);
+        return d->cachedData<MergeStringLists>(r, role, FusedNotes);
 
       case core::UserVisibilityRole:
-        return d->fuseData<BooleanOr>(r, role);
+        return d->cachedData<BooleanOr>(r, role, FusedUserVisibility);
 
       default:
         break;
@@ -319,13 +373,31 @@ bool FusionModel::setData(
   {
     QTE_D();
 
-    auto const& r = d->data[index.row()];
+    auto const row = index.row();
+    auto& r = d->data[row];
     switch (role)
     {
       case core::ClassificationRole:
       case core::NotesRole:
       case core::UserVisibilityRole:
-        return d->setData(r, value, role);
+      {
+        d->editedRow = row;
+        d->editedRowReported = false;
+
+        auto const result = d->setData(r, value, role);
+
+        d->editedRow = -1;
+
+        // Not every source model reports every change of its data, or reports
+        // success, so always discard the affected fused values, and report the
+        // change ourselves if no source model did
+        r.invalidate(affectedValues({role}));
+        if (result && !d->editedRowReported)
+        {
+          this->emitDataChanged({}, {row}, {role});
+        }
+        return result;
+      }
 
       default:
         break;
@@ -354,25 +426,47 @@ void FusionModel::addModel(QAbstractItemModel* model)
                        QVector<int> const& roles){
               d->emitDataChanged(model, roles, first, last);
             });
+    // Our data is fused from the data of the source models' top-level rows,
+    // which may depend on their children (e.g. a track's start and end times
+    // depend on its states); changes to the children of a top-level row are
+    // therefore treated as a change to that row
     connect(model, &QAbstractItemModel::rowsInserted, this,
             [model, this](QModelIndex const& parent, int first, int last){
+              QTE_D();
               if (!parent.isValid())
               {
-                QTE_D();
                 d->shiftModelRows(model, first, 1 + last - first);
                 d->addModelData(model, first, last + 1);
               }
+              else
+              {
+                d->emitDataChanged(model, {}, parent, parent);
+              }
             });
     connect(model, &QAbstractItemModel::rowsRemoved, this,
             [model, this](QModelIndex const& parent, int first, int last){
+              QTE_D();
               if (!parent.isValid())
               {
-                QTE_D();
-
-                this->beginResetModel();
-                d->removeModelData(model, RowRangeRemover{first, last});
-                this->endResetModel();
+                d->removeModelRows(model, first, last);
               }
+              else
+              {
+                d->emitDataChanged(model, {}, parent, parent);
+              }
+            });
+    connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this,
+            [model, d]{ d->saveModelLayout(model); });
+    connect(model, &QAbstractItemModel::layoutChanged, this,
+            [model, d]{ d->restoreModelLayout(model); });
+    connect(model, &QAbstractItemModel::modelReset, this,
+            [model, this]{
+              QTE_D();
+
+              this->beginResetModel();
+              d->removeModelData(model);
+              d->addModelData(model);
+              this->endResetModel();
             });
     // TODO handle rows moved
   }
@@ -410,12 +504,18 @@ void FusionModelPrivate::addModelData(
   QHash<qint64, RowData> newData;
   QSet<int> modifiedRows;
 
+  auto& index = this->fusedRows[model];
+  if (index.size() < rowAfterLast)
+  {
+    index.insert(index.size(), rowAfterLast - index.size(), -1);
+  }
+
   // Examine rows of model
   for (auto sourceRow = firstRow; sourceRow < rowAfterLast; ++sourceRow)
   {
-    auto const& index = model->index(sourceRow, 0);
+    auto const& sourceIndex = model->index(sourceRow, 0);
     auto const iid =
-      model->data(index, core::LogicalIdentityRole).value<qint64>();
+      model->data(sourceIndex, core::LogicalIdentityRole).value<qint64>();
 
     // Find our row for this item (if any)
     auto const localRow = this->items.value(iid, -1);
@@ -438,6 +538,8 @@ void FusionModelPrivate::addModelData(
       // Update source rows of existing item
       auto& r = this->data[localRow];
       r.rows.insert(model, sourceRow);
+      r.invalidate();
+      index[sourceRow] = localRow;
       modifiedRows.insert(localRow);
     }
   }
@@ -452,7 +554,13 @@ void FusionModelPrivate::addModelData(
     this->data.reserve(newCount);
     for (auto i : newData | kvr::indirect)
     {
-      this->items.insert(i.key(), this->data.count());
+      auto const localRow = this->data.count();
+      for (auto const sourceRow : i.value().rows)
+      {
+        index[sourceRow] = localRow;
+      }
+
+      this->items.insert(i.key(), localRow);
       this->data.append(std::move(i.value()));
     }
 
@@ -469,56 +577,214 @@ void FusionModelPrivate::addModelData(
 void FusionModelPrivate::shiftModelRows(
   QAbstractItemModel* model, int firstRow, int rowOffset)
 {
-  for (auto& rd : this->data)
+  auto& index = this->fusedRows[model];
+
+  // Update the source rows of our items which follow the inserted rows; this
+  // is done last to first, so that an updated row number never collides with
+  // one which has yet to be updated
+  for (auto sourceRow = index.size() - 1; sourceRow >= firstRow; --sourceRow)
   {
-    for (auto&& i : rd.rows | kvr::indirect)
+    auto const localRow = index[sourceRow];
+    if (localRow >= 0)
     {
-      if (i.key() == model && i.value() >= firstRow)
+      auto& rows = this->data[localRow].rows;
+      auto const i = rows.find(model, sourceRow);
+      if (i != rows.end())
       {
         i.value() += rowOffset;
       }
     }
   }
+
+  index.insert(qMin(firstRow, index.size()), rowOffset, -1);
 }
 
 // ----------------------------------------------------------------------------
-void FusionModelPrivate::removeModelData(
-  QAbstractItemModel* model, RowRemover const& remove)
+void FusionModelPrivate::removeModelData(QAbstractItemModel* model)
 {
-  auto i = this->data.begin();
-  auto rows = this->data.size();
-  auto row = decltype(rows){0};
+  this->fusedRows.remove(model);
+
+  QVector<int> emptyRows;
+  for (auto const row : kvr::iota(this->data.size()))
+  {
+    auto& r = this->data[row];
+    if (r.rows.remove(model))
+    {
+      r.invalidate();
+
+      // Check if item still has any associated source rows
+      if (r.rows.isEmpty())
+      {
+        emptyRows.append(row);
+        this->items.remove(r.id);
+      }
+    }
+  }
 
-  while (row < rows)
+  if (emptyRows.isEmpty())
   {
-    // Remove model rows
-    remove(i->rows, model);
+    return;
+  }
 
-    // Check if item still has any associated source rows
-    if (!i->rows.isEmpty())
+  // Remove items which have no more source rows, compacting the remaining
+  // items while preserving their order
+  auto out = emptyRows.first();
+  for (auto row = out; row < this->data.size(); ++row)
+  {
+    if (!this->data[row].rows.isEmpty())
     {
-      // It does; move on to the next
-      ++i;
-      ++row;
+      if (out != row)
+      {
+        this->data[out] = std::move(this->data[row]);
+      }
+      ++out;
     }
-    else
+  }
+  this->data.resize(out);
+
+  this->renumberRows(emptyRows);
+}
+
+// ----------------------------------------------------------------------------
+void FusionModelPrivate::removeModelRows(
+  QAbstractItemModel* model, int firstRow, int lastRow)
+{
+  auto& index = this->fusedRows[model];
+  auto const count = 1 + lastRow - firstRow;
+  lastRow = qMin(lastRow, index.size() - 1);
+
+  // Detach the removed source rows from our items...
+  QVector<int> affectedRows;
+  for (auto sourceRow = firstRow; sourceRow <= lastRow; ++sourceRow)
+  {
+    auto const localRow = index[sourceRow];
+    if (localRow >= 0)
     {
-      // Item has no more source rows; remove it
-      this->items.remove(i->id);
+      auto& r = this->data[localRow];
+      r.rows.remove(model, sourceRow);
+      r.invalidate();
+      affectedRows.append(localRow);
+    }
+  }
 
-      if (row == --rows)
+  // ...and update the source rows of our items which follow them
+  for (auto sourceRow = lastRow + 1; sourceRow < index.size(); ++sourceRow)
+  {
+    auto const localRow = index[sourceRow];
+    if (localRow >= 0)
+    {
+      auto& rows = this->data[localRow].rows;
+      auto const i = rows.find(model, sourceRow);
+      if (i != rows.end())
       {
-        this->data.erase(i);
-        break; // This was the last item, so we must be done
+        i.value() -= count;
       }
-      else
+    }
+  }
+
+  if (lastRow >= firstRow)
+  {
+    index.remove(firstRow, 1 + lastRow - firstRow);
+  }
+
+  std::sort(affectedRows.begin(), affectedRows.end());
+  affectedRows.erase(std::unique(affectedRows.begin(), affectedRows.end()),
+                     affectedRows.end());
+
+  QList<int> modifiedRows;
+  QVector<int> emptyRows;
+  for (auto const row : affectedRows)
+  {
+    if (this->data[row].rows.isEmpty())
+    {
+      emptyRows.append(row);
+    }
+    else
+    {
+      modifiedRows.append(row);
+    }
+  }
+
+  QTE_Q();
+
+  // Report items which lost some, but not all, of their source rows
+  if (!modifiedRows.isEmpty())
+  {
+    q->emitDataChanged({}, std::move(modifiedRows));
+  }
+
+  if (emptyRows.isEmpty())
+  {
+    return;
+  }
+
+  // Remove items which have no more source rows, in contiguous runs, starting
+  // with the last run so that the rows of earlier runs are not disturbed
+  auto end = emptyRows.size();
+  while (end > 0)
+  {
+    auto begin = end - 1;
+    while (begin > 0 && emptyRows[begin - 1] == emptyRows[begin] - 1)
+    {
+      --begin;
+    }
+
+    auto const first = emptyRows[begin];
+    auto const last = emptyRows[end - 1];
+
+    q->beginRemoveRows({}, first, last);
+    for (auto row = first; row <= last; ++row)
+    {
+      this->items.remove(this->data[row].id);
+    }
+    this->data.remove(first, 1 + last - first);
+    q->endRemoveRows();
+
+    end = begin;
+  }
+
+  this->renumberRows(emptyRows);
+}
+
+// ----------------------------------------------------------------------------
+void FusionModelPrivate::renumberRows(QVector<int> const& removedRows)
+{
+  // Compute where each of our old rows went
+  auto const oldCount = this->data.size() + removedRows.size();
+  auto newRows = QVector<int>(oldCount);
+  auto next = removedRows.begin();
+  auto removed = 0;
+
+  for (auto const row : kvr::iota(oldCount))
+  {
+    if (next != removedRows.end() && *next == row)
+    {
+      newRows[row] = -1;
+      ++removed;
+      ++next;
+    }
+    else
+    {
+      newRows[row] = row - removed;
+    }
+  }
+
+  // Update the reverse indices and our item map
+  for (auto& index : this->fusedRows)
+  {
+    for (auto& localRow : index)
+    {
+      if (localRow >= 0)
       {
-        // Replace with last item and update map
-        *i = this->data.takeLast();
-        this->items[i->id] = row;
+        localRow = newRows[localRow];
       }
     }
   }
+
+  for (auto row = removedRows.first(); row < this->data.size(); ++row)
+  {
+    this->items[this->data[row].id] = row;
+  }
 }
 
 // ----------------------------------------------------------------------------
@@ -526,26 +792,38 @@ void FusionModelPrivate::emitDataChanged(
   QAbstractItemModel* model, QVector<int> const& roles,
   QModelIndex const& first, QModelIndex const& last)
 {
-  if (first.parent().isValid() || last.parent().isValid())
+  auto firstRow = first.row();
+  auto lastRow = last.row();
+
+  // A change to the children of a top-level row is a change to that row
+  auto const& parent = first.parent();
+  if (parent.isValid())
   {
-    return;
+    if (parent.parent().isValid())
+    {
+      return;
+    }
+
+    firstRow = lastRow = parent.row();
   }
 
-  auto const firstRow = first.row();
-  auto const lastRow = last.row();
+  auto const& index = this->fusedRows.value(model);
+  auto const affected = affectedValues(roles);
   auto modifiedRows = QSet<int>{};
 
   for (auto sourceRow = firstRow; sourceRow <= lastRow; ++sourceRow)
   {
-    auto const& index = model->index(sourceRow, 0);
-    auto const iid =
-      model->data(index, core::LogicalIdentityRole).value<qint64>();
-
     // Find our row for this item (if any)
-    auto const localRow = this->items.value(iid, -1);
+    auto const localRow = index.value(sourceRow, -1);
     if (localRow >= 0)
     {
+      this->data[localRow].invalidate(affected);
       modifiedRows.insert(localRow);
+
+      if (localRow == this->editedRow)
+      {
+        this->editedRowReported = true;
+      }
     }
   }
 
@@ -556,6 +834,52 @@ void FusionModelPrivate::emitDataChanged(
   }
 }
 
+// ----------------------------------------------------------------------------
+void FusionModelPrivate::saveModelLayout(QAbstractItemModel* model)
+{
+  // Record persistent indices for all of the model's rows that we reference,
+  // so that we can learn where they went after the layout change
+  auto& layout = this->savedLayouts[model];
+  layout.clear();
+
+  auto const& index = this->fusedRows.value(model);
+  for (auto const sourceRow : kvr::iota(index.size()))
+  {
+    auto const localRow = index[sourceRow];
+    if (localRow >= 0)
+    {
+      layout.append({localRow, model->index(sourceRow, 0)});
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void FusionModelPrivate::restoreModelLayout(QAbstractItemModel* model)
+{
+  auto const& layout = this->savedLayouts.take(model);
+
+  // Remove old source rows...
+  for (auto const& i : layout)
+  {
+    this->data[i.first].rows.remove(model);
+  }
+
+  // ...and add the new ones; since our own rows depend only on the source
+  // models' items, and not on their order, our layout does not change
+  auto& index = this->fusedRows[model];
+  index.fill(-1, model->rowCount());
+
+  for (auto const& i : layout)
+  {
+    if (i.second.isValid())
+    {
+      auto const sourceRow = i.second.row();
+      this->data[i.first].rows.insert(model, sourceRow);
+      index[sourceRow] = i.first;
+    }
+  }
+}
+
 // ----------------------------------------------------------------------------
 template <typename Fusor>
 QVariant FusionModelPrivate::fuseData(RowData const& rowData, int role)
@@ -585,6 +909,21 @@ QVariant FusionModelPrivate::fuseData(RowData const& rowData, int role)
   return Fusor::convertResult(result);
 }
 
+// ----------------------------------------------------------------------------
+template <typename Fusor>
+QVariant FusionModelPrivate::cachedData(
+  RowData const& rowData, int role, FusedValue value)
+{
+  auto& result = rowData.fusedValues[value];
+  if (!(rowData.cachedValues & bit(value)))
+  {
+    result = fuseData<Fusor>(rowData, role);
+    rowData.cachedValues |= bit(value);
+  }
+
+  return result;
+}
+
 // ----------------------------------------------------------------------------
 bool FusionModelPrivate::setData(
   RowData const& rowData, QVariant const& value, int role)
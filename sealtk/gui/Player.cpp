@@ -10,6 +10,7 @@
 #include <sealtk/core/AutoLevelsTask.hpp>
 #include <sealtk/core/DataModelTypes.hpp>
 #include <sealtk/core/ImageUtils.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
 #include <sealtk/core/ScalarFilterModel.hpp>
 
 #include <sealtk/util/unique.hpp>
@@ -196,8 +197,11 @@ public:
   void updateDetectedObjectVertexBuffers();
   void updateDetections();
 
+  QVector<int> candidateTracks(core::ScalarFilterModel& model) const;
+  QVector<int> candidateStates(core::ScalarFilterModel& model,
+                               QModelIndex const& parent) const;
   QSet<qint64> addDetectionVertices(
-    QAbstractItemModel& model, kv::transform_2d_sptr const& transform,
+    core::ScalarFilterModel& model, kv::transform_2d_sptr const& transform,
     QMatrix4x4 const& inverseTransform, QSet<qint64> const& idsToIgnore);
 
   void connectDetectionSource(QAbstractItemModel* source);
@@ -1265,9 +1269,94 @@ void PlayerPrivate::updateDetectedObjectVertexBuffers()
   this->detectedObjectVertexBuffer.release();
 }
 
+// ----------------------------------------------------------------------------
+QVector<int> PlayerPrivate::candidateTracks(
+  core::ScalarFilterModel& model) const
+{
+  QVector<int> rows;
+
+  // If the source model can tell us which tracks are active at the current
+  // time, only those need to be examined; otherwise, examine all tracks
+  auto* const trackModel =
+    qobject_cast<core::KwiverTrackModel*>(model.sourceModel());
+  if (trackModel && this->timeStamp.has_valid_time())
+  {
+    auto const t = this->timeStamp.get_time_usec();
+    for (auto const sourceRow : trackModel->activeTracks(t))
+    {
+      auto const& index = model.mapFromSource(trackModel->index(sourceRow, 0));
+      if (index.isValid())
+      {
+        rows.append(index.row());
+      }
+    }
+  }
+  else
+  {
+    auto const count = model.rowCount();
+    rows.reserve(count);
+    for (auto const row : kvr::iota(count))
+    {
+      rows.append(row);
+    }
+  }
+
+  return rows;
+}
+
+// ----------------------------------------------------------------------------
+QVector<int> PlayerPrivate::candidateStates(
+  core::ScalarFilterModel& model, QModelIndex const& parent) const
+{
+  QVector<int> rows;
+
+  // If the source model can look up states by time, only the states at the
+  // current time need to be examined; otherwise, examine all states
+  auto* const trackModel =
+    qobject_cast<core::KwiverTrackModel*>(model.sourceModel());
+  if (trackModel && this->timeStamp.has_valid_time())
+  {
+    auto const t = this->timeStamp.get_time_usec();
+    auto const& sourceParent = model.mapToSource(parent);
+    auto const& first = trackModel->stateIndexAtTime(sourceParent, t);
+    if (first.isValid())
+    {
+      auto const count = trackModel->rowCount(sourceParent);
+      for (auto sourceRow = first.row(); sourceRow < count; ++sourceRow)
+      {
+        auto const& sourceIndex =
+          trackModel->index(sourceRow, 0, sourceParent);
+        auto const& time =
+          trackModel->data(sourceIndex, core::StartTimeRole);
+        if (time.value<kv::timestamp::time_t>() != t)
+        {
+          break;
+        }
+
+        auto const& index = model.mapFromSource(sourceIndex);
+        if (index.isValid())
+        {
+          rows.append(index.row());
+        }
+      }
+    }
+  }
+  else
+  {
+    auto const count = model.rowCount(parent);
+    rows.reserve(count);
+    for (auto const row : kvr::iota(count))
+    {
+      rows.append(row);
+    }
+  }
+
+  return rows;
+}
+
 // ----------------------------------------------------------------------------
 QSet<qint64> PlayerPrivate::addDetectionVertices(
-  QAbstractItemModel& model, kv::transform_2d_sptr const& transform,
+  core::ScalarFilterModel& model, kv::transform_2d_sptr const& transform,
   QMatrix4x4 const& inverseTransform, QSet<qint64> const& idsToIgnore)
 {
   auto& vertexData = this->detectedObjectVertexData;
@@ -1276,7 +1365,7 @@ QSet<qint64> PlayerPrivate::addDetectionVertices(
   QSet<qint64> idsUsed;
 
   // Get bounding boxes of all "active" detected objects
-  for (auto const parentRow : kvr::iota(model.rowCount()))
+  for (auto const parentRow : this->candidateTracks(model))
   {
     auto const first = vertexData.count() / tupleSize;
 
@@ -1292,8 +1381,7 @@ QSet<qint64> PlayerPrivate::addDetectionVertices(
       continue;
     }
 
-    auto const childRows = model.rowCount(parentIndex);
-    for (auto const childRow : kvr::iota(childRows))
+    for (auto const childRow : this->candidateStates(model, parentIndex))
     {
       auto const& childIndex =
         model.index(childRow, 0, parentIndex);
@@ -1472,6 +1560,7 @@ void PlayerPrivate::connectDetectionSource(QAbstractItemModel* source)
   QObject::connect(source, &QAbstractItemModel::rowsMoved,    q, slot);
   QObject::connect(source, &QAbstractItemModel::dataChanged,  q, slot);
   QObject::connect(source, &QAbstractItemModel::modelReset,   q, slot);
+  QObject::connect(source, &QAbstractItemModel::layoutChanged, q, slot);
 }
 
 // ----------------------------------------------------------------------------
@@ -6,7 +6,10 @@
 
 #include <sealtk/core/AbstractItemModel.hpp>
 #include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/TrackUtils.hpp>
 
+#include <vital/types/object_track_set.h>
 #include <vital/types/timestamp.h>
 
 #include <vital/range/iota.h>
@@ -119,6 +122,33 @@ TestRepresentation::TestRepresentation(QObject* parent)
   });
 }
 
+// ============================================================================
+class TestTrackRepresentation : public AbstractItemRepresentation
+{
+public:
+  TestTrackRepresentation()
+  {
+    this->setColumnRoles({core::NameRole, core::ClassificationTypeRole});
+  }
+};
+
+// ----------------------------------------------------------------------------
+kv::track_state_sptr createState(kv::frame_id_t frame, QString const& type)
+{
+  auto detection = core::createDetection({0.0, 0.0, 1.0, 1.0}, {{type, 0.5}});
+  return core::createTrackState(frame, frame * 100, std::move(detection));
+}
+
+// ----------------------------------------------------------------------------
+kv::track_sptr createTrack(kv::track_id_t id, QString const& type)
+{
+  auto track = kv::track::create();
+  track->set_id(id);
+  track->append(createState(1, type));
+
+  return track;
+}
+
 } // namespace <anonymous>
 
 // ============================================================================
@@ -133,6 +163,8 @@ private slots:
   void displayData_data();
   void tooltipData();
   void tooltipData_data();
+  void sorting();
+  void sortingTracks();
 
 private:
   QAbstractItemModel* model;
@@ -245,6 +277,80 @@ void TestAbstractItemRepresentation::tooltipData_data()
     << 2 << OmitHidden << QStringList{};
 }
 
+// ----------------------------------------------------------------------------
+void TestAbstractItemRepresentation::sorting()
+{
+  auto const names = [this]{
+    auto result = QStringList{};
+    for (auto const row : kvr::iota(this->representation->rowCount()))
+    {
+      auto const& index = this->representation->index(row, 0);
+      result.append(
+        this->representation->data(index, Qt::DisplayRole).toString());
+    }
+    return result;
+  };
+
+  this->representation->setItemVisibilityMode(ShadowHidden);
+
+  this->representation->sort(0, Qt::AscendingOrder);
+  QCOMPARE(names(), (QStringList{"Cow", "Emu", "Pig"}));
+
+  this->representation->sort(0, Qt::DescendingOrder);
+  QCOMPARE(names(), (QStringList{"Pig", "Emu", "Cow"}));
+
+  this->representation->sort(-1);
+  QCOMPARE(names(), (QStringList{"Pig", "Cow", "Emu"}));
+}
+
+// ----------------------------------------------------------------------------
+void TestAbstractItemRepresentation::sortingTracks()
+{
+  core::KwiverTrackModel model;
+  model.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(10, QStringLiteral("Eel")),
+        createTrack(2, QStringLiteral("Cod")),
+        createTrack(33, QStringLiteral("Dab")),
+      }));
+
+  TestTrackRepresentation representation;
+  representation.setSourceModel(&model);
+
+  auto const column = [&representation](int column){
+    auto result = QStringList{};
+    for (auto const row : kvr::iota(representation.rowCount()))
+    {
+      auto const& index = representation.index(row, column);
+      result.append(representation.data(index, Qt::DisplayRole).toString());
+    }
+    return result;
+  };
+
+  // Test that numeric names are sorted numerically
+  representation.sort(0, Qt::AscendingOrder);
+  QCOMPARE(column(0), (QStringList{"2", "10", "33"}));
+
+  representation.sort(1, Qt::AscendingOrder);
+  QCOMPARE(column(1), (QStringList{"Cod", "Dab", "Eel"}));
+
+  // Test that adding a state to a track, which changes the track's
+  // classification, discards the track's cached sort key
+  model.updateTrack(model.index(0, 0), createState(2, QStringLiteral("Ant")));
+  representation.invalidate();
+  QCOMPARE(column(1), (QStringList{"Ant", "Cod", "Dab"}));
+  QCOMPARE(column(0), (QStringList{"10", "2", "33"}));
+
+  // Test that reclassifying a track, which is reported as a change of only
+  // its complete classification, discards the track's cached sort key
+  QVERIFY(model.setData(model.index(1, 0), QVariantHash{{"Fox", 0.9}},
+                        core::ClassificationRole));
+  representation.invalidate();
+  QCOMPARE(column(1), (QStringList{"Ant", "Dab", "Fox"}));
+  QCOMPARE(column(0), (QStringList{"10", "33", "2"}));
+}
+
 // ----------------------------------------------------------------------------
 void TestAbstractItemRepresentation::testData(int role)
 {
@@ -0,0 +1,243 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/gui/ClassificationSummaryRepresentation.hpp>
+
+#include <sealtk/core/DataModelTypes.hpp>
+
+#include <vital/range/iota.h>
+
+#include <QHash>
+#include <QStandardItemModel>
+
+#include <QtTest>
+
+namespace kvr = kwiver::vital::range;
+
+namespace sealtk
+{
+
+namespace gui
+{
+
+namespace test
+{
+
+namespace // anonymous
+{
+
+using Summary = QHash<QString, int>;
+
+// ----------------------------------------------------------------------------
+QStandardItem* createItem(QString const& type, bool visible = true)
+{
+  auto* const item = new QStandardItem;
+  item->setData(QVariantHash{{type, 0.9}}, core::ClassificationRole);
+  item->setData(visible, core::VisibilityRole);
+
+  return item;
+}
+
+// ----------------------------------------------------------------------------
+Summary summary(QAbstractItemModel const& model)
+{
+  auto result = Summary{};
+  for (auto const row : kvr::iota(model.rowCount()))
+  {
+    auto const& type = model.data(model.index(row, 0), Qt::DisplayRole);
+    auto const& count = model.data(model.index(row, 1), Qt::DisplayRole);
+    result.insert(type.toString(), count.toInt());
+  }
+
+  return result;
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class TestClassificationSummaryRepresentation : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initialState();
+  void insertion();
+  void removal();
+  void dataChange();
+  void changeRuns();
+};
+
+// ----------------------------------------------------------------------------
+void TestClassificationSummaryRepresentation::initialState()
+{
+  QStandardItemModel source;
+  source.appendRow(createItem(QStringLiteral("Dab")));
+  source.appendRow(createItem(QStringLiteral("Dab")));
+  source.appendRow(createItem(QStringLiteral("Eel")));
+  source.appendRow(createItem(QStringLiteral("Ray"), false));
+
+  // Test that the summary is computed immediately when the source is set
+  ClassificationSummaryRepresentation csr;
+  csr.setSourceModel(&source);
+
+  QCOMPARE(summary(csr), (Summary{{"Dab", 2}, {"Eel", 1}}));
+}
+
+// ----------------------------------------------------------------------------
+void TestClassificationSummaryRepresentation::insertion()
+{
+  QStandardItemModel source;
+  source.appendRow(createItem(QStringLiteral("Dab")));
+
+  ClassificationSummaryRepresentation csr;
+  csr.setSourceModel(&source);
+
+  QSignalSpy insertedSpy{&csr, &QAbstractItemModel::rowsInserted};
+  QSignalSpy changedSpy{&csr, &QAbstractItemModel::dataChanged};
+
+  // Test that insertions are not published immediately...
+  for (auto const i : kvr::iota(10))
+  {
+    source.appendRow(createItem(QStringLiteral("Dab")));
+    source.appendRow(createItem(i % 2 ? QStringLiteral("Eel")
+                                      : QStringLiteral("Ray")));
+  }
+
+  QCOMPARE(insertedSpy.count(), 0);
+  QCOMPARE(changedSpy.count(), 0);
+  QCOMPARE(summary(csr), (Summary{{"Dab", 1}}));
+
+  // ...but are published, coalesced, once the source model settles
+  QVERIFY(insertedSpy.wait());
+  QCOMPARE(summary(csr), (Summary{{"Dab", 11}, {"Eel", 5}, {"Ray", 5}}));
+  QCOMPARE(insertedSpy.count(), 1);
+  QCOMPARE(insertedSpy.first()[1].toInt(), 1);
+  QCOMPARE(insertedSpy.first()[2].toInt(), 2);
+  QCOMPARE(changedSpy.count(), 1);
+}
+
+// ----------------------------------------------------------------------------
+void TestClassificationSummaryRepresentation::removal()
+{
+  QStandardItemModel source;
+  source.appendRow(createItem(QStringLiteral("Dab")));
+  source.appendRow(createItem(QStringLiteral("Eel")));
+  source.appendRow(createItem(QStringLiteral("Dab")));
+  source.appendRow(createItem(QStringLiteral("Eel")));
+
+  ClassificationSummaryRepresentation csr;
+  csr.setSourceModel(&source);
+
+  QSignalSpy removedSpy{&csr, &QAbstractItemModel::rowsRemoved};
+  QSignalSpy changedSpy{&csr, &QAbstractItemModel::dataChanged};
+
+  // Test that removing some instances of a type changes its count
+  source.removeRow(2);
+  QVERIFY(changedSpy.wait());
+  QCOMPARE(summary(csr), (Summary{{"Dab", 1}, {"Eel", 2}}));
+  QCOMPARE(removedSpy.count(), 0);
+
+  // Test that removing every instance of a type removes it
+  source.removeRows(1, 2);
+  QVERIFY(removedSpy.wait());
+  QCOMPARE(summary(csr), (Summary{{"Dab", 1}}));
+  QCOMPARE(removedSpy.count(), 1);
+
+  source.removeRow(0);
+  QVERIFY(removedSpy.wait());
+  QCOMPARE(summary(csr), (Summary{}));
+}
+
+// ----------------------------------------------------------------------------
+void TestClassificationSummaryRepresentation::dataChange()
+{
+  QStandardItemModel source;
+  source.appendRow(createItem(QStringLiteral("Dab")));
+  source.appendRow(createItem(QStringLiteral("Dab")));
+
+  ClassificationSummaryRepresentation csr;
+  csr.setSourceModel(&source);
+
+  QSignalSpy insertedSpy{&csr, &QAbstractItemModel::rowsInserted};
+  QSignalSpy removedSpy{&csr, &QAbstractItemModel::rowsRemoved};
+  QSignalSpy changedSpy{&csr, &QAbstractItemModel::dataChanged};
+
+  // Test that reclassifying an item moves its contribution
+  source.item(1)->setData(QVariantHash{{QStringLiteral("Eel"), 0.7}},
+                          core::ClassificationRole);
+  QVERIFY(insertedSpy.wait());
+  QCOMPARE(summary(csr), (Summary{{"Dab", 1}, {"Eel", 1}}));
+  QCOMPARE(changedSpy.count(), 1);
+
+  // Test that hiding an item removes its contribution
+  source.item(0)->setData(false, core::VisibilityRole);
+  QVERIFY(removedSpy.wait());
+  QCOMPARE(summary(csr), (Summary{{"Eel", 1}}));
+
+  // Test that changes to unrelated data are ignored
+  changedSpy.clear();
+  source.item(1)->setData(QStringLiteral("Fish"), Qt::DisplayRole);
+  QVERIFY(!changedSpy.wait(200));
+  QCOMPARE(summary(csr), (Summary{{"Eel", 1}}));
+}
+
+// ----------------------------------------------------------------------------
+void TestClassificationSummaryRepresentation::changeRuns()
+{
+  auto const types = QStringList{
+    QStringLiteral("Dab"), QStringLiteral("Eel"), QStringLiteral("Ray"),
+  };
+
+  QStandardItemModel source;
+
+  ClassificationSummaryRepresentation csr;
+  csr.setSourceModel(&source);
+
+  // Add types one at a time, so that the order of the summary is known
+  QSignalSpy insertedSpy{&csr, &QAbstractItemModel::rowsInserted};
+  for (auto const& type : types)
+  {
+    source.appendRow(createItem(type));
+    QVERIFY(insertedSpy.wait());
+  }
+
+  for (auto const row : kvr::iota(types.count()))
+  {
+    QCOMPARE(csr.data(csr.index(row, 0), Qt::DisplayRole).toString(),
+             types[row]);
+  }
+
+  QSignalSpy changedSpy{&csr, &QAbstractItemModel::dataChanged};
+
+  // Test that changes to adjacent rows are reported as a single run
+  source.appendRow(createItem(types[0]));
+  source.appendRow(createItem(types[1]));
+  QVERIFY(changedSpy.wait());
+  QCOMPARE(changedSpy.count(), 1);
+  QCOMPARE(changedSpy.first()[0].toModelIndex().row(), 0);
+  QCOMPARE(changedSpy.first()[1].toModelIndex().row(), 1);
+
+  // Test that changes to separated rows are reported as separate runs
+  changedSpy.clear();
+  source.appendRow(createItem(types[0]));
+  source.appendRow(createItem(types[2]));
+  QVERIFY(changedSpy.wait());
+  QCOMPARE(changedSpy.count(), 2);
+  QCOMPARE(changedSpy[0][0].toModelIndex().row(), 0);
+  QCOMPARE(changedSpy[0][1].toModelIndex().row(), 0);
+  QCOMPARE(changedSpy[1][0].toModelIndex().row(), 2);
+  QCOMPARE(changedSpy[1][1].toModelIndex().row(), 2);
+
+  QCOMPARE(summary(csr), (Summary{{"Dab", 3}, {"Eel", 2}, {"Ray", 2}}));
+}
+
+} // namespace test
+
+} // namespace gui
+
+} // namespace sealtk
+
+// ----------------------------------------------------------------------------
+QTEST_MAIN(sealtk::gui::test::TestClassificationSummaryRepresentation)
+#include "ClassificationSummaryRepresentation.moc"
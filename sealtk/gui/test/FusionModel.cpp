@@ -6,6 +6,10 @@
 
 #include <sealtk/core/AbstractItemModel.hpp>
 #include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/TrackUtils.hpp>
+
+#include <vital/types/object_track_set.h>
 
 #include <vital/types/timestamp.h>
 
@@ -15,6 +19,9 @@
 
 #include <QtTest>
 
+#include <algorithm>
+
+namespace kv = kwiver::vital;
 namespace kvr = kwiver::vital::range;
 
 using time_us_t = kwiver::vital::timestamp::time_t;
@@ -148,6 +155,32 @@ public:
     this->endRemoveRows();
   }
 
+  void setVisible(int i, bool visible)
+  {
+    this->rowData[i].visible = visible;
+
+    auto const& index = this->index(i, 0);
+    emit this->dataChanged(index, index, {sealtk::core::UserVisibilityRole});
+  }
+
+  void reverseRows()
+  {
+    emit this->layoutAboutToBeChanged();
+
+    std::reverse(this->rowData.begin(), this->rowData.end());
+
+    auto const last = this->rowData.count() - 1;
+    auto const& oldIndices = this->persistentIndexList();
+    auto newIndices = QModelIndexList{};
+    for (auto const& index : oldIndices)
+    {
+      newIndices.append(this->index(last - index.row(), index.column()));
+    }
+    this->changePersistentIndexList(oldIndices, newIndices);
+
+    emit this->layoutChanged();
+  }
+
 protected:
   using TestModelBase::data;
 
@@ -202,6 +235,24 @@ void testModelData(
   QFAIL(qPrintable(QStringLiteral("Did not find id %1 in model").arg(id)));
 }
 
+// ----------------------------------------------------------------------------
+kv::track_state_sptr createState(kv::frame_id_t frame, time_us_t time)
+{
+  return core::createTrackState(
+    frame, time, core::createDetection({0.0, 0.0, 1.0, 1.0}));
+}
+
+// ----------------------------------------------------------------------------
+kv::track_sptr createTrack(kv::track_id_t id, time_us_t start, time_us_t end)
+{
+  auto track = kv::track::create();
+  track->set_id(id);
+  track->append(createState(1, start));
+  track->append(createState(2, end));
+
+  return track;
+}
+
 } // namespace <anonymous>
 
 // ============================================================================
@@ -212,6 +263,10 @@ class TestFusionModel : public QObject
 private slots:
   void operations();
   void mutatingModel();
+  void layoutChange();
+  void dataChange();
+  void incrementalRemoval();
+  void trackChanges();
 };
 
 // ----------------------------------------------------------------------------
@@ -300,6 +355,208 @@ void TestFusionModel::mutatingModel()
   testModelData(fm, 5, 20, 70, false);
 }
 
+// ----------------------------------------------------------------------------
+void TestFusionModel::layoutChange()
+{
+  TestModel dmc{data3};
+  TestMutatingModel dmm;
+
+  FusionModel fm;
+  fm.addModel(&dmc);
+  fm.addModel(&dmm);
+
+  dmm.insertRow(0, data1[0]);
+  dmm.insertRow(1, data1[1]);
+  dmm.insertRow(2, data1[2]);
+
+  QCOMPARE(fm.rowCount(), 5);
+
+  // Test state after reordering the mutating model's rows
+  dmm.reverseRows();
+
+  QCOMPARE(fm.rowCount(), 5);
+  testModelData(fm, 1, 50, 50, true);
+  testModelData(fm, 2, 10, 80, true);
+  testModelData(fm, 3, 70, 80, false);
+  testModelData(fm, 4, 30, 80, false);
+  testModelData(fm, 5, 20, 70, false);
+
+  // Test that rows are still tracked correctly after the reordering; the
+  // first row is now the one for item 3
+  dmm.removeRow(0);
+
+  QCOMPARE(fm.rowCount(), 4);
+  testModelData(fm, 1, 50, 50, true);
+  testModelData(fm, 2, 10, 80, true);
+  testModelData(fm, 4, 30, 80, false);
+  testModelData(fm, 5, 20, 70, false);
+}
+
+// ----------------------------------------------------------------------------
+void TestFusionModel::dataChange()
+{
+  TestModel dmc{data3};
+  TestMutatingModel dmm;
+
+  FusionModel fm;
+  fm.addModel(&dmc);
+  fm.addModel(&dmm);
+
+  dmm.insertRow(0, data1[0]);
+  dmm.insertRow(1, data1[1]);
+  dmm.insertRow(2, data1[2]);
+
+  // Test initial state
+  testModelData(fm, 1, 50, 50, true);
+  testModelData(fm, 3, 70, 80, false);
+
+  // Test that fused data reflects changes in a source model
+  dmm.setVisible(0, false);
+  dmm.setVisible(2, true);
+
+  testModelData(fm, 1, 50, 50, false);
+  testModelData(fm, 2, 10, 80, true);
+  testModelData(fm, 3, 70, 80, true);
+
+  // Test that fused data reflects the loss of a contributing row
+  dmm.setVisible(1, false);
+  testModelData(fm, 2, 10, 80, true);
+
+  dmm.removeRow(1);
+  testModelData(fm, 2, 40, 50, true);
+}
+
+// ----------------------------------------------------------------------------
+void TestFusionModel::incrementalRemoval()
+{
+  using sealtk::core::LogicalIdentityRole;
+
+  TestModel dmc{data3};
+  TestMutatingModel dmm;
+
+  FusionModel fm;
+  fm.addModel(&dmc);
+  fm.addModel(&dmm);
+
+  dmm.insertRow(0, data1[0]);
+  dmm.insertRow(1, data1[1]);
+  dmm.insertRow(2, data1[2]);
+
+  auto const ids = [&fm]{
+    auto result = QVector<qint64>{};
+    for (auto const row : kvr::iota(fm.rowCount()))
+    {
+      auto const& index = fm.index(row, 0);
+      result.append(fm.data(index, LogicalIdentityRole).value<qint64>());
+    }
+    return result;
+  };
+
+  QSignalSpy resetSpy{&fm, &QAbstractItemModel::modelReset};
+  QSignalSpy removedSpy{&fm, &QAbstractItemModel::rowsRemoved};
+  QSignalSpy changedSpy{&fm, &QAbstractItemModel::dataChanged};
+
+  // Test that removing a "unique" row removes only that row, and does not
+  // change the order of the remaining rows
+  auto expectedIds = ids();
+  auto const removedRow = expectedIds.indexOf(1);
+  expectedIds.remove(removedRow);
+
+  dmm.removeRow(0);
+
+  QCOMPARE(resetSpy.count(), 0);
+  QCOMPARE(removedSpy.count(), 1);
+  QCOMPARE(removedSpy.first()[1].toInt(), removedRow);
+  QCOMPARE(removedSpy.first()[2].toInt(), removedRow);
+  QCOMPARE(changedSpy.count(), 0);
+  QCOMPARE(ids(), expectedIds);
+
+  // Test that removing a "common" row only changes the data of that row
+  removedSpy.clear();
+  auto const changedRow = expectedIds.indexOf(2);
+
+  dmm.removeRow(0);
+
+  QCOMPARE(resetSpy.count(), 0);
+  QCOMPARE(removedSpy.count(), 0);
+  QCOMPARE(changedSpy.count(), 1);
+  QCOMPARE(changedSpy.first()[0].toModelIndex().row(), changedRow);
+  QCOMPARE(ids(), expectedIds);
+  testModelData(fm, 2, 40, 50, true);
+}
+
+// ----------------------------------------------------------------------------
+void TestFusionModel::trackChanges()
+{
+  using sealtk::core::LogicalIdentityRole;
+  using sealtk::core::NotesRole;
+
+  core::KwiverTrackModel tm;
+  tm.addTracks(
+    std::make_shared<kv::object_track_set>(
+      std::vector<kv::track_sptr>{
+        createTrack(1, 100, 200),
+        createTrack(2, 300, 400),
+      }));
+
+  FusionModel fm;
+  fm.addModel(&tm);
+
+  testModelData(fm, 1, 100, 200, true);
+  testModelData(fm, 2, 300, 400, true);
+
+  auto const fusedRow = [&fm](qint64 id){
+    for (auto const row : kvr::iota(fm.rowCount()))
+    {
+      auto const& index = fm.index(row, 0);
+      if (fm.data(index, LogicalIdentityRole).value<qint64>() == id)
+      {
+        return row;
+      }
+    }
+    return -1;
+  };
+
+  QSignalSpy changedSpy{&fm, &QAbstractItemModel::dataChanged};
+
+  // Test that setting data through the fused model updates the fused data,
+  // and that the change is reported once
+  auto const row = fusedRow(1);
+  auto const& index = fm.index(row, 0);
+  auto const notes = QStringList{QStringLiteral("note")};
+
+  QVERIFY(fm.data(index, NotesRole).toStringList().isEmpty());
+  QVERIFY(fm.setData(index, notes, NotesRole));
+  QCOMPARE(fm.data(index, NotesRole).toStringList(), notes);
+  QCOMPARE(changedSpy.count(), 1);
+  QCOMPARE(changedSpy.first()[0].toModelIndex().row(), row);
+
+  // Test that editing the source model directly also updates the fused data
+  changedSpy.clear();
+  auto const otherNotes = QStringList{QStringLiteral("other note")};
+
+  QVERIFY(tm.setData(tm.index(0, 0), otherNotes, NotesRole));
+  QCOMPARE(fm.data(index, NotesRole).toStringList(), otherNotes);
+  QCOMPARE(changedSpy.count(), 1);
+
+  // Test that extending a track (inserting a state) updates the fused data
+  changedSpy.clear();
+  tm.updateTrack(tm.index(0, 0), createState(3, 500));
+
+  testModelData(fm, 1, 100, 500, true);
+  testModelData(fm, 2, 300, 400, true);
+  QVERIFY(changedSpy.count() > 0);
+  QCOMPARE(changedSpy.last()[0].toModelIndex().row(), row);
+
+  // Test that changing a track's state updates the fused data
+  changedSpy.clear();
+  tm.updateTrack(tm.index(0, 0), createState(3, 300));
+
+  testModelData(fm, 1, 100, 300, true);
+  QVERIFY(changedSpy.count() > 0);
+  QCOMPARE(changedSpy.last()[0].toModelIndex().row(), row);
+}
+
 } // namespace test
 
 } // namespace gui
@@ -0,0 +1,733 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/noaa/core/ImageListVideoSourceFactory.hpp>
+#include <sealtk/noaa/core/NoaaPipelineWorker.hpp>
+
+#include <sealtk/noaa/PluginConfig.hpp>
+
+#include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/KwiverDetectionsSink.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/KwiverTracksSink.hpp>
+#include <sealtk/core/PipelineResultCache.hpp>
+#include <sealtk/core/VideoSource.hpp>
+#include <sealtk/core/Version.h>
+
+#include <vital/plugin_loader/plugin_manager.h>
+
+#include <vital/range/iota.h>
+
+#include <QAbstractItemModel>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QSettings>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+namespace kv = kwiver::vital;
+namespace kvr = kwiver::vital::range;
+
+using ts_time_t = kv::timestamp::time_t;
+
+namespace sc = sealtk::core;
+namespace snc = sealtk::noaa::core;
+
+namespace // anonymous
+{
+
+auto const none = QStringLiteral("-");
+
+// ----------------------------------------------------------------------------
+QUrl inputUri(QString const& path)
+{
+  auto uri = QUrl::fromLocalFile(path);
+
+  if (QFileInfo{path}.isDir())
+  {
+    static auto const defaultGlobs = QStringList{
+      QStringLiteral("*.bmp"),
+      QStringLiteral("*.jpg"),
+      QStringLiteral("*.jpeg"),
+      QStringLiteral("*.pgm"),
+      QStringLiteral("*.png"),
+      QStringLiteral("*.sgi"),
+      QStringLiteral("*.tif"),
+      QStringLiteral("*.tiff")
+    };
+
+    auto params = QUrlQuery{};
+    params.addQueryItem("filter", defaultGlobs.join(";"));
+    uri.setQuery(params);
+  }
+
+  return uri;
+}
+
+// ----------------------------------------------------------------------------
+bool writeFile(sc::AbstractDataSink& writer, QString const& path,
+               QString const& format)
+{
+  auto uri = QUrl::fromLocalFile(path);
+  auto params = QUrlQuery{};
+
+  params.addQueryItem("output:type", format);
+  uri.setQuery(params);
+
+  auto ok = true;
+  QObject::connect(
+    &writer, &sc::AbstractDataSink::failed,
+    [&ok, &path](QString const& message){
+      qCritical().noquote() << "Failed to write" << path << ":" << message;
+      ok = false;
+    });
+
+  writer.writeData(uri);
+  return ok;
+}
+
+// ----------------------------------------------------------------------------
+bool writeOutput(sc::AbstractDataSink& writer, sc::VideoSource* videoSource,
+                 QAbstractItemModel* model, QString const& path,
+                 QString const& format)
+{
+  if (!writer.setData(videoSource, model))
+  {
+    qWarning().noquote() << "No results to write to" << path;
+    return true;
+  }
+
+  return writeFile(writer, path, format);
+}
+
+// ----------------------------------------------------------------------------
+bool appendOutput(sc::AbstractDataSink& writer, sc::VideoSource* videoSource,
+                  QAbstractItemModel* model, QString const& path,
+                  QString const& format)
+{
+  if (!writer.setData(videoSource, model))
+  {
+    // Nothing new to write
+    return true;
+  }
+
+  // Write results to a temporary file...
+  QTemporaryFile segment{path + QStringLiteral(".XXXXXX")};
+  if (!segment.open())
+  {
+    qCritical().noquote() << "Failed to create temporary file for" << path
+                          << ":" << segment.errorString();
+    return false;
+  }
+  segment.close();
+
+  if (!writeFile(writer, segment.fileName(), format))
+  {
+    return false;
+  }
+
+  // ...and append them to the output
+  QFile in{segment.fileName()};
+  QFile out{path};
+  if (!in.open(QIODevice::ReadOnly) ||
+      !out.open(QIODevice::WriteOnly | QIODevice::Append))
+  {
+    qCritical().noquote() << "Failed to append results to" << path << ":"
+                          << out.errorString();
+    return false;
+  }
+
+  auto const& content = in.readAll();
+  auto const size = out.size();
+  if (out.write(content) != content.size() || !out.flush())
+  {
+    qCritical().noquote() << "Failed to append results to" << path << ":"
+                          << out.errorString();
+
+    // Don't leave partial results in the output
+    out.resize(size);
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace <anonymous>
+
+// ----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  // Create application and set identity information
+  QCoreApplication app{argc, argv};
+  QCoreApplication::setApplicationName(QStringLiteral("SEAL-TK Batch"));
+  QCoreApplication::setApplicationVersion(QStringLiteral(SEALTK_VERSION));
+  QCoreApplication::setOrganizationName(QStringLiteral("Kitware"));
+
+  // Set up command line parser
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+    QStringLiteral(
+      "Executes a KWIVER pipeline on one or more image sequences and writes "
+      "the results, without requiring a display."));
+  parser.addHelpOption();
+  parser.addVersionOption();
+
+  parser.addPositionalArgument(
+    QStringLiteral("pipeline"),
+    QStringLiteral("KWIVER pipeline file to execute."));
+
+  QCommandLineOption inputOption{
+    {QStringLiteral("i"), QStringLiteral("input")},
+    QStringLiteral(
+      "Image list file or directory of images to use as input. Specify once "
+      "for each view, in order (EO, IR, UV); use '-' for a view which has no "
+      "input."),
+    QStringLiteral("path")};
+  parser.addOption(inputOption);
+
+  QCommandLineOption outputOption{
+    {QStringLiteral("o"), QStringLiteral("output")},
+    QStringLiteral(
+      "File to which to write the results for a view. Specify once for each "
+      "view, in the same order as the inputs; use '-' to skip writing the "
+      "results for a view."),
+    QStringLiteral("file")};
+  parser.addOption(outputOption);
+
+  QCommandLineOption detectionsOption{
+    {QStringLiteral("d"), QStringLiteral("detections")},
+    QStringLiteral("Write results as detections rather than as tracks.")};
+  parser.addOption(detectionsOption);
+
+  QCommandLineOption formatOption{
+    QStringLiteral("format"),
+    QStringLiteral(
+      "Name of the KWIVER plugin used to write results (default: '%1' for "
+      "tracks, 'csv' for detections).").arg(sealtk::noaa::config::trackWriter),
+    QStringLiteral("plugin")};
+  parser.addOption(formatOption);
+
+  QCommandLineOption exportModeOption{
+    QStringLiteral("export-mode"),
+    QStringLiteral(
+      "Manner in which tracks are passed to the writer: 'incremental' passes "
+      "the tracks active on each frame, 'cumulative' passes all tracks on "
+      "each frame, and 'final' passes all tracks once. The default is "
+      "'incremental' for the 'kw18' and 'viame_csv' writers, which "
+      "accumulate tracks themselves, and 'cumulative' otherwise."),
+    QStringLiteral("mode")};
+  parser.addOption(exportModeOption);
+
+  QCommandLineOption checkpointOption{
+    QStringLiteral("checkpoint"),
+    QStringLiteral(
+      "File in which to periodically record progress, so that an interrupted "
+      "run can be resumed. When this is used, results are written "
+      "incrementally, as each checkpoint is recorded. Only use this with "
+      "pipelines whose results are final when they are produced, such as "
+      "detector pipelines."),
+    QStringLiteral("file")};
+  parser.addOption(checkpointOption);
+
+  QCommandLineOption checkpointIntervalOption{
+    QStringLiteral("checkpoint-interval"),
+    QStringLiteral("Interval between checkpoints (default: 300)."),
+    QStringLiteral("seconds"), QStringLiteral("300")};
+  parser.addOption(checkpointIntervalOption);
+
+  QCommandLineOption resumeOption{
+    QStringLiteral("resume"),
+    QStringLiteral(
+      "Resume an interrupted run from the last checkpoint, appending to the "
+      "existing outputs. Anything written to the outputs after the checkpoint "
+      "was recorded is discarded.")};
+  parser.addOption(resumeOption);
+
+  QCommandLineOption shardsOption{
+    QStringLiteral("shards"),
+    QStringLiteral(
+      "Number of pipeline instances to execute concurrently, each processing "
+      "part of the input. Only use this with pipelines which do not carry "
+      "state from one frame to the next, such as detector pipelines."),
+    QStringLiteral("count"), QStringLiteral("1")};
+  parser.addOption(shardsOption);
+
+  QCommandLineOption cacheOption{
+    QStringLiteral("cache"),
+    QStringLiteral(
+      "Reuse results of earlier runs of the pipeline over the same input "
+      "images, and store results for later runs. Only use this with "
+      "pipelines which do not carry state from one frame to the next, such "
+      "as detector pipelines. Reused results keep only the box, confidence, "
+      "classification and notes of each detection.")};
+  parser.addOption(cacheOption);
+
+  QCommandLineOption cacheDirectoryOption{
+    QStringLiteral("cache-directory"),
+    QStringLiteral("Directory in which to store cached results (default: "
+                   "'%1').").arg(sc::PipelineResultCache::defaultDirectory()),
+    QStringLiteral("path"), sc::PipelineResultCache::defaultDirectory()};
+  parser.addOption(cacheDirectoryOption);
+
+  QCommandLineOption cacheSizeOption{
+    QStringLiteral("cache-size"),
+    QStringLiteral("Maximum size of the cache directory (default: %1).")
+      .arg(sc::PipelineResultCache::defaultSizeLimit() >> 20),
+    QStringLiteral("MiB"),
+    QString::number(sc::PipelineResultCache::defaultSizeLimit() >> 20)};
+  parser.addOption(cacheSizeOption);
+
+  QCommandLineOption metricsOption{
+    QStringLiteral("metrics"),
+    QStringLiteral(
+      "File to which to write pipeline throughput and latency metrics when "
+      "the run finishes. The metrics are written as CSV if the file name "
+      "ends with '.csv', and as JSON otherwise."),
+    QStringLiteral("file")};
+  parser.addOption(metricsOption);
+
+  QCommandLineOption metricsIntervalOption{
+    QStringLiteral("metrics-interval"),
+    QStringLiteral(
+      "Interval at which to log a summary of the pipeline metrics (default: "
+      "0, which disables the summary)."),
+    QStringLiteral("seconds"), QStringLiteral("0")};
+  parser.addOption(metricsIntervalOption);
+
+  // Parse command line options
+  parser.process(app);
+
+  auto const& positionalArguments = parser.positionalArguments();
+  if (positionalArguments.count() != 1)
+  {
+    qCritical() << "Exactly one pipeline file must be specified";
+    parser.showHelp(EXIT_FAILURE);
+  }
+
+  auto const& pipelineFile = positionalArguments.first();
+  auto const& inputs = parser.values(inputOption);
+  auto const& outputs = parser.values(outputOption);
+
+  if (inputs.isEmpty())
+  {
+    qCritical() << "At least one input must be specified";
+    return EXIT_FAILURE;
+  }
+
+  auto const shards = parser.value(shardsOption).toInt();
+  auto const& checkpointFile = parser.value(checkpointOption);
+  auto const checkpointing = !checkpointFile.isEmpty();
+  auto const resume = parser.isSet(resumeOption);
+
+  if (resume && !checkpointing)
+  {
+    qCritical() << "A checkpoint file is required in order to resume";
+    return EXIT_FAILURE;
+  }
+
+  if (checkpointing && shards > 1)
+  {
+    qCritical() << "Checkpoints cannot be used with sharded execution";
+    return EXIT_FAILURE;
+  }
+
+  auto const writeDetections = parser.isSet(detectionsOption);
+  auto const& format =
+    (parser.isSet(formatOption)
+     ? parser.value(formatOption)
+     : (writeDetections ? QStringLiteral("csv")
+                        : sealtk::noaa::config::trackWriter));
+
+  auto exportMode = sc::KwiverTracksSink::exportModeForWriter(format);
+  if (parser.isSet(exportModeOption))
+  {
+    auto const& exportModeName = parser.value(exportModeOption);
+    if (exportModeName == QStringLiteral("incremental"))
+    {
+      exportMode = sc::KwiverTracksSink::ExportMode::Incremental;
+    }
+    else if (exportModeName == QStringLiteral("cumulative"))
+    {
+      exportMode = sc::KwiverTracksSink::ExportMode::Cumulative;
+    }
+    else if (exportModeName == QStringLiteral("final"))
+    {
+      exportMode = sc::KwiverTracksSink::ExportMode::Final;
+    }
+    else
+    {
+      qCritical().noquote() << "Unknown export mode" << exportModeName;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Load all KWIVER plugins
+  kwiver::vital::plugin_manager::instance().load_all_plugins();
+
+  // Register meta-types
+  qRegisterMetaType<std::shared_ptr<QAbstractItemModel>>();
+
+  // Load video sources
+  snc::ImageListVideoSourceFactory listFactory{false, &app};
+  snc::ImageListVideoSourceFactory directoryFactory{true, &app};
+
+  auto videoSources = QVector<sc::VideoSource*>(inputs.count(), nullptr);
+  auto const& storeVideoSource = [](void* handle, sc::VideoSource* source){
+    *static_cast<sc::VideoSource**>(handle) = source;
+  };
+
+  QObject::connect(&listFactory, &sc::VideoSourceFactory::videoSourceLoaded,
+                   storeVideoSource);
+  QObject::connect(&directoryFactory,
+                   &sc::VideoSourceFactory::videoSourceLoaded,
+                   storeVideoSource);
+
+  for (auto const i : kvr::iota(inputs.count()))
+  {
+    auto const& path = inputs[i];
+    if (path == none)
+    {
+      continue;
+    }
+
+    auto& factory =
+      (QFileInfo{path}.isDir() ? directoryFactory : listFactory);
+    factory.loadVideoSource(&videoSources[i], inputUri(path));
+
+    if (!videoSources[i])
+    {
+      qCritical().noquote() << "Failed to load input" << path;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Set up pipeline
+  snc::NoaaPipelineWorker worker;
+  for (auto* const videoSource : videoSources)
+  {
+    worker.addVideoSource(videoSource);
+  }
+
+  auto trackModels = QHash<int, std::shared_ptr<QAbstractItemModel>>{};
+  QObject::connect(
+    &worker, &snc::NoaaPipelineWorker::trackModelReady,
+    [&trackModels](int i, std::shared_ptr<QAbstractItemModel> const& model){
+      trackModels.insert(i, model);
+    });
+
+  worker.setMetricsInterval(
+    std::max(0, parser.value(metricsIntervalOption).toInt()) * 1000);
+
+  // Report progress and throughput, at most once per second
+  QElapsedTimer elapsed;
+  QElapsedTimer sinceReport;
+  auto totalFrames = int{0};
+  auto framesProcessed = int{0};
+
+  auto const& throughput = [&]{
+    auto const seconds = 1e-3 * static_cast<double>(elapsed.elapsed());
+    return (seconds > 0.0 ? framesProcessed / seconds : 0.0);
+  };
+
+  QObject::connect(
+    &worker, &sc::KwiverPipelineWorker::progressRangeChanged, &app,
+    [&totalFrames](int, int maximum){ totalFrames = maximum; });
+  QObject::connect(
+    &worker, &sc::KwiverPipelineWorker::progressValueChanged, &app,
+    [&](int value){
+      framesProcessed = value;
+      if (sinceReport.hasExpired(1000))
+      {
+        qInfo().noquote()
+          << QStringLiteral("%1 / %2 frames (%3 frames/s)")
+               .arg(framesProcessed).arg(totalFrames)
+               .arg(throughput(), 0, 'f', 1);
+        sinceReport.restart();
+      }
+    });
+
+  // Restore checkpoint, if resuming
+  QSettings checkpoint{checkpointFile, QSettings::IniFormat};
+  auto lastTrackId = kv::track_id_t{0};
+
+  if (resume)
+  {
+    if (!checkpoint.contains(QStringLiteral("Time")))
+    {
+      qCritical().noquote() << "No checkpoint to resume from in"
+                            << checkpointFile;
+      return EXIT_FAILURE;
+    }
+
+    if (checkpoint.value(QStringLiteral("Pipeline")) != pipelineFile)
+    {
+      qWarning().noquote() << "Checkpoint was recorded using a different"
+                           << "pipeline than" << pipelineFile;
+    }
+
+    auto const time = checkpoint.value(QStringLiteral("Time")).toLongLong();
+    lastTrackId = checkpoint.value(QStringLiteral("LastTrackId")).toLongLong();
+
+    // Discard any results written after the checkpoint was recorded, as they
+    // will be produced again, and would otherwise be duplicated
+    auto outputSizes = QHash<QString, qint64>{};
+    auto const outputCount =
+      checkpoint.beginReadArray(QStringLiteral("Outputs"));
+    for (auto const i : kvr::iota(outputCount))
+    {
+      checkpoint.setArrayIndex(i);
+      auto const& path = checkpoint.value(QStringLiteral("Path"));
+      auto const& size = checkpoint.value(QStringLiteral("Size"));
+      outputSizes.insert(path.toString(), size.toLongLong());
+    }
+    checkpoint.endArray();
+
+    for (auto const& path : outputs)
+    {
+      if (path == none)
+      {
+        continue;
+      }
+
+      QFile out{path};
+      auto const size = outputSizes.value(path, -1);
+      if (size < 0)
+      {
+        qCritical().noquote() << "Checkpoint does not record the output"
+                              << path;
+        return EXIT_FAILURE;
+      }
+      if (out.size() < size || !out.resize(size))
+      {
+        qCritical().noquote() << "Failed to restore" << path
+                              << "to its state at the checkpoint";
+        return EXIT_FAILURE;
+      }
+    }
+
+    worker.setTimeRange(time + 1, std::numeric_limits<ts_time_t>::max());
+    worker.setTrackIdOffset(lastTrackId);
+
+    qInfo().noquote() << "Resuming after time" << time;
+  }
+
+  if (parser.isSet(cacheOption))
+  {
+    auto const sizeLimit = parser.value(cacheSizeOption).toLongLong() << 20;
+    auto cache = std::make_shared<sc::PipelineResultCache>(
+      pipelineFile, parser.value(cacheDirectoryOption), sizeLimit);
+
+    if (cache->isValid())
+    {
+      worker.setResultCache(cache);
+    }
+    else
+    {
+      qWarning() << "Unable to use result cache; results will not be reused";
+    }
+  }
+
+  if (!worker.initialize(pipelineFile))
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (shards > 1 && !worker.initializeShards(pipelineFile, shards))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Write results; when checkpointing, results are written incrementally, by
+  // appending the results accumulated since the previous checkpoint to the
+  // outputs and then discarding them from the track models
+  auto const& writeResults = [&](bool finished){
+    auto ok = true;
+
+    for (auto const i : kvr::iota(outputs.count()))
+    {
+      auto const& path = outputs[i];
+      if (path == none)
+      {
+        continue;
+      }
+
+      auto* const model = trackModels.value(i).get();
+      if (!model || i >= videoSources.count() || !videoSources[i])
+      {
+        if (finished)
+        {
+          qWarning().noquote() << "No results for view" << i + 1
+                               << "to write to" << path;
+        }
+        continue;
+      }
+
+      auto writer = std::unique_ptr<sc::AbstractDataSink>{};
+      if (writeDetections)
+      {
+        writer.reset(new sc::KwiverDetectionsSink);
+      }
+      else
+      {
+        auto* const tracksWriter = new sc::KwiverTracksSink;
+        tracksWriter->setExportMode(exportMode);
+        writer.reset(tracksWriter);
+      }
+
+      if (!checkpointing)
+      {
+        ok = writeOutput(*writer, videoSources[i], model, path, format) && ok;
+        continue;
+      }
+
+      auto writtenIds = QSet<qint64>{};
+      for (auto const row : kvr::iota(model->rowCount()))
+      {
+        auto const& index = model->index(row, 0);
+        auto const id = model->data(index, sc::LogicalIdentityRole);
+        lastTrackId =
+          std::max(lastTrackId, static_cast<kv::track_id_t>(id.toLongLong()));
+        writtenIds.insert(id.value<qint64>());
+      }
+
+      ok = appendOutput(*writer, videoSources[i], model, path, format) && ok;
+
+      // Discard only the tracks which were written; output is suspended while
+      // checkpointing, so no others should have arrived, but writing runs the
+      // event loop, and anything delivered meanwhile must be kept for the
+      // next checkpoint
+      if (auto* const trackModel = qobject_cast<sc::KwiverTrackModel*>(model))
+      {
+        if (trackModel->rowCount() == writtenIds.count())
+        {
+          trackModel->clear();
+        }
+        else
+        {
+          trackModel->removeTracks(writtenIds);
+          trackModel->clearHistory();
+        }
+      }
+    }
+
+    return ok;
+  };
+
+  auto const& saveCheckpoint = [&](ts_time_t time, bool finished){
+    if (!writeResults(finished))
+    {
+      return false;
+    }
+
+    if (time != std::numeric_limits<ts_time_t>::min())
+    {
+      checkpoint.setValue(QStringLiteral("Pipeline"), pipelineFile);
+      checkpoint.setValue(QStringLiteral("Time"),
+                          static_cast<qlonglong>(time));
+      checkpoint.setValue(QStringLiteral("LastTrackId"),
+                          static_cast<qlonglong>(lastTrackId));
+
+      // Record how much of each output is accounted for by the checkpoint
+      checkpoint.beginWriteArray(QStringLiteral("Outputs"));
+      for (auto const i : kvr::iota(outputs.count()))
+      {
+        checkpoint.setArrayIndex(i);
+        checkpoint.setValue(QStringLiteral("Path"), outputs[i]);
+        checkpoint.setValue(QStringLiteral("Size"),
+                            QFileInfo{outputs[i]}.size());
+      }
+      checkpoint.endArray();
+
+      checkpoint.sync();
+    }
+
+    return checkpoint.status() == QSettings::NoError;
+  };
+
+  QTimer checkpointTimer;
+  if (checkpointing)
+  {
+    // Start with empty outputs, unless resuming
+    if (!resume)
+    {
+      for (auto const& path : outputs)
+      {
+        QFile out{path};
+        if (path != none && !out.open(QIODevice::WriteOnly))
+        {
+          qCritical().noquote() << "Failed to create" << path << ":"
+                                << out.errorString();
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    QObject::connect(
+      &checkpointTimer, &QTimer::timeout, [&]{
+        // Writing the results runs the event loop; stop the timer so that
+        // checkpoints do not overlap, and suspend delivery of output so that
+        // the track models do not change until they have been written
+        checkpointTimer.stop();
+        worker.suspendOutput();
+
+        if (!saveCheckpoint(worker.flushOutput(), false))
+        {
+          qCritical().noquote() << "Failed to record checkpoint in"
+                                << checkpointFile;
+        }
+
+        worker.resumeOutput();
+        checkpointTimer.start();
+      });
+
+    auto const interval = parser.value(checkpointIntervalOption).toInt();
+    checkpointTimer.start(std::max(1, interval) * 1000);
+  }
+
+  // Execute pipeline
+  elapsed.start();
+  sinceReport.start();
+
+  worker.execute();
+
+  auto const lastTime = worker.flushOutput();
+  checkpointTimer.stop();
+
+  qInfo().noquote()
+    << QStringLiteral("Processed %1 frames in %2 s (%3 frames/s)")
+         .arg(framesProcessed)
+         .arg(1e-3 * static_cast<double>(elapsed.elapsed()), 0, 'f', 1)
+         .arg(throughput(), 0, 'f', 1);
+
+  auto const& metricsFile = parser.value(metricsOption);
+  if (!metricsFile.isEmpty() && !worker.metrics().write(metricsFile))
+  {
+    qWarning().noquote() << "Failed to write metrics to" << metricsFile;
+  }
+
+  if (checkpointing)
+  {
+    if (!saveCheckpoint(lastTime, true))
+    {
+      return EXIT_FAILURE;
+    }
+
+    // The run is complete, so there is nothing left to resume
+    QFile::remove(checkpointFile);
+    return EXIT_SUCCESS;
+  }
+
+  return (writeResults(true) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -4,19 +4,36 @@
 
 #include <sealtk/noaa/core/NoaaPipelineWorker.hpp>
 
+#include <sealtk/noaa/core/TrackStage.hpp>
+
 #include <sealtk/core/KwiverPipelinePortSet.hpp>
 #include <sealtk/core/KwiverTrackModel.hpp>
 
+#include <sealtk/util/unique.hpp>
+
 #include <vital/types/detected_object_set.h>
 
+#include <vital/range/iota.h>
 #include <vital/range/valid.h>
 
 #include <qtGet.h>
 #include <qtStlUtil.h>
 
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QMap>
+#include <QMutex>
+#include <QQueue>
 #include <QRegularExpression>
 #include <QSet>
 
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
 namespace ka = kwiver::adapter;
 namespace kv = kwiver::vital;
 namespace kvr = kwiver::vital::range;
@@ -44,11 +61,13 @@ namespace core
 namespace // anonymous
 {
 
-// ----------------------------------------------------------------------------
-template <typename T> std::weak_ptr<T> weakRef(std::shared_ptr<T> const& p)
+// ============================================================================
+struct TrackOutput
 {
-  return p;
-}
+  int index;
+  kv::object_track_set_sptr tracks;
+  bool merge;
+};
 
 // ============================================================================
 class PortSet : sealtk::core::KwiverPipelinePortSet
@@ -62,12 +81,26 @@ public:
     return KwiverPipelinePortSet::portNames(pipeline, PortType::Output);
   }
 
-  void extractOutput(ka::adapter_data_set_t const& dataSet);
+  ts_time_t extractOutput(ka::adapter_data_set_t const& dataSet,
+                          std::vector<TrackOutput>& output);
+  void reuseOutput(ts_time_t time, kv::object_track_set_sptr const& cached,
+                   std::vector<TrackOutput>& output);
+  void postOutput(TrackOutput const& output) const;
+  void flushOutput() const { this->stage->flush(); }
+  void suspendOutput() const { this->stage->suspend(); }
+  void resumeOutput() const { this->stage->resume(); }
+
+  bool producesTracks() const { return !this->tracksPort.empty(); }
 
   int index;
   std::shared_ptr<KwiverTrackModel> model;
 
 private:
+  void addDetections(ts_time_t time, kv::detected_object_set const& detections,
+                     std::vector<TrackOutput>& output);
+
+  std::shared_ptr<TrackStage> stage;
+
   std::string detectionsPort;
   std::string tracksPort;
 
@@ -76,7 +109,8 @@ private:
 
 // ----------------------------------------------------------------------------
 PortSet::PortSet(kwiver::embedded_pipeline& pipeline, int index)
-  : index{index}, model{std::make_shared<KwiverTrackModel>()}
+  : index{index}, model{std::make_shared<KwiverTrackModel>()},
+    stage{std::make_shared<TrackStage>(this->model)}
 {
   this->bind(
     pipeline, index, PortType::Output,
@@ -87,7 +121,8 @@ PortSet::PortSet(kwiver::embedded_pipeline& pipeline, int index)
 }
 
 // ----------------------------------------------------------------------------
-void PortSet::extractOutput(ka::adapter_data_set_t const& dataSet)
+ts_time_t PortSet::extractOutput(ka::adapter_data_set_t const& dataSet,
+                                 std::vector<TrackOutput>& output)
 {
   // Get time stamp
   if (auto* const timeDatum = qtGet(*dataSet, this->timePort))
@@ -103,39 +138,7 @@ void PortSet::extractOutput(ka::adapter_data_set_t const& dataSet)
 
       if (detections)
       {
-        auto tracks = std::vector<kv::track_sptr>{};
-
-        // Generate tracks from detections
-        for (auto const& detection : *detections | kvr::valid)
-        {
-          // Create track
-          auto track = kv::track::create();
-          track->set_id(++this->nextTrack);
-
-          // Create object state for track
-          auto state =
-            std::make_shared<kv::object_track_state>(0, t, detection);
-          track->append(state);
-
-          // Add track to set
-          tracks.emplace_back(std::move(track));
-        }
-
-        // Add extracted tracks to model
-        if (!tracks.empty())
-        {
-          auto trackSet = std::make_shared<kv::object_track_set>(tracks);
-          auto&& mwp = weakRef(model);
-
-          QMetaObject::invokeMethod(
-            model.get(),
-            [trackSet = std::move(trackSet), mwp = std::move(mwp)]{
-              if (auto const& model = mwp.lock())
-              {
-                model->addTracks(trackSet);
-              }
-            });
-        }
+        this->addDetections(t, *detections, output);
       }
     }
 
@@ -146,19 +149,100 @@ void PortSet::extractOutput(ka::adapter_data_set_t const& dataSet)
 
       if (trackSet && !trackSet->empty())
       {
-        auto&& mwp = weakRef(model);
-
-        QMetaObject::invokeMethod(
-          model.get(),
-          [trackSet = std::move(trackSet), mwp = std::move(mwp)]{
-            if (auto const& model = mwp.lock())
-            {
-              model->mergeTracks(trackSet);
-            }
-          });
+        output.push_back({this->index, std::move(trackSet), true});
+      }
+    }
+
+    return t;
+  }
+
+  return std::numeric_limits<ts_time_t>::min();
+}
+
+// ----------------------------------------------------------------------------
+void PortSet::reuseOutput(ts_time_t time,
+                          kv::object_track_set_sptr const& cached,
+                          std::vector<TrackOutput>& output)
+{
+  // Recover the detections from which the cached tracks were generated
+  auto detections = kv::detected_object_set{};
+  for (auto const& track : cached->tracks() | kvr::valid)
+  {
+    for (auto const& state : *track | kv::as_object_track | kvr::valid)
+    {
+      if (auto const& detection = state->detection())
+      {
+        detections.add(detection);
       }
     }
   }
+
+  this->addDetections(time, detections, output);
+}
+
+// ----------------------------------------------------------------------------
+void PortSet::addDetections(ts_time_t time,
+                            kv::detected_object_set const& detections,
+                            std::vector<TrackOutput>& output)
+{
+  auto tracks = std::vector<kv::track_sptr>{};
+
+  // Generate tracks from detections
+  for (auto const& detection : detections | kvr::valid)
+  {
+    // Create track
+    auto track = kv::track::create();
+    track->set_id(++this->nextTrack);
+
+    // Create object state for track
+    auto state = std::make_shared<kv::object_track_state>(0, time, detection);
+    track->append(state);
+
+    // Add track to set
+    tracks.emplace_back(std::move(track));
+  }
+
+  // Add extracted tracks to output
+  if (!tracks.empty())
+  {
+    auto trackSet = std::make_shared<kv::object_track_set>(tracks);
+    output.push_back({this->index, std::move(trackSet), false});
+  }
+}
+
+// ----------------------------------------------------------------------------
+void PortSet::postOutput(TrackOutput const& output) const
+{
+  this->stage->stage(output.tracks, output.merge);
+}
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr offsetTracks(
+  kv::object_track_set_sptr const& trackSet, kv::track_id_t shardOffset,
+  kv::track_id_t baseOffset, kv::track_id_t& maxId)
+{
+  auto const& tracks = trackSet->tracks();
+  for (auto const& track : tracks | kvr::valid)
+  {
+    maxId = std::max(maxId, track->id() + shardOffset);
+  }
+
+  auto const offset = shardOffset + baseOffset;
+  if (!offset)
+  {
+    return trackSet;
+  }
+
+  auto offsetTracks = std::vector<kv::track_sptr>{};
+  for (auto const& track : tracks | kvr::valid)
+  {
+    // Tracks may still be referenced by the pipeline, so modify a copy
+    auto copy = track->clone();
+    copy->set_id(track->id() + offset);
+    offsetTracks.emplace_back(std::move(copy));
+  }
+
+  return std::make_shared<kv::object_track_set>(offsetTracks);
 }
 
 } // namespace <anonymous>
@@ -167,12 +251,186 @@ void PortSet::extractOutput(ka::adapter_data_set_t const& dataSet)
 class NoaaPipelineWorkerPrivate
 {
 public:
+  void storeOutput(bool isShard, std::vector<TrackOutput>& output,
+                   ts_time_t time, bool computed);
+  void storeReadyOutput(bool isShard);
+  void deliverOutput(TrackOutput const& output);
+  void deliverShard(NoaaPipelineWorker* shard);
+  void releaseOutput();
+  void updateProgress(int shard, int framesProcessed);
+
   QSet<int> outputSets;
   std::vector<PortSet> outputs;
+
+  // Sharded execution; the worker which owns the shards runs the last shard
+  // and delivers all output, while the other shards only collect theirs
+  NoaaPipelineWorker* owner = nullptr;
+  int shardIndex = 0;
+  std::vector<std::unique_ptr<NoaaPipelineWorker>> shards;
+
+  QMutex mutex;
+  bool holdOutput = false;
+  std::vector<TrackOutput> pendingOutput;
+  QHash<int, kv::track_id_t> idOffsets;
+  QHash<int, kv::track_id_t> maxIds;
+  kv::track_id_t trackIdOffset = 0;
+
+  // Time of the latest output which has been delivered (or held)
+  ts_time_t outputTime = std::numeric_limits<ts_time_t>::min();
+  ts_time_t heldOutputTime = std::numeric_limits<ts_time_t>::min();
+  QVector<int> shardProgress;
+
+  // Reuse of earlier output; output of time steps which are found in the
+  // cache is produced as soon as the step is reached (without its frames
+  // being requested), while the times of steps sent to the pipeline are
+  // tracked until their output arrives; output is delivered strictly in time
+  // order, so reused output waits until the output of every earlier step
+  // sent to the pipeline has arrived, and the output time never advances
+  // past output not yet received
+  std::shared_ptr<sealtk::core::PipelineResultCache> resultCache;
+  QHash<ts_time_t, QByteArray> pendingKeys;
+  QQueue<ts_time_t> pendingTimes;
+  QMap<ts_time_t, std::vector<TrackOutput>> readyOutput;
 };
 
 QTE_IMPLEMENT_D_FUNC(NoaaPipelineWorker)
 
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorkerPrivate::storeOutput(
+  bool isShard, std::vector<TrackOutput>& output, ts_time_t time,
+  bool computed)
+{
+  if (computed)
+  {
+    // The pipeline produces output in time order, so it is finished with
+    // every step up to this one
+    while (!this->pendingTimes.isEmpty() &&
+           this->pendingTimes.head() <= time)
+    {
+      this->pendingTimes.dequeue();
+    }
+  }
+
+  auto& ready = this->readyOutput[time];
+  std::move(output.begin(), output.end(), std::back_inserter(ready));
+
+  this->storeReadyOutput(isShard);
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorkerPrivate::storeReadyOutput(bool isShard)
+{
+  // Pass on the output of steps preceding the earliest step whose output is
+  // still to be received from the pipeline
+  while (!this->readyOutput.isEmpty() &&
+         (this->pendingTimes.isEmpty() ||
+          this->readyOutput.firstKey() < this->pendingTimes.head()))
+  {
+    auto const time = this->readyOutput.firstKey();
+    auto output = this->readyOutput.take(time);
+
+    if (isShard)
+    {
+      // Shard output is delivered by the owner once the shard is finished
+      std::move(output.begin(), output.end(),
+                std::back_inserter(this->pendingOutput));
+      this->outputTime = std::max(this->outputTime, time);
+      continue;
+    }
+
+    for (auto& o : output)
+    {
+      if (this->holdOutput)
+      {
+        this->pendingOutput.push_back(std::move(o));
+      }
+      else
+      {
+        this->deliverOutput(o);
+      }
+    }
+
+    auto& outputTime = (this->holdOutput ? this->heldOutputTime
+                                         : this->outputTime);
+    outputTime = std::max(outputTime, time);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorkerPrivate::deliverOutput(TrackOutput const& output)
+{
+  auto& maxId = this->maxIds[output.index];
+  auto const offset = this->idOffsets.value(output.index, 0);
+  auto const& tracks =
+    offsetTracks(output.tracks, offset, this->trackIdOffset, maxId);
+
+  for (auto const& p : this->outputs)
+  {
+    if (p.index == output.index)
+    {
+      p.postOutput({output.index, tracks, output.merge});
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorkerPrivate::deliverShard(NoaaPipelineWorker* shard)
+{
+  QMutexLocker locker{&this->mutex};
+
+  // Offset the shard's track identifiers past those already delivered
+  this->idOffsets = this->maxIds;
+
+  // The shard is finished, so any output it is still holding back (e.g. if
+  // its pipeline did not produce output for its last steps) is complete
+  auto* const sd = shard->d_func();
+  sd->pendingTimes.clear();
+  sd->storeReadyOutput(true);
+
+  for (auto const& o : sd->pendingOutput)
+  {
+    this->deliverOutput(o);
+  }
+  sd->pendingOutput.clear();
+
+  this->outputTime = std::max(this->outputTime, sd->outputTime);
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorkerPrivate::releaseOutput()
+{
+  QMutexLocker locker{&this->mutex};
+
+  this->idOffsets = this->maxIds;
+  this->holdOutput = false;
+
+  for (auto const& o : this->pendingOutput)
+  {
+    this->deliverOutput(o);
+  }
+  this->pendingOutput.clear();
+
+  this->outputTime = std::max(this->outputTime, this->heldOutputTime);
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorkerPrivate::updateProgress(int shard, int framesProcessed)
+{
+  auto total = int{0};
+
+  {
+    QMutexLocker locker{&this->mutex};
+
+    this->shardProgress[shard] = framesProcessed;
+    for (auto const n : this->shardProgress)
+    {
+      total += n;
+    }
+  }
+
+  this->owner->KwiverPipelineWorker::reportProgress(total);
+}
+
 // ----------------------------------------------------------------------------
 NoaaPipelineWorker::NoaaPipelineWorker(QWidget* parent)
   : NoaaPipelineWorker{RequiresInput, parent}
@@ -184,6 +442,8 @@ NoaaPipelineWorker::NoaaPipelineWorker(
   RequiredEndcaps endcaps, QWidget* parent)
   : super{endcaps, parent}, d_ptr{new NoaaPipelineWorkerPrivate}
 {
+  QTE_D();
+  d->owner = this;
 }
 
 // ----------------------------------------------------------------------------
@@ -191,6 +451,129 @@ NoaaPipelineWorker::~NoaaPipelineWorker()
 {
 }
 
+// ----------------------------------------------------------------------------
+int NoaaPipelineWorker::shardCount() const
+{
+  QTE_D();
+  return static_cast<int>(d->shards.size()) + 1;
+}
+
+// ----------------------------------------------------------------------------
+bool NoaaPipelineWorker::initializeShards(
+  QString const& pipelineFile, int count)
+{
+  QTE_D();
+
+  d->shards.clear();
+
+  auto const& ranges = this->splitTimeline(count);
+  if (ranges.count() < 2)
+  {
+    return true;
+  }
+
+  auto const& sources = this->videoSources();
+  for (auto const i : kvr::iota(ranges.count() - 1))
+  {
+    auto shard = make_unique<NoaaPipelineWorker>();
+    auto* const sd = shard->d_func();
+
+    sd->owner = this;
+    sd->shardIndex = i;
+    sd->resultCache = d->resultCache;
+
+    for (auto* const source : sources)
+    {
+      shard->addVideoSource(source);
+    }
+    shard->setLookAhead(this->lookAhead());
+    shard->setTimeRange(ranges[i].first, ranges[i].second);
+
+    if (!shard->initialize(pipelineFile))
+    {
+      d->shards.clear();
+      return false;
+    }
+
+    d->shards.push_back(std::move(shard));
+  }
+
+  this->setTimeRange(ranges.last().first, ranges.last().second);
+
+  d->shardIndex = ranges.count() - 1;
+  d->shardProgress.fill(0, ranges.count());
+  d->holdOutput = true;
+
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+sealtk::core::PipelineMetrics NoaaPipelineWorker::metrics() const
+{
+  QTE_D();
+
+  auto result = this->KwiverPipelineWorker::metrics();
+  for (auto const& shard : d->shards)
+  {
+    result.merge(shard->metrics());
+  }
+
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+ts_time_t NoaaPipelineWorker::flushOutput()
+{
+  QTE_D();
+  QMutexLocker locker{&d->mutex};
+
+  for (auto const& p : d->outputs)
+  {
+    p.flushOutput();
+  }
+
+  return d->outputTime;
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorker::suspendOutput()
+{
+  QTE_D();
+  QMutexLocker locker{&d->mutex};
+
+  for (auto const& p : d->outputs)
+  {
+    p.suspendOutput();
+  }
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorker::resumeOutput()
+{
+  QTE_D();
+  QMutexLocker locker{&d->mutex};
+
+  for (auto const& p : d->outputs)
+  {
+    p.resumeOutput();
+  }
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorker::setTrackIdOffset(kv::track_id_t offset)
+{
+  QTE_D();
+  d->trackIdOffset = offset;
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorker::setResultCache(
+  std::shared_ptr<sealtk::core::PipelineResultCache> const& cache)
+{
+  QTE_D();
+  d->resultCache = cache;
+}
+
 // ----------------------------------------------------------------------------
 void NoaaPipelineWorker::initializeInput(kwiver::embedded_pipeline& pipeline)
 {
@@ -220,11 +603,74 @@ void NoaaPipelineWorker::initializeInput(kwiver::embedded_pipeline& pipeline)
   {
     p.model->moveToThread(this->thread());
     emit this->trackModelReady(p.index, p.model);
+
+    // Output of pipelines which produce tracks depends on earlier input, so
+    // cannot be reused for individual time steps
+    if (p.producesTracks())
+    {
+      d->resultCache.reset();
+    }
   }
 
   this->KwiverPipelineWorker::initializeInput(pipeline);
 }
 
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorker::sendInput(kwiver::embedded_pipeline& pipeline)
+{
+  QTE_D();
+
+  if (d->shards.empty())
+  {
+    this->KwiverPipelineWorker::sendInput(pipeline);
+    return;
+  }
+
+  // Start the other shards; each runs its own pipeline on a pool thread
+  auto const shardCount = d->shards.size();
+  auto watchers = std::vector<std::unique_ptr<QFutureWatcher<void>>>{};
+  auto shardsDelivered = size_t{0};
+  QEventLoop eventLoop;
+
+  auto deliverFinishedShards = [&]{
+    // Deliver output of finished shards, but only in time order
+    while (shardsDelivered < shardCount &&
+           watchers[shardsDelivered]->isFinished())
+    {
+      d->deliverShard(d->shards[shardsDelivered].get());
+      ++shardsDelivered;
+    }
+
+    if (shardsDelivered == shardCount)
+    {
+      eventLoop.quit();
+    }
+  };
+
+  for (auto const& shard : d->shards)
+  {
+    auto* const s = shard.get();
+    auto watcher = make_unique<QFutureWatcher<void>>();
+
+    connect(watcher.get(), &QFutureWatcher<void>::finished,
+            &eventLoop, deliverFinishedShards);
+    watcher->setFuture(QtConcurrent::run([s]{ s->execute(); }));
+
+    watchers.push_back(std::move(watcher));
+  }
+
+  // Send input for our own time range
+  this->KwiverPipelineWorker::sendInput(pipeline);
+
+  // Wait for the other shards, then deliver the output we have been holding
+  while (shardsDelivered < shardCount)
+  {
+    eventLoop.exec();
+  }
+
+  d->releaseOutput();
+}
+
 // ----------------------------------------------------------------------------
 void NoaaPipelineWorker::processOutput(ka::adapter_data_set_t const& output)
 {
@@ -232,11 +678,141 @@ void NoaaPipelineWorker::processOutput(ka::adapter_data_set_t const& output)
   {
     QTE_D();
 
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker{&d->mutex};
+
+    if (output->is_end_of_data())
+    {
+      // No more output is coming, so pass on any output that was waiting on
+      // steps for which the pipeline did not produce output
+      d->pendingTimes.clear();
+      d->storeReadyOutput(d->owner != this);
+      return;
+    }
+
+    auto trackOutput = std::vector<TrackOutput>{};
+    auto time = std::numeric_limits<ts_time_t>::min();
     for (auto& p : d->outputs)
     {
-      p.extractOutput(output);
+      time = std::max(time, p.extractOutput(output, trackOutput));
+    }
+
+    // Add the output to the result cache
+    if (d->resultCache && d->pendingKeys.contains(time))
+    {
+      auto const& key = d->pendingKeys.take(time);
+      for (auto const& p : d->outputs)
+      {
+        auto tracks = std::vector<kv::track_sptr>{};
+        for (auto const& o : trackOutput)
+        {
+          if (o.index == p.index && !o.merge)
+          {
+            auto const& t = o.tracks->tracks();
+            tracks.insert(tracks.end(), t.begin(), t.end());
+          }
+        }
+
+        d->resultCache->insert(
+          key, p.index, std::make_shared<kv::object_track_set>(tracks));
+      }
+    }
+
+    d->storeOutput(d->owner != this, trackOutput, time, true);
+
+    locker.unlock();
+    this->recordOutput(time, timer.nsecsElapsed());
+  }
+}
+
+// ----------------------------------------------------------------------------
+bool NoaaPipelineWorker::reuseOutput(
+  ts_time_t time, QVector<QString> const& frameNames)
+{
+  QTE_D();
+
+  if (!d->resultCache)
+  {
+    return false;
+  }
+
+  auto const& key = d->resultCache->key(time, frameNames);
+  if (!key.isEmpty())
+  {
+    // Look for cached output for every output port set
+    auto cachedOutput = std::vector<kv::object_track_set_sptr>{};
+    for (auto const& p : d->outputs)
+    {
+      auto cached = d->resultCache->find(key, p.index);
+      if (!cached)
+      {
+        break;
+      }
+      cachedOutput.emplace_back(std::move(cached));
+    }
+
+    if (cachedOutput.size() == d->outputs.size())
+    {
+      QMutexLocker locker{&d->mutex};
+
+      auto trackOutput = std::vector<TrackOutput>{};
+      for (auto const i : kvr::iota(d->outputs.size()))
+      {
+        d->outputs[i].reuseOutput(time, cachedOutput[i], trackOutput);
+      }
+
+      d->storeOutput(d->owner != this, trackOutput, time, false);
+      return true;
     }
   }
+
+  // Output must be computed by the pipeline; remember the key so that the
+  // output can be cached once it arrives
+  QMutexLocker locker{&d->mutex};
+
+  d->pendingTimes.enqueue(time);
+  if (!key.isEmpty())
+  {
+    d->pendingKeys.insert(time, key);
+  }
+
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorker::reportError(
+  QString const& message, QString const& subject)
+{
+  QTE_D();
+
+  if (d->owner != this)
+  {
+    // Let the owner report errors, on its own thread
+    auto* const owner = d->owner;
+    QMetaObject::invokeMethod(
+      owner, [owner, message, subject]{
+        owner->reportError(message, subject);
+      });
+    return;
+  }
+
+  this->KwiverPipelineWorker::reportError(message, subject);
+}
+
+// ----------------------------------------------------------------------------
+void NoaaPipelineWorker::reportProgress(int framesProcessed)
+{
+  QTE_D();
+
+  if (d->owner != this || !d->shards.empty())
+  {
+    d->owner->d_func()->updateProgress(d->shardIndex, framesProcessed);
+    return;
+  }
+
+  this->KwiverPipelineWorker::reportProgress(framesProcessed);
 }
 
 } // namespace core
@@ -8,6 +8,9 @@
 #include <sealtk/noaa/core/Export.h>
 
 #include <sealtk/core/KwiverPipelineWorker.hpp>
+#include <sealtk/core/PipelineResultCache.hpp>
+
+#include <vital/types/track.h>
 
 #include <memory>
 
@@ -36,6 +39,88 @@ public:
 
   ~NoaaPipelineWorker() override;
 
+  /// Get the number of pipeline instances which process the input.
+  /// \sa initializeShards()
+  int shardCount() const;
+
+  /// Prepare to process the input using several pipeline instances.
+  ///
+  /// This splits the merged timeline of the worker's video sources into up to
+  /// \p count contiguous ranges having roughly equal numbers of time steps.
+  /// The last range is processed by the worker's own pipeline; an additional
+  /// instance of the pipeline in \p pipelineFile, with its own video
+  /// requestors, is created for each of the other ranges. When the worker is
+  /// executed, all instances run concurrently, and their output is merged
+  /// into the worker's track models in time order. Track identifiers of each
+  /// range are offset past those of the preceding ranges, so that they do not
+  /// collide.
+  ///
+  /// Because each instance sees only part of the input, this is only suitable
+  /// for pipelines which do not carry state from one frame to the next, such
+  /// as detector pipelines.
+  ///
+  /// This must be called after all video sources have been added and the
+  /// worker has been initialized, and before the worker is executed.
+  bool initializeShards(QString const& pipelineFile, int count);
+
+  /// Get the throughput and latency of the current or last execution.
+  ///
+  /// When the input is processed by several pipeline instances (see
+  /// #initializeShards), the result combines the metrics of all instances.
+  sealtk::core::PipelineMetrics metrics() const override;
+
+  /// Deliver pending pipeline output to the track models immediately.
+  ///
+  /// While the worker executes, output is delivered to the track models
+  /// periodically, in batches. This may be called while the worker executes
+  /// (e.g. to checkpoint the output), or after execute() returns, to ensure
+  /// that the track models are complete without waiting for the next batch.
+  /// It must be called from the thread which owns the track models.
+  ///
+  /// This returns the time of the latest pipeline output which has been
+  /// delivered. Since the pipeline produces output in time order, the track
+  /// models contain all output up to and including that time.
+  kwiver::vital::timestamp::time_t flushOutput();
+
+  /// Stop delivering pipeline output to the track models periodically.
+  ///
+  /// While output is suspended, the pipeline continues to execute, but its
+  /// output is only delivered by flushOutput(). This should be used to keep
+  /// the track models from changing while they are being consumed by an
+  /// operation which runs the event loop, such as writing them with
+  /// sealtk::core::KwiverTracksSink. It must be called from the thread which
+  /// owns the track models.
+  void suspendOutput();
+
+  /// Resume periodic delivery of pipeline output to the track models.
+  /// \sa suspendOutput()
+  void resumeOutput();
+
+  /// Offset the identifiers of all tracks produced by the pipeline.
+  ///
+  /// This can be used to keep the identifiers of tracks from a resumed run
+  /// from colliding with those of tracks from an earlier, interrupted run.
+  /// It must be called before the worker is executed.
+  void setTrackIdOffset(kwiver::vital::track_id_t offset);
+
+  /// Set the cache used to reuse output of earlier executions.
+  ///
+  /// When a cache is set, output of time steps whose input matches that of
+  /// a time step for which output is in the cache is taken from the cache
+  /// instead of being computed by the pipeline, and output which is computed
+  /// by the pipeline is added to the cache. The cache must be created for the
+  /// same pipeline file as is used to initialize the worker.
+  ///
+  /// Because the output of each time step is reused independently, this is
+  /// only effective for pipelines which do not carry state from one frame to
+  /// the next; the cache is not used if the pipeline produces tracks. Reused
+  /// output only includes the bounding box, confidence, classification and
+  /// notes of each detection (see sealtk::core::PipelineResultCache).
+  ///
+  /// This must be called before the worker is initialized.
+  void setResultCache(
+    std::shared_ptr<sealtk::core::PipelineResultCache> const& cache);
+
 signals:
   void trackModelReady(int index, std::shared_ptr<QAbstractItemModel> model);
 
@@ -44,9 +129,18 @@ protected:
 
   void initializeInput(kwiver::embedded_pipeline& pipeline) override;
 
+  void sendInput(kwiver::embedded_pipeline& pipeline) override;
+
+  bool reuseOutput(kwiver::vital::timestamp::time_t time,
+                   QVector<QString> const& frameNames) override;
+
   void processOutput(
     kwiver::adapter::adapter_data_set_t const& output) override;
 
+  void reportError(QString const& message, QString const& subject) override;
+
+  void reportProgress(int framesProcessed) override;
+
 private:
   QTE_DECLARE_PRIVATE(NoaaPipelineWorker);
 };
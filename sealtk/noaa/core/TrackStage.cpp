@@ -0,0 +1,250 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/noaa/core/TrackStage.hpp>
+
+#include <sealtk/core/KwiverTrackModel.hpp>
+
+#include <vital/range/valid.h>
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QTimer>
+
+#include <vector>
+
+namespace kv = kwiver::vital;
+namespace kvr = kwiver::vital::range;
+
+using sealtk::core::KwiverTrackModel;
+
+namespace sealtk
+{
+
+namespace noaa
+{
+
+namespace core
+{
+
+namespace // anonymous
+{
+
+// Output is delivered at most once per (nominal) display frame
+constexpr auto flushInterval = 33; // milliseconds
+
+// ============================================================================
+struct StagedOutput
+{
+  kv::object_track_set_sptr tracks;
+  bool merge;
+};
+
+// ----------------------------------------------------------------------------
+void mergeStates(kv::track& target, kv::track const& source)
+{
+  for (auto const& state : source | kvr::valid)
+  {
+    auto const i = target.find(state->frame());
+    if (i != target.end())
+    {
+      auto const existing = *i;
+      target.remove(existing);
+    }
+    target.insert(state->clone());
+  }
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class TrackStagePrivate
+{
+public:
+  TrackStagePrivate(std::shared_ptr<KwiverTrackModel> const& model)
+    : model{model} {}
+
+  void scheduleFlush(TrackStage* q);
+
+  std::weak_ptr<KwiverTrackModel> const model;
+
+  QMutex mutex;
+  std::vector<StagedOutput> pendingOutput;
+  bool flushScheduled = false;
+  bool suspended = false;
+};
+
+// ----------------------------------------------------------------------------
+void TrackStagePrivate::scheduleFlush(TrackStage* q)
+{
+  if (auto const& model = this->model.lock())
+  {
+    // Start the timer from the model's thread; the stage is kept alive by the
+    // pending flush, so the output will be delivered even if the stage's
+    // owner has been destroyed by then
+    auto* const context = model.get();
+    QMetaObject::invokeMethod(
+      context, [context, self = q->shared_from_this(), this]{
+        QTimer::singleShot(flushInterval, context, [self, this]{
+          {
+            QMutexLocker locker{&this->mutex};
+            if (this->suspended)
+            {
+              // Delivery will be rescheduled when the stage is resumed
+              this->flushScheduled = false;
+              return;
+            }
+          }
+
+          self->flush();
+        });
+      });
+
+    this->flushScheduled = true;
+  }
+}
+
+// ----------------------------------------------------------------------------
+QTE_IMPLEMENT_D_FUNC(TrackStage)
+
+// ----------------------------------------------------------------------------
+TrackStage::TrackStage(std::shared_ptr<KwiverTrackModel> const& model)
+  : d_ptr{new TrackStagePrivate{model}}
+{
+}
+
+// ----------------------------------------------------------------------------
+TrackStage::~TrackStage()
+{
+}
+
+// ----------------------------------------------------------------------------
+void TrackStage::stage(kv::object_track_set_sptr const& tracks, bool merge)
+{
+  QTE_D();
+  QMutexLocker locker{&d->mutex};
+
+  d->pendingOutput.push_back({tracks, merge});
+
+  if (!d->flushScheduled)
+  {
+    d->scheduleFlush(this);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void TrackStage::suspend()
+{
+  QTE_D();
+  QMutexLocker locker{&d->mutex};
+
+  d->suspended = true;
+}
+
+// ----------------------------------------------------------------------------
+void TrackStage::resume()
+{
+  QTE_D();
+  QMutexLocker locker{&d->mutex};
+
+  d->suspended = false;
+  if (!d->flushScheduled && !d->pendingOutput.empty())
+  {
+    d->scheduleFlush(this);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void TrackStage::flush()
+{
+  QTE_D();
+
+  auto output = std::vector<StagedOutput>{};
+
+  {
+    QMutexLocker locker{&d->mutex};
+    output.swap(d->pendingOutput);
+    d->flushScheduled = false;
+  }
+
+  auto const& model = d->model.lock();
+  if (!model)
+  {
+    return;
+  }
+
+  // Combine runs of output into as few model updates as possible; tracks to
+  // be added are simply collected, while all instances of a track to be
+  // merged are combined into a single track, so that each run results in
+  // exactly one model update
+  auto tracks = std::vector<kv::track_sptr>{};
+  auto trackIndices = QHash<kv::track_id_t, size_t>{};
+  auto combinedIds = QSet<kv::track_id_t>{};
+  auto merge = false;
+
+  auto const& submit = [&]{
+    if (!tracks.empty())
+    {
+      auto trackSet = std::make_shared<kv::object_track_set>(tracks);
+      if (merge)
+      {
+        model->mergeTracks(trackSet);
+      }
+      else
+      {
+        model->addTracks(trackSet);
+      }
+
+      tracks.clear();
+      trackIndices.clear();
+      combinedIds.clear();
+    }
+  };
+
+  for (auto const& o : output)
+  {
+    if (o.merge != merge)
+    {
+      submit();
+      merge = o.merge;
+    }
+
+    for (auto const& track : o.tracks->tracks() | kvr::valid)
+    {
+      if (merge)
+      {
+        auto const id = track->id();
+        auto const i = trackIndices.find(id);
+        if (i != trackIndices.end())
+        {
+          // The pipeline's tracks must not be modified, so the first
+          // instance of the track is replaced by a copy before the states of
+          // later instances are merged into it
+          auto& combinedTrack = tracks[*i];
+          if (!combinedIds.contains(id))
+          {
+            combinedTrack = combinedTrack->clone();
+            combinedIds.insert(id);
+          }
+
+          mergeStates(*combinedTrack, *track);
+          continue;
+        }
+
+        trackIndices.insert(id, tracks.size());
+      }
+
+      tracks.push_back(track);
+    }
+  }
+
+  submit();
+}
+
+} // namespace core
+
+} // namespace noaa
+
+} // namespace sealtk
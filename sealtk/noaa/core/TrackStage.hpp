@@ -0,0 +1,90 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#ifndef sealtk_noaa_core_TrackStage_hpp
+#define sealtk_noaa_core_TrackStage_hpp
+
+#include <sealtk/noaa/core/Export.h>
+
+#include <vital/types/object_track_set.h>
+
+#include <qtGlobal.h>
+
+#include <memory>
+
+namespace sealtk
+{
+
+namespace core
+{
+
+class KwiverTrackModel;
+
+} // namespace core
+
+namespace noaa
+{
+
+namespace core
+{
+
+class TrackStagePrivate;
+
+// ============================================================================
+/// Buffer of pipeline output awaiting delivery to a track model.
+///
+/// This class accumulates track sets produced by a pipeline, which may be
+/// staged from any thread, and delivers them to a track model in batches, at
+/// most once per (nominal) display frame. Each delivery combines the staged
+/// output into as few model updates as possible; in particular, all states of
+/// a track which is to be merged into the model are combined into a single
+/// track, with later states replacing earlier states for the same frame.
+///
+/// Instances must be owned by a \c std::shared_ptr, which keeps the stage
+/// alive while a delivery is pending.
+class SEALTK_NOAA_CORE_EXPORT TrackStage
+  : public std::enable_shared_from_this<TrackStage>
+{
+public:
+  explicit TrackStage(
+    std::shared_ptr<sealtk::core::KwiverTrackModel> const& model);
+  ~TrackStage();
+
+  /// Stage output for delivery.
+  ///
+  /// This adds \p tracks to the pending output, and schedules a delivery if
+  /// one is not already pending. If \p merge is \c true, the tracks will be
+  /// merged into the model; otherwise, they will be added as new tracks.
+  void stage(kwiver::vital::object_track_set_sptr const& tracks, bool merge);
+
+  /// Deliver pending output immediately.
+  ///
+  /// This must be called from the thread of the track model. Output is
+  /// delivered even if the stage is suspended.
+  void flush();
+
+  /// Stop delivering output periodically.
+  ///
+  /// While the stage is suspended, output continues to be staged, but is only
+  /// delivered by explicit calls to flush(). This allows the track model to
+  /// be consumed without it changing, even if the event loop runs meanwhile.
+  void suspend();
+
+  /// Resume periodic delivery of output.
+  void resume();
+
+protected:
+  QTE_DECLARE_PRIVATE_RPTR(TrackStage)
+
+private:
+  QTE_DECLARE_PRIVATE(TrackStage)
+};
+
+} // namespace core
+
+} // namespace noaa
+
+} // namespace sealtk
+
+#endif
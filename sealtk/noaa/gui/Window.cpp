@@ -675,23 +675,39 @@ void WindowPrivate::loadDetections(WindowData* data)
 {
   QTE_Q();
 
-  auto const& filename = QFileDialog::getOpenFileName(q);
-  if (!filename.isNull())
+  auto const& filenames = QFileDialog::getOpenFileNames(q);
+  if (!filenames.isEmpty())
   {
-    auto uri = QUrl::fromLocalFile(filename);
     auto params = QUrlQuery{};
-
     params.addQueryItem("input:type", config::trackReader);
-    uri.setQuery(params);
 
-    data->trackSource =
-      std::make_shared<sc::KwiverTrackSource>(q);
+    auto uris = QList<QUrl>{};
+    for (auto const& filename : filenames)
+    {
+      auto uri = QUrl::fromLocalFile(filename);
+      uri.setQuery(params);
+      uris.append(uri);
+    }
+
+    auto const& trackSource = std::make_shared<sc::KwiverTrackSource>(q);
+    trackSource->setProgressiveLoading(true);
+    data->trackSource = trackSource;
 
     QObject::connect(
       data->trackSource.get(), &sc::AbstractDataSource::modelReady, q,
       [data, this](std::shared_ptr<QAbstractItemModel> const& model){
         this->setTrackModel(data, model);
       });
+    QObject::connect(
+      trackSource.get(), &sc::KwiverTrackSource::loadProgress, q,
+      [this](qint64 statesLoaded){
+        this->ui.statusBar->showMessage(
+          QStringLiteral("Loading detections (%1 loaded)...")
+            .arg(statesLoaded));
+      });
+    QObject::connect(
+      trackSource.get(), &sc::KwiverTrackSource::loadFinished, q,
+      [this]{ this->ui.statusBar->clearMessage(); });
     QObject::connect(
       data->trackSource.get(), &sc::AbstractDataSource::failed, q,
       [q](QString const& message){
@@ -704,7 +720,7 @@ void WindowPrivate::loadDetections(WindowData* data)
         mb.exec();
       });
 
-    data->trackSource->readData(uri);
+    trackSource->readData(uris);
   }
 }
 
@@ -721,6 +737,8 @@ void WindowPrivate::saveDetections(WindowData* data)
 
   // Set up writer
   sc::KwiverTracksSink writer;
+  writer.setExportMode(
+    sc::KwiverTracksSink::exportModeForWriter(config::trackWriter));
 
   auto* const primaryFilter = new sc::ScalarFilterModel{&writer};
   primaryFilter->setSourceModel(data->trackModel.get());
@@ -756,9 +774,36 @@ void WindowPrivate::saveDetections(WindowData* data)
       params.addQueryItem("output:type", config::trackWriter);
       uri.setQuery(params);
 
+      QProgressDialog progressDialog{
+        QStringLiteral("Saving Detections..."), QStringLiteral("Cancel"),
+        0, 0, q};
+      progressDialog.setWindowModality(Qt::WindowModal);
+      progressDialog.setAutoReset(false);
+      progressDialog.show();
+
+      auto canceled = false;
+      QObject::connect(
+        &progressDialog, &QProgressDialog::canceled, &writer,
+        [&writer, &canceled]{
+          canceled = true;
+          writer.cancel();
+        });
+
+      QObject::connect(
+        &writer, &sc::KwiverTracksSink::writeProgress, &progressDialog,
+        [&progressDialog](int framesWritten, int framesTotal){
+          progressDialog.setMaximum(framesTotal);
+          progressDialog.setValue(framesWritten);
+        });
+
       QObject::connect(
         &writer, &sc::AbstractDataSink::failed, q,
-        [q](QString const& message){
+        [q, &canceled](QString const& message){
+          if (canceled)
+          {
+            return;
+          }
+
           QMessageBox mb{q};
           mb.setIcon(QMessageBox::Critical);
           mb.setWindowTitle(QStringLiteral("Failed to write detections"));
@@ -1053,9 +1098,7 @@ void WindowPrivate::createDetection(
   if (auto* const kwiverTrackModel =
         qobject_cast<sc::KwiverTrackModel*>(data->trackModel.get()))
   {
-    auto const& newTracks = std::make_shared<kv::object_track_set>();
-    newTracks->insert(track);
-    kwiverTrackModel->addTracks(newTracks);
+    kwiverTrackModel->createTrack(track);
   }
 }
 
@@ -0,0 +1,200 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/test/TestCore.hpp>
+
+#include <sealtk/core/test/TestCommon.hpp>
+
+#include <sealtk/noaa/core/NoaaPipelineWorker.hpp>
+
+#include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/KwiverVideoSource.hpp>
+#include <sealtk/core/PipelineResultCache.hpp>
+
+#include <sealtk/util/unique.hpp>
+
+#include <vital/algo/video_input.h>
+#include <vital/config/config_block.h>
+
+#include <vital/range/iota.h>
+
+#include <qtStlUtil.h>
+
+#include <QAbstractItemModel>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include <QtTest>
+
+#include <memory>
+
+namespace kv = kwiver::vital;
+namespace kvr = kwiver::vital::range;
+
+using time_us_t = kv::timestamp::time_t;
+
+namespace sealtk
+{
+
+namespace noaa
+{
+
+namespace test
+{
+
+// ============================================================================
+class TestNoaaPipelineWorker : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void reuseOrder();
+  void reuseOrder_data();
+  void shardedMetrics();
+
+private:
+  std::unique_ptr<sealtk::core::KwiverVideoSource> videoSource;
+};
+
+// ----------------------------------------------------------------------------
+void TestNoaaPipelineWorker::initTestCase()
+{
+  sealtk::core::test::loadKwiverPlugins();
+
+  auto config = kv::config_block::empty_config();
+  config->set_value("video_reader:type", "image_list");
+  config->set_value("video_reader:image_list:image_reader:type",
+                    "timestamp_passthrough");
+  config->set_value("video_reader:image_list:image_reader:"
+                    "timestamp_passthrough:image_reader:type", "qt");
+
+  kv::algo::video_input_sptr videoReader;
+  kv::algo::video_input::set_nested_algo_configuration(
+    "video_reader", config, videoReader);
+  videoReader->open(
+    stdString(SEALTK_TEST_DATA_PATH("NoaaPipelineWorker/list.txt")));
+
+  this->videoSource =
+    make_unique<sealtk::core::KwiverVideoSource>(videoReader);
+}
+
+// ----------------------------------------------------------------------------
+void TestNoaaPipelineWorker::cleanupTestCase()
+{
+  this->videoSource.reset();
+}
+
+// ----------------------------------------------------------------------------
+void TestNoaaPipelineWorker::reuseOrder()
+{
+  QFETCH(int, lookAhead);
+
+  auto const& pipeline =
+    SEALTK_TEST_DATA_PATH("NoaaPipelineWorker/detector.pipe");
+
+  QTemporaryDir cacheDir;
+  QVERIFY(cacheDir.isValid());
+
+  auto const& cache =
+    std::make_shared<sealtk::core::PipelineResultCache>(
+      pipeline, cacheDir.path());
+  QVERIFY(cache->isValid());
+
+  auto const& setUp = [&](core::NoaaPipelineWorker& worker,
+                          std::shared_ptr<QAbstractItemModel>& model){
+    worker.setLookAhead(lookAhead);
+    worker.setResultCache(cache);
+    worker.addVideoSource(this->videoSource.get());
+
+    connect(&worker, &core::NoaaPipelineWorker::trackModelReady,
+            this, [&model](int, std::shared_ptr<QAbstractItemModel> m){
+              model = std::move(m);
+            });
+  };
+
+  // Populate the cache with the output of some of the time steps
+  {
+    auto model = std::shared_ptr<QAbstractItemModel>{};
+    core::NoaaPipelineWorker worker;
+    setUp(worker, model);
+    worker.setTimeRange(2000, 3000);
+
+    QVERIFY(worker.initialize(pipeline));
+    worker.execute();
+
+    QVERIFY(model);
+    QTRY_COMPARE(model->rowCount(), 2);
+  }
+
+  // Execute over all time steps, so that the output of the first step must
+  // be computed by the pipeline while the output of the following steps is
+  // reused; test that the output is nevertheless delivered in time order
+  auto model = std::shared_ptr<QAbstractItemModel>{};
+  core::NoaaPipelineWorker worker;
+  setUp(worker, model);
+
+  QVERIFY(worker.initialize(pipeline));
+  worker.execute();
+
+  QCOMPARE(worker.metrics().stepsReused, 2);
+  QCOMPARE(worker.flushOutput(), time_us_t{5000});
+
+  QVERIFY(model);
+  QTRY_COMPARE(model->rowCount(), 5);
+
+  auto times = QVector<time_us_t>{};
+  for (auto const row : kvr::iota(model->rowCount()))
+  {
+    auto const& index = model->index(row, 0);
+    times.append(
+      model->data(index, sealtk::core::StartTimeRole).value<time_us_t>());
+  }
+
+  QCOMPARE(times, (QVector<time_us_t>{1000, 2000, 3000, 4000, 5000}));
+}
+
+// ----------------------------------------------------------------------------
+void TestNoaaPipelineWorker::reuseOrder_data()
+{
+  QTest::addColumn<int>("lookAhead");
+
+  QTest::newRow("no look-ahead") << 1;
+  QTest::newRow("look-ahead") << 4;
+}
+
+// ----------------------------------------------------------------------------
+void TestNoaaPipelineWorker::shardedMetrics()
+{
+  auto const& pipeline =
+    SEALTK_TEST_DATA_PATH("NoaaPipelineWorker/detector.pipe");
+
+  core::NoaaPipelineWorker worker;
+  worker.addVideoSource(this->videoSource.get());
+
+  QVERIFY(worker.initialize(pipeline));
+  QVERIFY(worker.initializeShards(pipeline, 2));
+  QCOMPARE(worker.shardCount(), 2);
+
+  worker.execute();
+
+  // Test that the metrics cover the work of all shards
+  auto const& metrics = worker.metrics();
+  QCOMPARE(metrics.framesReceived, 5);
+  QCOMPARE(metrics.stepsSent, 5);
+  QCOMPARE(metrics.outputsReceived, 5);
+  QCOMPARE(metrics.frameLatency.count(), 1);
+  QCOMPARE(metrics.frameLatency[0].count, 5);
+}
+
+} // namespace test
+
+} // namespace noaa
+
+} // namespace sealtk
+
+// ----------------------------------------------------------------------------
+QTEST_MAIN(sealtk::noaa::test::TestNoaaPipelineWorker)
+#include "NoaaPipelineWorker.moc"
@@ -0,0 +1,215 @@
+/* This file is part of SEAL-TK, and is distributed under the OSI-approved BSD
+ * 3-Clause License. See top-level LICENSE file or
+ * https://github.com/Kitware/seal-tk/blob/master/LICENSE for details. */
+
+#include <sealtk/noaa/core/TrackStage.hpp>
+
+#include <sealtk/core/DataModelTypes.hpp>
+#include <sealtk/core/KwiverTrackModel.hpp>
+#include <sealtk/core/TrackUtils.hpp>
+
+#include <vital/range/iota.h>
+
+#include <QVector>
+
+#include <QtTest>
+
+namespace kv = kwiver::vital;
+namespace kvr = kwiver::vital::range;
+
+using sealtk::core::KwiverTrackModel;
+
+namespace sealtk
+{
+
+namespace noaa
+{
+
+namespace test
+{
+
+namespace // anonymous
+{
+
+using time_us_t = kv::timestamp::time_t;
+
+// ----------------------------------------------------------------------------
+kv::object_track_set_sptr createTracks(
+  std::initializer_list<std::pair<kv::track_id_t, kv::frame_id_t>> states)
+{
+  auto tracks = std::vector<kv::track_sptr>{};
+  for (auto const& s : states)
+  {
+    auto track = kv::track::create();
+    track->set_id(s.first);
+    track->append(
+      sealtk::core::createTrackState(
+        s.second, s.second * 100,
+        sealtk::core::createDetection({0.0, 0.0, 1.0, 1.0})));
+
+    tracks.emplace_back(std::move(track));
+  }
+
+  return std::make_shared<kv::object_track_set>(tracks);
+}
+
+// ----------------------------------------------------------------------------
+QVector<time_us_t> trackTimes(QAbstractItemModel const& model, qint64 id)
+{
+  using sealtk::core::LogicalIdentityRole;
+  using sealtk::core::StartTimeRole;
+
+  auto result = QVector<time_us_t>{};
+  for (auto const row : kvr::iota(model.rowCount()))
+  {
+    auto const& parent = model.index(row, 0);
+    if (model.data(parent, LogicalIdentityRole).value<qint64>() == id)
+    {
+      for (auto const i : kvr::iota(model.rowCount(parent)))
+      {
+        auto const& index = model.index(i, 0, parent);
+        result.append(model.data(index, StartTimeRole).value<time_us_t>());
+      }
+    }
+  }
+
+  return result;
+}
+
+} // namespace <anonymous>
+
+// ============================================================================
+class TestTrackStage : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void addition();
+  void merging();
+  void scheduling();
+  void suspension();
+};
+
+// ----------------------------------------------------------------------------
+void TestTrackStage::addition()
+{
+  auto const& model = std::make_shared<KwiverTrackModel>();
+  auto const& stage = std::make_shared<core::TrackStage>(model);
+
+  QSignalSpy insertedSpy{model.get(), &QAbstractItemModel::rowsInserted};
+
+  // Test that all added tracks are delivered in a single update
+  stage->stage(createTracks({{1, 1}, {2, 1}}), false);
+  stage->stage(createTracks({{3, 2}}), false);
+  stage->stage(createTracks({{4, 3}, {5, 3}}), false);
+  stage->flush();
+
+  QCOMPARE(model->rowCount(), 5);
+  QCOMPARE(insertedSpy.count(), 1);
+}
+
+// ----------------------------------------------------------------------------
+void TestTrackStage::merging()
+{
+  auto const& model = std::make_shared<KwiverTrackModel>();
+  auto const& stage = std::make_shared<core::TrackStage>(model);
+
+  stage->stage(createTracks({{1, 1}, {2, 1}}), true);
+  stage->flush();
+
+  QCOMPARE(model->rowCount(), 2);
+  QCOMPARE(trackTimes(*model, 1), (QVector<time_us_t>{100}));
+
+  QSignalSpy insertedSpy{model.get(), &QAbstractItemModel::rowsInserted};
+  QSignalSpy changedSpy{model.get(), &QAbstractItemModel::dataChanged};
+
+  // Test that the states of a track received over several frames are merged
+  // into the model in a single update
+  auto const& staged = createTracks({{1, 2}, {2, 2}});
+  stage->stage(staged, true);
+  stage->stage(createTracks({{1, 3}}), true);
+  stage->stage(createTracks({{1, 4}, {3, 4}}), true);
+  stage->flush();
+
+  QCOMPARE(model->rowCount(), 3);
+  QCOMPARE(trackTimes(*model, 1), (QVector<time_us_t>{100, 200, 300, 400}));
+  QCOMPARE(trackTimes(*model, 2), (QVector<time_us_t>{100, 200}));
+  QCOMPARE(trackTimes(*model, 3), (QVector<time_us_t>{400}));
+
+  // One insertion of new states and one change for each existing track, and
+  // one insertion of new tracks
+  QCOMPARE(insertedSpy.count(), 3);
+  QCOMPARE(changedSpy.count(), 2);
+
+  // Test that later states replace earlier states for the same frame
+  auto const& replacement = createTracks({{2, 2}});
+  sealtk::core::objectTrackState(replacement->get_track(2)->back())
+    ->set_time(250);
+
+  stage->stage(createTracks({{2, 2}, {2, 5}}), true);
+  stage->stage(replacement, true);
+  stage->flush();
+
+  QCOMPARE(trackTimes(*model, 2), (QVector<time_us_t>{100, 250, 500}));
+
+  // Test that the staged tracks were not modified
+  QCOMPARE(staged->get_track(1)->size(), size_t{1});
+}
+
+// ----------------------------------------------------------------------------
+void TestTrackStage::scheduling()
+{
+  auto const& model = std::make_shared<KwiverTrackModel>();
+  auto stage = std::make_shared<core::TrackStage>(model);
+
+  QSignalSpy insertedSpy{model.get(), &QAbstractItemModel::rowsInserted};
+
+  // Test that output is delivered once the event loop runs, and that the
+  // stage is kept alive until then
+  stage->stage(createTracks({{1, 1}}), true);
+  stage->stage(createTracks({{1, 2}}), true);
+  stage.reset();
+
+  QCOMPARE(model->rowCount(), 0);
+  QVERIFY(insertedSpy.wait());
+
+  QCOMPARE(insertedSpy.count(), 1);
+  QCOMPARE(trackTimes(*model, 1), (QVector<time_us_t>{100, 200}));
+}
+
+// ----------------------------------------------------------------------------
+void TestTrackStage::suspension()
+{
+  auto const& model = std::make_shared<KwiverTrackModel>();
+  auto const& stage = std::make_shared<core::TrackStage>(model);
+
+  QSignalSpy insertedSpy{model.get(), &QAbstractItemModel::rowsInserted};
+
+  // Test that output is not delivered by the event loop while suspended...
+  stage->stage(createTracks({{1, 1}}), true);
+  stage->suspend();
+  QVERIFY(!insertedSpy.wait(200));
+
+  // ...but is delivered by an explicit flush...
+  stage->flush();
+  QCOMPARE(insertedSpy.count(), 1);
+
+  stage->stage(createTracks({{2, 2}}), true);
+  QVERIFY(!insertedSpy.wait(200));
+  QCOMPARE(model->rowCount(), 1);
+
+  // ...and that delivery resumes when the stage is resumed
+  stage->resume();
+  QVERIFY(insertedSpy.wait());
+  QCOMPARE(model->rowCount(), 2);
+}
+
+} // namespace test
+
+} // namespace noaa
+
+} // namespace sealtk
+
+// ----------------------------------------------------------------------------
+QTEST_MAIN(sealtk::noaa::test::TestTrackStage)
+#include "TrackStage.moc"